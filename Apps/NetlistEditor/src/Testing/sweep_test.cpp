@@ -0,0 +1,132 @@
+#define BOOST_TEST_MODULE sweep
+#include <boost/test/included/unit_test.hpp>
+
+#include "model/sweep.h"
+#include "utility/strings.h"
+
+#include <cmath>
+
+
+using namespace sapecng;
+
+
+namespace
+{
+
+
+void add(
+    netlist& n,
+    abstract_builder::dual_component_type type,
+    const std::string& name,
+    double value,
+    unsigned int va,
+    unsigned int vb,
+    bool prescribed_flow = false
+  )
+{
+  std::map<std::string,std::string> props;
+  if(prescribed_flow)
+    props[predefinedStrings::componentControlTypeFieldName] =
+      predefinedStrings::periodicPrescribedFlowString;
+
+  netlist_builder(n).add_dual_component(
+    type, name, std::vector<double>(1, value), va, vb, props);
+}
+
+
+double inflow(double t)
+{
+  return 1. + std::sin(10. * t);
+}
+
+
+double outflow(std::size_t, double t)
+{
+  return 0.5 * std::cos(7. * t);
+}
+
+
+// Windkessel fed at the interface node, drained by a prescribed flow
+netlist windkessel()
+{
+  netlist n;
+  netlist_builder(n).add_threeD_interface_node(1);
+  add(n, abstract_builder::Component_Resistor, "R", 2., 1, 0);
+  add(n, abstract_builder::Component_Capacitor, "C", 0.5, 1, 0);
+  add(n, abstract_builder::I, "Q", 0., 1, 0, true);
+  return n;
+}
+
+
+}
+
+
+
+// every sample of the sweep must match a serial run of the same network,
+// with the sources taken at the end of every step
+BOOST_AUTO_TEST_CASE( transient_sweep_matches_serial_run )
+{
+  const double dt = 1e-3;
+  const std::size_t steps = 200, stride = 4;
+
+  std::vector<sweep_parameter> parameters(1);
+  parameters[0].name = "R";
+  parameters[0].min = 1.;
+  parameters[0].max = 3.;
+  parameters[0].levels = 5;
+
+  std::vector< std::vector<double> > samples = grid_samples(parameters);
+  std::vector<unsigned int> nodes(1, 1);
+
+  sweep_table table = transient_sweep(windkessel(), parameters, samples,
+    dt, steps, stride, inflow, outflow, nodes, 3);
+
+  std::size_t block = steps / stride;
+  BOOST_REQUIRE_EQUAL(table.columns(), 4u);
+  BOOST_REQUIRE_EQUAL(table.rows(), samples.size() * block);
+
+  for(std::size_t s = 0; s < samples.size(); ++s) {
+    netlist n = windkessel();
+    n.set_value("R", samples[s][0]);
+
+    transient sim(n, dt);
+    for(std::size_t row = s * block; row < (s + 1) * block; ++row) {
+      for(std::size_t i = 0; i < stride; ++i) {
+        sim.set_interface_flow(inflow(sim.time() + dt));
+        sim.set_prescribed_flow(2, outflow(2, sim.time() + dt));
+        sim.step();
+      }
+
+      BOOST_REQUIRE_EQUAL(table.column(0)[row], double(s));
+      BOOST_REQUIRE_EQUAL(table.column(1)[row], samples[s][0]);
+      BOOST_REQUIRE_EQUAL(table.column(2)[row], sim.time());
+      BOOST_REQUIRE_EQUAL(table.column(3)[row], sim.pressure(1));
+    }
+  }
+}
+
+
+BOOST_AUTO_TEST_CASE( transient_sweep_errors )
+{
+  std::vector<sweep_parameter> parameters(1);
+  parameters[0].name = "X";
+  parameters[0].min = 0.;
+  parameters[0].max = 1.;
+  parameters[0].levels = 2;
+
+  std::vector< std::vector<double> > samples = grid_samples(parameters);
+  std::vector<unsigned int> nodes(1, 1);
+
+  BOOST_CHECK_THROW(transient_sweep(windkessel(), parameters, samples,
+    1e-3, 10, 1, inflow, outflow, nodes), simulation_error);
+
+  // a failing worker stops the sweep and its error reaches the caller
+  parameters[0].name = "C";
+  samples[1][0] = 0.;
+  netlist floating;
+  add(floating, abstract_builder::Component_Capacitor, "C", 1., 1, 2);
+  BOOST_CHECK_THROW(transient_sweep(floating, parameters, samples,
+    1e-3, 10, 1, std::function<double (double)>(),
+    std::function<double (std::size_t, double)>(), nodes, 2),
+    simulation_error);
+}
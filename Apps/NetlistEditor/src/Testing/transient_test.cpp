@@ -0,0 +1,159 @@
+#define BOOST_TEST_MODULE transient
+#include <boost/test/included/unit_test.hpp>
+
+#include "model/transient.h"
+#include "utility/strings.h"
+
+#include <cmath>
+
+
+using namespace sapecng;
+
+
+namespace
+{
+
+
+void add(
+    netlist& n,
+    abstract_builder::dual_component_type type,
+    const std::string& name,
+    double value,
+    unsigned int va,
+    unsigned int vb,
+    bool prescribed_flow = false
+  )
+{
+  std::map<std::string,std::string> props;
+  if(prescribed_flow)
+    props[predefinedStrings::componentControlTypeFieldName] =
+      predefinedStrings::periodicPrescribedFlowString;
+
+  netlist_builder(n).add_dual_component(
+    type, name, std::vector<double>(1, value), va, vb, props);
+}
+
+
+}
+
+
+
+// 2-element Windkessel: constant inflow Q at the interface node into a
+// resistance and a compliance to ground,
+//   P(t) = Q R (1 - exp(-t / RC))
+BOOST_AUTO_TEST_CASE( windkessel_step_response )
+{
+  const double R = 2., C = 0.5, Q = 3., dt = 1e-3;
+
+  netlist n;
+  netlist_builder(n).add_threeD_interface_node(1);
+  add(n, abstract_builder::Component_Resistor, "R", R, 1, 0);
+  add(n, abstract_builder::Component_Capacitor, "C", C, 1, 0);
+
+  transient sim(n, dt);
+  sim.set_interface_flow(Q);
+
+  double expected = 0.;
+  for(int i = 0; i < 2000; ++i) {
+    sim.step();
+
+    // backward Euler of C dP/dt = Q - P / R, which the stamps must
+    // reproduce up to the round-off of the factorization
+    expected = (expected + dt * Q / C) / (1. + dt / (R * C));
+    BOOST_REQUIRE_SMALL(sim.pressure(1) - expected, 1e-12);
+  }
+
+  double exact = Q * R * (1. - std::exp(-sim.time() / (R * C)));
+  BOOST_CHECK_SMALL(sim.pressure(1) - exact, 1e-3 * Q * R);
+  BOOST_CHECK_SMALL(sim.flow(0) + sim.flow(1) - Q, 1e-12);
+}
+
+
+// pressure source driving a series R-L: the source, the inductor and the
+// prescribed pressure node add branch unknowns with a zero diagonal, so the
+// factorization has to pivot off the diagonal
+//   Q(t) = (V - P0) / R (1 - exp(-R t / L))
+BOOST_AUTO_TEST_CASE( rl_step_response )
+{
+  const double V = 10., P0 = 4., R = 5., L = 0.25, dt = 1e-4;
+
+  netlist n;
+  netlist_builder(n).add_prescribed_pressure_node("P0", P0, 3);
+  add(n, abstract_builder::V, "V", V, 1, 0);
+  add(n, abstract_builder::Component_Resistor, "R", R, 1, 2);
+  add(n, abstract_builder::Component_Inductor, "L", L, 2, 3);
+
+  transient sim(n, dt);
+
+  double expected = 0.;
+  for(int i = 0; i < 1000; ++i) {
+    sim.step();
+
+    expected = (expected + dt * (V - P0) / L) / (1. + dt * R / L);
+    BOOST_REQUIRE_SMALL(sim.flow(2) - expected, 1e-12);
+  }
+
+  double exact = (V - P0) / R * (1. - std::exp(-R * sim.time() / L));
+  BOOST_CHECK_SMALL(sim.flow(2) - exact, 1e-3 * (V - P0) / R);
+  BOOST_CHECK_SMALL(sim.pressure(1) - V, 1e-12);
+  BOOST_CHECK_SMALL(sim.pressure(3) - P0, 1e-12);
+  BOOST_CHECK_SMALL(sim.pressure(1) - sim.pressure(2) - R * sim.flow(1),
+    1e-12);
+}
+
+
+// a prescribed flow pushed through a resistance into a prescribed pressure
+BOOST_AUTO_TEST_CASE( prescribed_flow )
+{
+  const double R = 7., P0 = 2.;
+
+  netlist n;
+  netlist_builder(n).add_prescribed_pressure_node("P0", P0, 2);
+  add(n, abstract_builder::I, "Q", 0., 0, 1, true);
+  add(n, abstract_builder::Component_Resistor, "R", R, 1, 2);
+
+  transient sim(n, 1e-2);
+  for(int i = 0; i < 5; ++i) {
+    double q = 0.5 * i;
+    sim.set_prescribed_flow(0, q);
+    sim.step();
+
+    BOOST_CHECK_SMALL(sim.pressure(1) - (P0 + q * R), 1e-12);
+    BOOST_CHECK_SMALL(sim.flow(0) - q, 1e-12);
+    BOOST_CHECK_SMALL(sim.flow(1) - q, 1e-12);
+  }
+}
+
+
+// the diode conducts for a positive drop only
+BOOST_AUTO_TEST_CASE( diode )
+{
+  const double V = 6., Rd = 1., R = 2.;
+
+  netlist n;
+  add(n, abstract_builder::V, "V", V, 1, 0);
+  add(n, abstract_builder::Component_Diode, "D", Rd, 1, 2);
+  add(n, abstract_builder::Component_Resistor, "R", R, 2, 0);
+
+  transient forward(n, 1e-2);
+  forward.step();
+  BOOST_CHECK_SMALL(forward.flow(1) - V / (Rd + R), 1e-12);
+  BOOST_CHECK_SMALL(forward.pressure(2) - V * R / (Rd + R), 1e-12);
+
+  n.set_value("V", -V);
+  transient backward(n, 1e-2);
+  backward.step();
+  BOOST_CHECK_SMALL(backward.flow(1), 1e-12);
+  BOOST_CHECK_SMALL(backward.pressure(2), 1e-12);
+}
+
+
+BOOST_AUTO_TEST_CASE( singular_network )
+{
+  // a capacitor between two otherwise floating nodes
+  netlist n;
+  add(n, abstract_builder::Component_Capacitor, "C", 1., 1, 2);
+
+  transient sim(n, 1e-2);
+  BOOST_CHECK_THROW(sim.step(), simulation_error);
+}
@@ -32,8 +32,13 @@
 #include <boost/graph/undirected_dfs.hpp>
 #include <boost/graph/connected_components.hpp>
 #include <boost/graph/filtered_graph.hpp>
+#include "boost-sapecng/parallel_for.hpp"
+#include <cstddef>
+#include <memory>
+#include <mutex>
 #include <vector>
 #include <stack>
+#include <deque>
 #include <map>
 
 
@@ -151,11 +156,74 @@ namespace detail {
   };
 
 
+  struct mrt_no_split
+  {
+    template <class Seq, class Map>
+    bool operator()(int depth, const Seq& inL, Map inL_map, Map diG, Map dvG)
+      { return false; }
+  };
+
+
+//
+//  Cuts the search tree at a given recursion depth. Every call reaching
+//    that depth is saved as an independent subproblem (a copy of the edge
+//    state) instead of being explored, so the subproblems can be solved
+//    later on, possibly concurrently.
+//
+  template <class Graph, class Seq>
+  struct mrt_frontier
+  {
+    typedef typename graph_traits<Graph>::edge_descriptor edge_descriptor;
+    typedef typename graph_traits<Graph>::edge_iterator edge_iterator;
+    typedef std::map<edge_descriptor, bool> edge_map;
+
+    struct subproblem
+    {
+      Seq inL;
+      edge_map inL_map;
+      edge_map iG_deleted;
+      edge_map vG_deleted;
+    };
+
+    mrt_frontier(const Graph& iG, const Graph& vG, int depth)
+      : iG_(iG), vG_(vG), depth_(depth) { }
+
+    template <class Map>
+    bool operator()(int depth, const Seq& inL, Map inL_map, Map diG, Map dvG)
+    {
+      if(depth < depth_)
+        return false;
+
+      subproblems_.push_back(subproblem());
+      subproblem& sp = subproblems_.back();
+      sp.inL = inL;
+
+      edge_iterator current, last;
+      for(tie(current, last) = edges(iG_); current != last; ++current) {
+        sp.inL_map[*current] = get(inL_map, *current);
+        sp.iG_deleted[*current] = get(diG, *current);
+      }
+      for(tie(current, last) = edges(vG_); current != last; ++current) {
+        sp.inL_map[*current] = get(inL_map, *current);
+        sp.vG_deleted[*current] = get(dvG, *current);
+      }
+
+      return true;
+    }
+
+    const Graph& iG_;
+    const Graph& vG_;
+    int depth_;
+    std::deque<subproblem> subproblems_;
+  };
+
+
   template <
     class Graph,
     class Func,
     class Seq,
-    class Map
+    class Map,
+    class Split
   >
   void rec_mrt_two_graphs_common_spanning_trees
     (
@@ -173,8 +241,10 @@ namespace detail {
         > vG_bimap,
       Map avG_inL,
       Map dvG,
-      Func func,
-      Seq inL
+      Func& func,
+      Seq inL,
+      Split& split,
+      int depth
     )
   {
     typedef graph_traits<Graph> GraphTraits;
@@ -206,7 +276,7 @@ namespace detail {
     bool is_tree = (edges == 0);
     if(is_tree) {
       func(inL);
-    } else {
+    } else if(!split(depth, inL, aiG_inL, diG, dvG)) {
       std::map<vertex_descriptor, default_color_type> vertex_color;
       std::map<edge_descriptor, default_color_type> edge_color;
 
@@ -308,8 +378,10 @@ namespace detail {
         }
 
         // REC_MRT
-        detail::rec_mrt_two_graphs_common_spanning_trees<Graph, Func, Seq, Map>
-          (iG, iG_bimap, aiG_inL, diG, vG, vG_bimap, aiG_inL, dvG, func, inL);
+        detail::rec_mrt_two_graphs_common_spanning_trees<
+            Graph, Func, Seq, Map, Split>
+          (iG, iG_bimap, aiG_inL, diG, vG, vG_bimap, aiG_inL, dvG, func, inL,
+            split, depth + 1);
 
         while(!iG_buf_copy.empty()) {
           put(diG, iG_buf_copy.top(), false);
@@ -506,8 +578,9 @@ namespace detail {
 
           // REC_MRT
           detail::rec_mrt_two_graphs_common_spanning_trees<
-              Graph, Func, Seq, Map>
-            (iG, iG_bimap, aiG_inL, diG, vG, vG_bimap, aiG_inL, dvG, func, inL);
+              Graph, Func, Seq, Map, Split>
+            (iG, iG_bimap, aiG_inL, diG, vG, vG_bimap, aiG_inL, dvG, func, inL,
+              split, depth + 1);
 
           while(!iG_buf.empty()) {
             inL[iG_bimap.right.at(iG_buf.top())] = false;
@@ -564,11 +637,25 @@ private:
 
 
 
+//
+//  Every common spanning tree is handed to func as soon as it is found,
+//    as a sequence of flags (indexed like iG_map/vG_map) telling which
+//    edges belong to the tree. The sequence is only valid during the call.
+//  The same func object is used for the whole enumeration, so stateful
+//    visitors can fold the trees into their result on the fly instead of
+//    keeping them all around (their number grows exponentially with the
+//    size of the graphs). tree_collector is the trivial visitor that stores
+//    every tree.
+//
+//  The split functor is asked at every step of the recursion whether it
+//    takes over the current subproblem (see detail::mrt_frontier).
+//
 template <
   class Graph,
   class Order,
   class Func,
-  class Seq
+  class Seq,
+  class Split
 >
 BOOST_CONCEPT_REQUIRES(
   ((RandomAccessContainer<Order>))
@@ -584,8 +671,9 @@ mrt_two_graphs_common_spanning_trees
     Order iG_map,
     const Graph& vG,
     Order vG_map,
-    Func func,
-    Seq inL
+    Func& func,
+    Seq inL,
+    Split& split
   )
 {
   typedef graph_traits<Graph> GraphTraits;
@@ -823,14 +911,142 @@ mrt_two_graphs_common_spanning_trees
 
     // REC_MRT
     detail::rec_mrt_two_graphs_common_spanning_trees<Graph, Func, Seq,
-        associative_property_map< std::map<edge_descriptor, bool> > >
-      (iG, iG_bimap, aiG_inL, diG, vG, vG_bimap, aiG_inL, dvG, func, inL);
+        associative_property_map< std::map<edge_descriptor, bool> >, Split>
+      (iG, iG_bimap, aiG_inL, diG, vG, vG_bimap, aiG_inL, dvG, func, inL,
+        split, 0);
 
   }
 
 }
 
 
+template <
+  class Graph,
+  class Order,
+  class Func,
+  class Seq
+>
+BOOST_CONCEPT_REQUIRES(
+  ((RandomAccessContainer<Order>))
+  ((IncidenceGraphConcept<Graph>))
+  ((UnaryFunction<Func, void, Seq>))
+  ((Mutable_RandomAccessContainer<Seq>))
+  ((VertexAndEdgeListGraphConcept<Graph>)),
+  (void)
+)
+mrt_two_graphs_common_spanning_trees
+  (
+    const Graph& iG,
+    Order iG_map,
+    const Graph& vG,
+    Order vG_map,
+    Func func,
+    Seq inL
+  )
+{
+  detail::mrt_no_split split;
+  mrt_two_graphs_common_spanning_trees(iG, iG_map, vG, vG_map, func, inL, split);
+}
+
+
+//
+//  Parallel enumeration. The search tree is cut at a fixed depth into
+//    independent subproblems which are handed out to the workers as they
+//    become idle. The trees found above the cut are passed to func, those of
+//    each subproblem to a copy of func taken before the enumeration starts.
+//    The copies are then handed to join(func, copy) in subproblem order, as
+//    soon as all the preceding subproblems are done. Neither the scheduling
+//    nor the number of workers therefore changes the order the trees are
+//    folded in. workers = 0 means one per hardware thread.
+//
+template <
+  class Graph,
+  class Order,
+  class Func,
+  class Join,
+  class Seq
+>
+BOOST_CONCEPT_REQUIRES(
+  ((RandomAccessContainer<Order>))
+  ((IncidenceGraphConcept<Graph>))
+  ((UnaryFunction<Func, void, Seq>))
+  ((Mutable_RandomAccessContainer<Seq>))
+  ((VertexAndEdgeListGraphConcept<Graph>)),
+  (void)
+)
+parallel_mrt_two_graphs_common_spanning_trees
+  (
+    const Graph& iG,
+    Order iG_map,
+    const Graph& vG,
+    Order vG_map,
+    Func& func,
+    Join join,
+    Seq inL,
+    std::size_t workers = 0
+  )
+{
+  typedef graph_traits<Graph> GraphTraits;
+
+  typedef typename GraphTraits::edge_descriptor edge_descriptor;
+  typedef typename Order::value_type order_value_type;
+  typedef typename Order::size_type order_size_type;
+
+  typedef detail::mrt_frontier<Graph, Seq> frontier_type;
+  typedef typename frontier_type::subproblem subproblem;
+  typedef associative_property_map< std::map<edge_descriptor, bool> > Map;
+
+  // enough subproblems to balance a few dozen workers, their sizes vary a
+  // lot; the depth must not depend on the workers, it decides how the trees
+  // are grouped
+  const int depth = 8;
+
+  const Func prototype(func);
+  frontier_type frontier(iG, vG, depth);
+  mrt_two_graphs_common_spanning_trees(
+    iG, iG_map, vG, vG_map, func, inL, frontier);
+
+  if(frontier.subproblems_.empty())
+    return;
+
+  typedef bimaps::bimap<
+      bimaps::set_of< int >,
+      bimaps::set_of< order_value_type >
+    > bimap_type;
+  typedef typename bimap_type::value_type bimap_value;
+
+  bimap_type iG_bimap, vG_bimap;
+  for(order_size_type i = 0; i < iG_map.size(); ++i)
+    iG_bimap.insert(bimap_value(i, iG_map[i]));
+  for(order_size_type i = 0; i < vG_map.size(); ++i)
+    vG_bimap.insert(bimap_value(i, vG_map[i]));
+
+  // finished subproblems wait here until all the preceding ones are joined
+  std::vector< std::unique_ptr<Func> > parts(frontier.subproblems_.size());
+  std::size_t joined = 0;
+  std::mutex join_mutex;
+
+  parallel_for(frontier.subproblems_.size(), workers,
+    [&](std::size_t, std::size_t i) {
+      detail::mrt_no_split split;
+      subproblem& sp = frontier.subproblems_[i];
+      Map inL_map(sp.inL_map), diG(sp.iG_deleted), dvG(sp.vG_deleted);
+      std::unique_ptr<Func> part(new Func(prototype));
+      detail::rec_mrt_two_graphs_common_spanning_trees<
+          Graph, Func, Seq, Map, detail::mrt_no_split>
+        (iG, iG_bimap, inL_map, diG, vG, vG_bimap, inL_map, dvG, *part,
+          sp.inL, split, depth);
+
+      std::lock_guard<std::mutex> lock(join_mutex);
+      parts[i] = std::move(part);
+      for(; joined < parts.size() && parts[joined]; ++joined) {
+        join(func, *parts[joined]);
+        parts[joined].reset();
+      }
+    });
+}
+
+
 template <
   class Graph,
   class Func,
@@ -0,0 +1,91 @@
+/*
+    SapecNG - Next Generation Symbolic Analysis Program for Electric Circuit
+    Copyright (C) 2009, Michele Caini
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+//  Work sharing over a fixed number of worker threads
+
+#ifndef PARALLEL_FOR_H
+#define PARALLEL_FOR_H
+
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+
+namespace boost
+{
+
+
+//
+//  Calls func(worker, i) once for every i in [0, count), handing the
+//    indices out to the workers as they become idle. The calling thread is
+//    worker 0; workers = 0 means one per hardware thread, and there are
+//    never more workers than indices. The first exception thrown by func
+//    stops the remaining workers and is rethrown once they have joined.
+//
+template <class Func>
+void
+parallel_for
+  (
+    std::size_t count,
+    std::size_t workers,
+    Func func
+  )
+{
+  if(count == 0)
+    return;
+
+  if(workers == 0)
+    workers = std::max(1u, std::thread::hardware_concurrency());
+  workers = std::min(workers, count);
+
+  std::atomic<std::size_t> next(0);
+  std::exception_ptr error;
+  std::atomic<bool> failed(false);
+
+  auto worker = [&](std::size_t t) {
+    try {
+      std::size_t i;
+      while(!failed && (i = next++) < count)
+        func(t, i);
+    } catch(...) {
+      if(!failed.exchange(true))
+        error = std::current_exception();
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for(std::size_t t = 1; t < workers; ++t)
+    threads.push_back(std::thread(worker, t));
+  worker(0);
+  for(std::size_t t = 0; t < threads.size(); ++t)
+    threads[t].join();
+
+  if(error)
+    std::rethrow_exception(error);
+}
+
+
+}
+
+
+#endif // PARALLEL_FOR_H
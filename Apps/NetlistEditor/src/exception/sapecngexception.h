@@ -23,10 +23,14 @@
 
 #include <boost/exception/all.hpp>
 
+#include <string>
+
 
 namespace sapecng
 {
 
+typedef boost::error_info<struct tag_what, std::string> what;
+
 struct sapecng_exception
   : virtual std::exception, virtual boost::exception { };
 
@@ -35,6 +39,7 @@ struct file_error: virtual sapecng_exception { };
 struct stream_error: virtual sapecng_exception { };
 struct read_error: virtual sapecng_exception { };
 struct write_error: virtual sapecng_exception { };
+struct simulation_error: virtual sapecng_exception { };
 
 struct file_read_error
   : virtual file_error, virtual read_error { };
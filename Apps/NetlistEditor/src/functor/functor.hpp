@@ -24,6 +24,8 @@
 #include "model/metacircuit.h"
 
 #include <complex>
+#include <vector>
+#include <cmath>
 #include <map>
 
 
@@ -32,32 +34,58 @@ namespace sapecng
 
 
 
-struct functor
+// Transfer function compiled for one set of component values: the symbolic
+// numerator and denominator are collapsed into dense coefficient vectors
+// (index is the power of s), so that evaluating it no longer involves the
+// symbols at all.
+struct rational_function
 {
 
 public:
-  std::pair< std::vector<double>, std::vector<double> >
-  operator()
-    (
+  rational_function() { }
+
+  rational_function(
       const metacircuit::expression& numerator,
       const metacircuit::expression& denominator,
-      std::map< std::string, double > values
-    )
+      const std::map< std::string, double >& values
+    ): num_(dense(synthesis(numerator, values))),
+       den_(dense(synthesis(denominator, values)))
+  { }
+
+  rational_function(
+      const std::map< int, double >& numerator,
+      const std::map< int, double >& denominator
+    ): num_(dense(numerator)), den_(dense(denominator))
+  { }
+
+  inline const std::vector<double>& numerator() const { return num_; }
+  inline const std::vector<double>& denominator() const { return den_; }
+
+  // H(j * 2 * pi * f) for every frequency, with Horner's scheme running
+  // over all the frequencies at once for each coefficient
+  std::vector< std::complex<double> >
+  frequency_response(const std::vector<double>& frequencies) const
   {
-    std::map< int, double > real_num = synthesis(numerator, values);
-    std::map< int, double > real_den = synthesis(denominator, values);
-    return op(real_num, real_den);
-  }
+    std::vector<double> omega(frequencies.size());
+    for(std::vector<double>::size_type i = 0; i < omega.size(); ++i)
+      omega[i] = 2. * 4.0 * std::atan(1.0) * frequencies[i];
 
-protected:
-  virtual std::pair< std::vector<double>, std::vector<double> >
-    op(std::map< int, double > num, std::map< int, double > den) = 0;
+    std::vector<double> num_re, num_im, den_re, den_im;
+    horner(num_, omega, num_re, num_im);
+    horner(den_, omega, den_re, den_im);
 
-private:
-  std::map< int, double >
+    std::vector< std::complex<double> > response(omega.size());
+    for(std::vector<double>::size_type i = 0; i < omega.size(); ++i)
+      response[i] = std::complex<double>(num_re[i], num_im[i])
+        / std::complex<double>(den_re[i], den_im[i]);
+
+    return response;
+  }
+
+  static std::map< int, double >
   synthesis(
       const metacircuit::expression& expr,
-      std::map< std::string, double > values
+      const std::map< std::string, double >& values
     )
   {
     std::map< int, double > syn;
@@ -72,7 +100,11 @@ private:
         double sub_value = dit->first;
         for(std::list<std::string>::const_iterator
             it = dit->second.begin(); it != dit->second.end(); ++it)
-          sub_value *= values[*it]; // 0-default drives from standard C++
+        {
+          std::map< std::string, double >::const_iterator
+            vit = values.find(*it);
+          sub_value *= (vit != values.end() ? vit->second : 0.);
+        }
 
         value += sub_value;
       }
@@ -82,6 +114,106 @@ private:
     return syn;
   }
 
+private:
+  static std::vector<double> dense(const std::map< int, double >& p)
+  {
+    std::vector<double> coeffs;
+    for(std::map< int, double >::const_iterator it = p.begin();
+      it != p.end(); ++it)
+    {
+      if(it->first < 0)
+        continue;
+      if(coeffs.size() <= (std::vector<double>::size_type) it->first)
+        coeffs.resize(it->first + 1, 0.);
+      coeffs[it->first] += it->second;
+    }
+
+    return coeffs;
+  }
+
+  // p(j * omega), kept as separate real and imaginary parts so that the
+  // inner loop is a plain multiply-add over the frequencies
+  static void horner(
+      const std::vector<double>& p,
+      const std::vector<double>& omega,
+      std::vector<double>& re,
+      std::vector<double>& im
+    )
+  {
+    std::vector<double>::size_type n = omega.size();
+    re.assign(n, 0.);
+    im.assign(n, 0.);
+
+    for(std::vector<double>::size_type k = p.size(); k > 0; --k) {
+      double c = p[k - 1];
+      for(std::vector<double>::size_type i = 0; i < n; ++i) {
+        double r = re[i];
+        re[i] = c - im[i] * omega[i];
+        im[i] = r * omega[i];
+      }
+    }
+  }
+
+private:
+  std::vector<double> num_;
+  std::vector<double> den_;
+
+};
+
+
+
+// Frequencies and values of a transfer function over a sweep, shared by
+// all the curves plotted for the same parameters.
+struct frequency_response
+{
+
+  frequency_response() { }
+
+  frequency_response(
+      const rational_function& h,
+      std::pair< double, double > range,
+      double step
+    )
+  {
+    if(step > 0 && range.first <= range.second)
+    {
+      for(double cnt = range.first; cnt < range.second; cnt += step)
+        frequencies.push_back(cnt);
+    }
+
+    values = h.frequency_response(frequencies);
+  }
+
+  std::vector<double> frequencies;
+  std::vector< std::complex<double> > values;
+
+};
+
+
+
+struct functor
+{
+
+public:
+  std::pair< std::vector<double>, std::vector<double> >
+  operator()
+    (
+      const metacircuit::expression& numerator,
+      const metacircuit::expression& denominator,
+      std::map< std::string, double > values
+    )
+  {
+    std::map< int, double > real_num =
+      rational_function::synthesis(numerator, values);
+    std::map< int, double > real_den =
+      rational_function::synthesis(denominator, values);
+    return op(real_num, real_den);
+  }
+
+protected:
+  virtual std::pair< std::vector<double>, std::vector<double> >
+    op(std::map< int, double > num, std::map< int, double > den) = 0;
+
 };
 
 
@@ -93,52 +225,31 @@ public:
   frequency_range_functor(std::pair< double, double > range, double step)
     : range_(range), step_(step) { }
 
-protected:
-  virtual double apply( std::complex<double> v ) = 0;
+  using functor::operator();
 
-private:
+  // curve from an already evaluated sweep
   std::pair< std::vector<double>, std::vector<double> >
-    op(std::map< int, double > num, std::map< int, double > den)
+  operator()(const frequency_response& response)
   {
     std::pair< std::vector<double>, std::vector<double> > plot;
-    if(step_ > 0 && range_.first <= range_.second)
-    {
-      for(double cnt = range_.first; cnt < range_.second; cnt += step_)
-      {
-        std::complex<double> cnum = compute(num, cnt);
-        std::complex<double> cden = compute(den, cnt);
-
-        plot.first.push_back(cnt);
-        plot.second.push_back( apply(cnum / cden) );
-      }
-    }
+    plot.first = response.frequencies;
+    plot.second.reserve(response.values.size());
+    for(std::vector< std::complex<double> >::size_type i = 0;
+        i < response.values.size(); ++i)
+      plot.second.push_back( apply(response.values[i]) );
 
     return plot;
   }
 
-  std::complex<double>
-  compute(
-      std::map< int, double > expr,
-      double step
-    )
-  {
-    std::complex<double> cvalue(0., 0.);
-    for(std::map< int, double >::const_iterator it = expr.begin();
-      it != expr.end(); ++it)
-    {
-      bool real = (it->first % 2 == 0);
-      double value =
-          std::pow(-1., ((it->first - (real ? 0 : 1)) / 2))
-        * std::pow(2. * 4.0 * std::atan(1.0) * step, it->first)
-        * it->second;
-
-      if(real)
-        cvalue += std::complex<double>(value, 0.);
-      else
-        cvalue += std::complex<double>(0., value);
-    }
+protected:
+  virtual double apply( std::complex<double> v ) = 0;
 
-    return cvalue;
+private:
+  std::pair< std::vector<double>, std::vector<double> >
+    op(std::map< int, double > num, std::map< int, double > den)
+  {
+    return (*this)(
+        frequency_response(rational_function(num, den), range_, step_));
   }
 
 private:
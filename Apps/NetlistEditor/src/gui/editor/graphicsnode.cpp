@@ -18,6 +18,7 @@
 
 
 #include "gui/editor/graphicsnode.h"
+#include "gui/editor/schematicscene.h"
 
 #include <QGraphicsTextItem>
 #include <QGraphicsScene>
@@ -54,6 +55,10 @@ GraphicsNode::GraphicsNode(
 
 GraphicsNode::~GraphicsNode()
 {
+  SchematicScene* schematic = qobject_cast<SchematicScene*>(scene());
+  if(schematic)
+    schematic->unindexNode(this);
+
   foreach(GraphicsNode* item, itemSet_)
     item->detach(this);
 
@@ -132,14 +137,25 @@ void GraphicsNode::updateItemSet()
   dataPointer_.detach();
   itemSet_.clear();
 
-  QList<QGraphicsItem*> collidingItemList = collidingItems();
-  foreach(QGraphicsItem* graphicsItem, collidingItemList) {
-    GraphicsNode* item =
-      qgraphicsitem_cast<GraphicsNode*>(graphicsItem);
-
-    if(item) {
-      item->attach(this);
-      itemSet_.insert(item);
+  SchematicScene* schematic = qobject_cast<SchematicScene*>(scene());
+  if(schematic) {
+    // only the nodes around this one can collide with it
+    schematic->indexNode(this);
+    foreach(GraphicsNode* item, schematic->indexedNodes(sceneBoundingRect()))
+      if(item != this && collidesWithItem(item)) {
+        item->attach(this);
+        itemSet_.insert(item);
+      }
+  } else {
+    QList<QGraphicsItem*> collidingItemList = collidingItems();
+    foreach(QGraphicsItem* graphicsItem, collidingItemList) {
+      GraphicsNode* item =
+        qgraphicsitem_cast<GraphicsNode*>(graphicsItem);
+
+      if(item) {
+        item->attach(this);
+        itemSet_.insert(item);
+      }
     }
   }
 
@@ -164,6 +180,16 @@ QVariant GraphicsNode::itemChange(GraphicsItemChange change, const QVariant& val
   if(change == ItemPositionHasChanged)
     updateItemSet();
 
+  if(change == ItemSceneChange) {
+    SchematicScene* schematic = qobject_cast<SchematicScene*>(scene());
+    if(schematic)
+      schematic->unindexNode(this);
+  } else if(change == ItemSceneHasChanged) {
+    SchematicScene* schematic = qobject_cast<SchematicScene*>(scene());
+    if(schematic)
+      schematic->indexNode(this);
+  }
+
   return QGraphicsItem::itemChange(change, value);
 }
 
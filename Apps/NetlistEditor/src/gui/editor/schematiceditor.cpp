@@ -18,6 +18,7 @@
 
 
 #include "model/metacircuit.h"
+#include "model/transient.h"
 #include "parser/parser_factory.h"
 #include "parser/crc_circuit.h"
 
@@ -26,6 +27,8 @@
 #include "gui/editor/schematicsceneparser.h"
 #include "gui/settings.h"
 #include "gui/qlogger.h"
+#include "gui/transientdialog.h"
+#include "gui/sweepdialog.h"
 
 #include <QtCore/QPointer>
 #include <QtCore/QFileInfo>
@@ -519,6 +522,53 @@ void SchematicEditor::solve()
 }
 
 
+void SchematicEditor::simulateTransient()
+{
+  scene_->assignNodes();
+
+  sapecng::netlist netlist;
+  try {
+    sapecng::netlist_builder builder(netlist);
+    SchematicSceneParser parser(*scene_);
+    parser.parse(builder);
+  } catch(sapecng::simulation_error& e) {
+    const std::string* info = boost::get_error_info<sapecng::what>(e);
+    QString message = info ? QString::fromStdString(*info) : QString();
+    QLogger::error(QObject::tr("Transient simulation failed: ") + message);
+    QMessageBox::warning(this, tr("Transient simulation"), message);
+    return;
+  }
+
+  TransientDialog* dialog = new TransientDialog(netlist, this);
+  dialog->setAttribute(Qt::WA_DeleteOnClose);
+  dialog->show();
+}
+
+
+void SchematicEditor::simulateSweep()
+{
+  scene_->assignNodes();
+
+  sapecng::netlist netlist;
+  try {
+    sapecng::netlist_builder builder(netlist);
+    SchematicSceneParser parser(*scene_);
+    parser.parse(builder);
+  } catch(sapecng::simulation_error& e) {
+    const std::string* info = boost::get_error_info<sapecng::what>(e);
+    QString message = info ? QString::fromStdString(*info) : QString();
+    QLogger::error(QObject::tr("Parameter sweep failed: ") + message);
+    QMessageBox::warning(this, tr("Parameter sweep"), message);
+    return;
+  }
+
+  SchematicSceneParser parser(*scene_);
+  SweepDialog* dialog = new SweepDialog(netlist, parser, this);
+  dialog->setAttribute(Qt::WA_DeleteOnClose);
+  dialog->show();
+}
+
+
 void SchematicEditor::reset()
 {
   scene_->clearSchematicScene();
@@ -68,6 +68,8 @@ public slots:
   bool saveFile(const QString& fileName);
   bool loadFile(const QString& fileName);
   void solve();
+  void simulateTransient();
+  void simulateSweep();
 
 signals:
   void stackEditor(SchematicEditor* editor);
@@ -23,6 +23,7 @@
 #include "gui/editor/schematicsceneparser.h"
 #include "gui/editor/undoredocommand.h"
 #include "gui/editor/component.h"
+#include "gui/editor/graphicsnode.h"
 #include "gui/editor/label.h"
 #include "gui/editor/wire.h"
 #include "gui/editor/item.h"
@@ -44,6 +45,7 @@
 #include <QtCore/QRegExp>
 #include <QtCore/QCryptographicHash>
 #include <QtCore/QPointer>
+#include <QtCore/QtMath>
 
 #include <QKeyEvent>
 #include <QMenu>
@@ -2276,21 +2278,20 @@ QVector<int> SchematicScene::ports() {
 
 void SchematicScene::passPrescribedPressureNodesTheirNodeIndices()
 {
-	// Working component by component...
-	foreach(Item* component, standardList_)
+	QSet<Item*> components = standardList_.toSet();
+
+	// Working prescribed pressure node by prescribed pressure node...
+	foreach(Item* prescribedPressureNode, prescribedPressureNodesList_)
 	{
-		// ...check each component's nodes to see if it intersects with a prescribed presure graphics object node:
-		// (i.e. whether that node has a prescribed pressure.
-		// If so, copy the node index from the component's node to the 
-		// prescribed pressure node object (because they're both annotations to the same conceptual node)
-		foreach(Item* prescribedPressureNode, prescribedPressureNodesList_)
+		// ...look up the component nodes lying under it in the node index, and
+		// copy the node index from the component's node to the prescribed
+		// pressure node object (because they're both annotations to the same
+		// conceptual node)
+		foreach(GraphicsNode* componentNode, indexedNodes(prescribedPressureNode->sceneBoundingRect()))
 		{
-			int collidingNodeIndex;
-			bool componentHasThisPrescribedPressureNode = static_cast<Component*>(component)->hasPrescribedPressureNode(static_cast<Component*>(prescribedPressureNode), collidingNodeIndex);
-			
-			if (componentHasThisPrescribedPressureNode)
+			if (components.contains(componentNode->owner()) && componentNode->collidesWithItem(prescribedPressureNode))
 			{
-				static_cast<Component*>(prescribedPressureNode)->setIndexIfThisIsAPrescribedPressureNode(collidingNodeIndex);
+				static_cast<Component*>(prescribedPressureNode)->setIndexIfThisIsAPrescribedPressureNode(componentNode->node()->value());
 			}
 		}
 	}
@@ -2309,22 +2310,27 @@ void SchematicScene::detectComponentAt3DInterface()
 	int componentsFoundAt3DInterface = 0;
 	if (threeDInterfaceNodeList_.size() > 0)
 	{
+		// First, we begin by assuming no component is at the 3D Interface
+		// This is in case the user has moved the 3D interface tag since
+		// the last call to this function.
 		foreach(Item* component, standardList_)
-		{
-			// First, we begin by assuming the component is not at the 3D Interface
-			// This is in case the user has moved the 3D interface tag since
-			// the last call to this function.
 			static_cast<Component*>(component)->resetIsNotAt3DInterface();
 
-			// Check for collisions between the node at the 3D interface and
-			// the nodes of each component. This lets us find which component
-			// is at the 3D interface.
-			if (static_cast<Component*>(component)->connectsTo3DInterfaceNode(static_cast<Component*>(threeDInterfaceNodeList_.last())))
-			{
-				static_cast<Component*>(component)->setIsAt3DInterface();
-				componentsFoundAt3DInterface++;
-			}
+		// Check for collisions between the node at the 3D interface and
+		// the component nodes found around it in the node index. This lets
+		// us find which component is at the 3D interface.
+		Item* threeDInterfaceNode = threeDInterfaceNodeList_.last();
+		QSet<Item*> components = standardList_.toSet();
+		QSet<Item*> componentsAt3DInterface;
+		foreach(GraphicsNode* componentNode, indexedNodes(threeDInterfaceNode->sceneBoundingRect()))
+		{
+			if (components.contains(componentNode->owner()) && componentNode->collidesWithItem(threeDInterfaceNode))
+				componentsAt3DInterface.insert(componentNode->owner());
 		}
+
+		foreach(Item* component, componentsAt3DInterface)
+			static_cast<Component*>(component)->setIsAt3DInterface();
+		componentsFoundAt3DInterface = componentsAt3DInterface.size();
 	}
 
 	if (componentsFoundAt3DInterface != 1)
@@ -2338,6 +2344,8 @@ void SchematicScene::detectComponentAt3DInterface()
 void SchematicScene::assignNodes(int seed)
 {
   resetStatus();
+  flushNodeReset();
+  nodesShown_ = true;
 
   foreach(Item* item, groundList_)
     //static_cast<Component*>(item)->propagate(SchematicScene::Ground);
@@ -2365,7 +2373,10 @@ void SchematicScene::assignNodes(int seed)
   passPrescribedPressureNodesTheirNodeIndices();
   detectComponentAt3DInterface();
   numberOfNodes_ = seed - 1;
+
+  beginPropertyBatch();
   createInitialNodePressurePropertiesInBrowser(numberOfNodes_);
+  endPropertyBatch();
 }
 
 int SchematicScene::getNumberOfNodes() const
@@ -2380,17 +2391,24 @@ int SchematicScene::getNumberOfNodes() const
 
 void SchematicScene::createInitialNodePressurePropertiesInBrowser(const int numberOfNodes)
 {
-	// Ensure we're starting with a clean set of initial node pressure properties:
-	properties_->removeSubProperty(typeRootMap_[AllNodesType]);
-	QList<QtProperty*> existingNodalInitialPressureProperties = typeRootMap_[AllNodesType]->subProperties();
-	foreach(QtProperty* subproperty, existingNodalInitialPressureProperties)
+	QtProperty* nodesRoot = typeRootMap_[AllNodesType];
+
+	// Reuse the properties of the nodes that are still there, rather than
+	// rebuilding (and having the browser rebuild the editors of) all of them.
+	// They still start again from a clean initial pressure:
+	//\todo fix this so it doesnt forget pressure prescriptions the user has already set when you call this function
+	QList<QtProperty*> existingNodalInitialPressureProperties = nodesRoot->subProperties();
+	for (int node = 1; node <= existingNodalInitialPressureProperties.size(); node++)
 	{
-		//\todo fix this so it doesnt forget pressure prescriptions the user has already set when you call this function
-		typeRootMap_[AllNodesType]->removeSubProperty(subproperty);
+		QtProperty* nodalInitialPressureProperty = existingNodalInitialPressureProperties.at(node - 1);
+		if (node <= numberOfNodes)
+			doublePropertyManager_->setValue(nodalInitialPressureProperty, 0.0);
+		else
+			nodesRoot->removeSubProperty(nodalInitialPressureProperty);
 	}
 
-	// Add the (up-to-date for the present state of the circuit) nodal pressure properties:
-	for (int node = 1; node <= numberOfNodes; node++)
+	// Add the (up-to-date for the present state of the circuit) nodal pressure properties still missing:
+	for (int node = existingNodalInitialPressureProperties.size() + 1; node <= numberOfNodes; node++)
 	{
 		QString propertyNameForThisPressureNode = "Initial Pressure at Node " + QString::number(node);
 		QtProperty* nodalInitialPressureProperty = doublePropertyManager_->addProperty(propertyNameForThisPressureNode);
@@ -2398,8 +2416,17 @@ void SchematicScene::createInitialNodePressurePropertiesInBrowser(const int numb
 		doublePropertyManager_->setSingleStep(nodalInitialPressureProperty, 0.01);
 		doublePropertyManager_->setDecimals(nodalInitialPressureProperty,13);
 
-		typeRootMap_[AllNodesType]->addSubProperty(nodalInitialPressureProperty);
-		properties_->addSubProperty(typeRootMap_[AllNodesType]);
+		nodesRoot->addSubProperty(nodalInitialPressureProperty);
+	}
+
+	if (numberOfNodes > 0)
+	{
+		if (!properties_->subProperties().contains(nodesRoot))
+			properties_->addSubProperty(nodesRoot);
+	}
+	else
+	{
+		properties_->removeSubProperty(nodesRoot);
 	}
 }
 
@@ -2413,6 +2440,28 @@ void SchematicScene::resetNodes()
 	// Reset the node count to the nonsense value:
 	numberOfNodes_ = -1;
 
+  // Every edit, click and undo step asks for a reset: walking all the items
+  // is left to a single pass once control gets back to the event loop
+  if(!nodeResetPending_) {
+    nodeResetPending_ = true;
+    QMetaObject::invokeMethod(this, "flushNodeReset", Qt::QueuedConnection);
+  }
+}
+
+
+void SchematicScene::flushNodeReset()
+{
+  if(!nodeResetPending_)
+    return;
+
+  nodeResetPending_ = false;
+
+  // nothing to clear if the nodes have not been numbered since last time
+  if(!nodesShown_)
+    return;
+
+  nodesShown_ = false;
+
   foreach(Item* item, groundList_)
     static_cast<Component*>(item)->invalidate();
   foreach(Item* item, threeDInterfaceNodeList_)
@@ -2429,9 +2478,103 @@ void SchematicScene::resetNodes()
     static_cast<Component*>(out_)->invalidate();
 
   // sub-circuits reset
-  foreach(Item* item, userDefList_)
-    item->data(101)
-      .value< QPointer<qsapecng::SchematicScene> >()->resetNodes();
+  foreach(Item* item, userDefList_) {
+    QPointer<qsapecng::SchematicScene> rep =
+      item->data(101).value< QPointer<qsapecng::SchematicScene> >();
+
+    rep->resetNodes();
+    rep->flushNodeReset();
+  }
+}
+
+
+quint64 SchematicScene::nodeCell(int x, int y)
+{
+  return (quint64(quint32(x)) << 32) | quint32(y);
+}
+
+
+void SchematicScene::indexNode(GraphicsNode* node)
+{
+  QPointF pos = node->scenePos();
+  quint64 cell = nodeCell(qRound(pos.x() / GridStep), qRound(pos.y() / GridStep));
+
+  QHash<GraphicsNode*, quint64>::iterator it = nodeCells_.find(node);
+  if(it != nodeCells_.end()) {
+    if(it.value() == cell)
+      return;
+
+    QHash<quint64, QList<GraphicsNode*> >::iterator old = nodeIndex_.find(it.value());
+    old.value().removeOne(node);
+    if(old.value().isEmpty())
+      nodeIndex_.erase(old);
+
+    it.value() = cell;
+  } else {
+    nodeCells_.insert(node, cell);
+  }
+
+  nodeIndex_[cell].append(node);
+}
+
+
+void SchematicScene::unindexNode(GraphicsNode* node)
+{
+  QHash<GraphicsNode*, quint64>::iterator it = nodeCells_.find(node);
+  if(it == nodeCells_.end())
+    return;
+
+  QHash<quint64, QList<GraphicsNode*> >::iterator cell = nodeIndex_.find(it.value());
+  cell.value().removeOne(node);
+  if(cell.value().isEmpty())
+    nodeIndex_.erase(cell);
+
+  nodeCells_.erase(it);
+}
+
+
+QList<GraphicsNode*> SchematicScene::indexedNodes(const QRectF& rect) const
+{
+  // one more cell all around, for the nodes lying close to the border
+  int left = qFloor(rect.left() / GridStep) - 1;
+  int right = qCeil(rect.right() / GridStep) + 1;
+  int top = qFloor(rect.top() / GridStep) - 1;
+  int bottom = qCeil(rect.bottom() / GridStep) + 1;
+
+  QList<GraphicsNode*> nodes;
+  for(int x = left; x <= right; ++x)
+    for(int y = top; y <= bottom; ++y) {
+      QHash<quint64, QList<GraphicsNode*> >::const_iterator cell =
+        nodeIndex_.find(nodeCell(x, y));
+      if(cell != nodeIndex_.end())
+        nodes.append(cell.value());
+    }
+
+  return nodes;
+}
+
+
+void SchematicScene::beginPropertyBatch()
+{
+  ++propertyBatch_;
+}
+
+
+void SchematicScene::endPropertyBatch()
+{
+  if(--propertyBatch_ == 0 && propertyBatchChanged_) {
+    propertyBatchChanged_ = false;
+    emit propertyChanged();
+  }
+}
+
+
+void SchematicScene::forwardPropertyChanged()
+{
+  if(propertyBatch_ > 0)
+    propertyBatchChanged_ = true;
+  else
+    emit propertyChanged();
 }
 
 
@@ -2861,6 +3004,11 @@ void SchematicScene::init()
   connect(undoRedoStack_, SIGNAL(indexChanged(int)),
     this, SLOT(resetNodes()));
   numberOfNodes_ = -1; // Initialse to a nonsense value
+
+  nodesShown_ = false;
+  nodeResetPending_ = false;
+  propertyBatch_ = 0;
+  propertyBatchChanged_ = false;
 }
 
 
@@ -2874,13 +3022,13 @@ void SchematicScene::setupProperties()
   doublePropertyManager_ = new QtDoublePropertyManager(this);
 
   connect(boolManager_, SIGNAL(propertyChanged(QtProperty*)),
-    this, SIGNAL(propertyChanged()));
+    this, SLOT(forwardPropertyChanged()));
   connect(stringManager_, SIGNAL(propertyChanged(QtProperty*)),
-    this, SIGNAL(propertyChanged()));
+    this, SLOT(forwardPropertyChanged()));
   connect(managerForAllDropdownBoxProperties_, SIGNAL(propertyChanged(QtProperty*)),
-	  this, SIGNAL(propertyChanged()));
+	  this, SLOT(forwardPropertyChanged()));
   connect(doublePropertyManager_, SIGNAL(propertyChanged(QtProperty*)),
-	  this, SIGNAL(propertyChanged()));
+	  this, SLOT(forwardPropertyChanged()));
 
   lineEditFactory_ = new QtLineEditFactory(this);
   lineEditFactory_->addPropertyManager(stringManager_);
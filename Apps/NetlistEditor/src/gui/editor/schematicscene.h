@@ -26,6 +26,7 @@
 #include <QtCore/QList>
 #include <QtCore/QRect>
 #include <QtCore/QHash>
+#include <QtCore/QSet>
 #include <QtCore/QPointF>
 #include <QtCore/QVariant>
 #include <QtCore/QMetaType>
@@ -67,6 +68,7 @@ namespace qsapecng
 
 
 class Component;
+class GraphicsNode;
 class Item;
 class Wire;
 
@@ -207,6 +209,13 @@ public:
   inline int size() { return portList_.size(); }
   void assignNodes(int seed = SchematicScene::Ground + 1);
 
+  // Uniform grid index of the graphics nodes (ports, component nodes and
+  // wire junctions), one cell per grid step. The scene itself runs with
+  // NoIndex, so this is what keeps the connectivity lookups local.
+  void indexNode(GraphicsNode* node);
+  void unindexNode(GraphicsNode* node);
+  QList<GraphicsNode*> indexedNodes(const QRectF& rect) const;
+
 public slots:
   void resetNodes();
   void setGridVisible(bool visible = true);
@@ -216,6 +225,10 @@ signals:
   void showUserDef(SchematicScene& scene);
   void propertyChanged();
 
+private slots:
+  void flushNodeReset();
+  void forwardPropertyChanged();
+
 protected:
   void drawBackground(QPainter* painter, const QRectF& rect);
   void mousePressEvent(QGraphicsSceneMouseEvent* event);
@@ -243,6 +256,12 @@ private:
   void detectComponentAt3DInterface();
   void createInitialNodePressurePropertiesInBrowser(const int numberOfNodes);
 
+  static quint64 nodeCell(int x, int y);
+
+  // property changes made between the two are reported once, at the end
+  void beginPropertyBatch();
+  void endPropertyBatch();
+
   // The name of this function only approximates its functionality; it's a slightly arbitrary grouping of code coming from a refactor of a terribad case statement
   void setupItemLabel(Item* const item, QtProperty* const name);
   void setupComponentControlSpecification(QtVariantProperty*& prop, QtProperty*& customDataFileName);
@@ -305,6 +324,14 @@ private:
   QHash<SupportedItemType, QtProperty*> typeRootMap_;
   int numberOfNodes_;
 
+  QHash<quint64, QList<GraphicsNode*> > nodeIndex_;
+  QHash<GraphicsNode*, quint64> nodeCells_;
+
+  bool nodesShown_;
+  bool nodeResetPending_;
+  int propertyBatch_;
+  bool propertyBatchChanged_;
+
 };
 
 
@@ -297,6 +297,22 @@ void QSapecNGWindow::assignNodes()
 }
 
 
+void QSapecNGWindow::simulateTransient()
+{
+  SchematicEditor* editor = activeEditor();
+  if(editor)
+    editor->simulateTransient();
+}
+
+
+void QSapecNGWindow::simulateSweep()
+{
+  SchematicEditor* editor = activeEditor();
+  if(editor)
+    editor->simulateSweep();
+}
+
+
 // void QSapecNGWindow::resolve()
 // {
 //   SchematicEditor* editor = activeEditor();
@@ -666,6 +682,8 @@ void QSapecNGWindow::updateMenus()
   fitAct_->setEnabled(hasEditor);
 
   nodeAct_->setEnabled(hasEditor);
+  transientAct_->setEnabled(hasEditor);
+  sweepAct_->setEnabled(hasEditor);
   // resolveAct_->setEnabled(hasEditor);
   // waveAct_->setEnabled(hasEditor);
 
@@ -895,6 +913,16 @@ void QSapecNGWindow::createActions()
   nodeAct_->setStatusTip(tr("Assign nodes"));
   connect(nodeAct_, SIGNAL(triggered()), this, SLOT(assignNodes()));
 
+  transientAct_ = new QAction(tr("&Transient simulation..."), this);
+  transientAct_->setShortcut(tr("F8"));
+  transientAct_->setStatusTip(tr("Simulate the network response over time"));
+  connect(transientAct_, SIGNAL(triggered()), this, SLOT(simulateTransient()));
+
+  sweepAct_ = new QAction(tr("Parameter &sweep..."), this);
+  sweepAct_->setShortcut(tr("Shift+F8"));
+  sweepAct_->setStatusTip(tr("Sweep component values and save the responses"));
+  connect(sweepAct_, SIGNAL(triggered()), this, SLOT(simulateSweep()));
+
   // resolveAct_ = new QAction(QIcon(":/images/resolve.png"), tr("&Resolve..."), this);
   // resolveAct_->setShortcut(tr("F8"));
   // resolveAct_->setStatusTip(tr("Resolve"));
@@ -1181,6 +1209,8 @@ void QSapecNGWindow::createMenus()
 
   runMenu_ = menuBar()->addMenu(tr("&Run"));
   runMenu_->addAction(nodeAct_);
+  runMenu_->addAction(transientAct_);
+  runMenu_->addAction(sweepAct_);
   // runMenu_->addAction(resolveAct_);
   // runMenu_->addAction(waveAct_);
 
@@ -1270,6 +1300,8 @@ void QSapecNGWindow::createToolBars()
 
   runToolBar_ = addToolBar(tr("Run"));
   runToolBar_->addAction(nodeAct_);
+  runToolBar_->addAction(transientAct_);
+  runToolBar_->addAction(sweepAct_);
   // runToolBar_->addAction(resolveAct_);
   // runToolBar_->addAction(waveAct_);
 
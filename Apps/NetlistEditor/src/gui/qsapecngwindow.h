@@ -93,6 +93,8 @@ private slots:
 
   // void wave();
   void assignNodes();
+  void simulateTransient();
+  void simulateSweep();
   // void resolve();
   // void plot(int f);
   // void xAxisLogScale(bool log);
@@ -245,6 +247,8 @@ private:
   QAction* zoomNormalAct_;
   QAction* fitAct_;
   QAction* nodeAct_;
+  QAction* transientAct_;
+  QAction* sweepAct_;
   // QAction* resolveAct_;
   // QAction* waveAct_;
   QAction* toggleScreenModeAct_;
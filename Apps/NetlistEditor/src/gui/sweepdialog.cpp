@@ -0,0 +1,425 @@
+#include "gui/sweepdialog.h"
+#include "gui/settings.h"
+#include "gui/qlogger.h"
+
+#include <QComboBox>
+#include <QDoubleSpinBox>
+#include <QSpinBox>
+#include <QPushButton>
+#include <QMessageBox>
+#include <QDialogButtonBox>
+#include <QFileDialog>
+#include <QGroupBox>
+#include <QHeaderView>
+#include <QStackedWidget>
+#include <QTableWidget>
+#include <QApplication>
+#include <QtCore/QFile>
+
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <set>
+
+
+namespace qsapecng
+{
+
+
+namespace
+{
+
+const std::size_t max_steps = 10000000;
+const std::size_t max_rows = 100000000;
+
+enum { grid_sampling, latin_hypercube_sampling };
+enum { frequency_analysis, transient_analysis };
+enum { name_column, min_column, max_column, levels_column };
+
+
+// value of every named component, the names are the symbols of the
+// transfer function as well
+std::map<std::string, double> component_values(
+    const sapecng::netlist& netlist)
+{
+  std::map<std::string, double> values;
+  const std::vector<sapecng::netlist::component>& comps =
+    netlist.components();
+  for(std::vector<sapecng::netlist::component>::const_iterator it =
+        comps.begin(); it != comps.end(); ++it)
+    if(!it->name.empty())
+      values.insert(std::make_pair(it->name, it->value));
+
+  return values;
+}
+
+
+QDoubleSpinBox* valueSpinBox(double value)
+{
+  QDoubleSpinBox* spin = new QDoubleSpinBox;
+  spin->setDecimals(6);
+  spin->setRange(
+    -std::numeric_limits<double>::max(), std::numeric_limits<double>::max());
+  spin->setValue(value);
+  return spin;
+}
+
+}
+
+
+
+SweepDialog::SweepDialog(
+    const sapecng::netlist& netlist,
+    sapecng::abstract_parser& parser,
+    QWidget* parent
+  ): QDialog(parent), netlist_(netlist), solved_(false)
+{
+  sapecng::circuit_builder builder(circuit_);
+  parser.parse(builder);
+
+  parameters_ = new QTableWidget(0, 4);
+  parameters_->setHorizontalHeaderLabels(QStringList()
+    << tr("Component") << tr("Min") << tr("Max") << tr("Levels"));
+  parameters_->horizontalHeader()->setSectionResizeMode(
+    QHeaderView::ResizeToContents);
+  parameters_->verticalHeader()->hide();
+  parameters_->setSelectionBehavior(QAbstractItemView::SelectRows);
+  parameters_->setSelectionMode(QAbstractItemView::SingleSelection);
+
+  QPushButton* addButton = new QPushButton(tr("&Add"));
+  QPushButton* removeButton = new QPushButton(tr("Re&move"));
+  addButton->setEnabled(!component_values(netlist_).empty());
+  connect(addButton, SIGNAL(clicked(bool)), this, SLOT(addParameter()));
+  connect(removeButton, SIGNAL(clicked(bool)), this, SLOT(removeParameter()));
+
+  QHBoxLayout* tableButtons = new QHBoxLayout;
+  tableButtons->addWidget(addButton);
+  tableButtons->addWidget(removeButton);
+  tableButtons->addStretch();
+
+  QVBoxLayout* parametersLayout = new QVBoxLayout;
+  parametersLayout->addWidget(parameters_);
+  parametersLayout->addLayout(tableButtons);
+  QGroupBox* parametersBox = new QGroupBox(tr("Parameters"));
+  parametersBox->setLayout(parametersLayout);
+
+  sampling_ = new QComboBox;
+  sampling_->addItem(tr("Grid"));
+  sampling_->addItem(tr("Latin hypercube"));
+  samples_ = new QSpinBox;
+  samples_->setRange(1, 1000000);
+  samples_->setValue(100);
+  seed_ = new QSpinBox;
+  seed_->setRange(0, std::numeric_limits<int>::max());
+  connect(sampling_, SIGNAL(currentIndexChanged(int)),
+    this, SLOT(samplingChanged(int)));
+
+  QFormLayout* samplingLayout = new QFormLayout;
+  samplingLayout->addRow(tr("Method:"), sampling_);
+  samplingLayout->addRow(tr("Samples:"), samples_);
+  samplingLayout->addRow(tr("Seed:"), seed_);
+  samplingLayout->setFieldGrowthPolicy(QFormLayout::FieldsStayAtSizeHint);
+  QGroupBox* samplingBox = new QGroupBox(tr("Sampling"));
+  samplingBox->setLayout(samplingLayout);
+
+  fmin_ = new QDoubleSpinBox;
+  fmin_->setDecimals(6);
+  fmin_->setRange(1e-6, 1e9);
+  fmin_->setValue(0.1);
+  fmax_ = new QDoubleSpinBox;
+  fmax_->setDecimals(6);
+  fmax_->setRange(1e-6, 1e9);
+  fmax_->setValue(100.);
+  points_ = new QSpinBox;
+  points_->setRange(1, 100000);
+  points_->setValue(200);
+
+  QFormLayout* frequencyLayout = new QFormLayout;
+  frequencyLayout->addRow(tr("From (Hz):"), fmin_);
+  frequencyLayout->addRow(tr("To (Hz):"), fmax_);
+  frequencyLayout->addRow(tr("Points:"), points_);
+  frequencyLayout->setFieldGrowthPolicy(QFormLayout::FieldsStayAtSizeHint);
+  QWidget* frequencyPage = new QWidget;
+  frequencyPage->setLayout(frequencyLayout);
+
+  dt_ = new QDoubleSpinBox;
+  dt_->setDecimals(6);
+  dt_->setRange(1e-6, 1.);
+  dt_->setValue(1e-3);
+  duration_ = new QDoubleSpinBox;
+  duration_->setDecimals(3);
+  duration_->setRange(1e-3, 1e4);
+  duration_->setValue(1.);
+  stride_ = new QSpinBox;
+  stride_->setRange(1, std::numeric_limits<int>::max());
+  stride_->setValue(10);
+  flow_ = valueSpinBox(0.);
+  flow_->setDecimals(5);
+
+  QFormLayout* transientLayout = new QFormLayout;
+  transientLayout->addRow(tr("Time step (s):"), dt_);
+  transientLayout->addRow(tr("Duration (s):"), duration_);
+  transientLayout->addRow(tr("Output every (steps):"), stride_);
+  transientLayout->addRow(tr("Interface flow:"), flow_);
+  transientLayout->setFieldGrowthPolicy(QFormLayout::FieldsStayAtSizeHint);
+  QWidget* transientPage = new QWidget;
+  transientPage->setLayout(transientLayout);
+
+  analysis_ = new QComboBox;
+  analysis_->addItem(tr("Frequency response"));
+  analysis_->addItem(tr("Transient"));
+  analysisPages_ = new QStackedWidget;
+  analysisPages_->addWidget(frequencyPage);
+  analysisPages_->addWidget(transientPage);
+  connect(analysis_, SIGNAL(currentIndexChanged(int)),
+    analysisPages_, SLOT(setCurrentIndex(int)));
+
+  QVBoxLayout* analysisLayout = new QVBoxLayout;
+  analysisLayout->addWidget(analysis_);
+  analysisLayout->addWidget(analysisPages_);
+  QGroupBox* analysisBox = new QGroupBox(tr("Analysis"));
+  analysisBox->setLayout(analysisLayout);
+
+  QDialogButtonBox* buttonBox = new QDialogButtonBox;
+  QPushButton* runButton =
+    buttonBox->addButton(tr("&Run..."), QDialogButtonBox::ApplyRole);
+  QPushButton* closeButton = buttonBox->addButton(QDialogButtonBox::Close);
+  connect(runButton, SIGNAL(clicked(bool)), this, SLOT(run()));
+  connect(closeButton, SIGNAL(clicked(bool)), this, SLOT(close()));
+
+  QVBoxLayout* sideLayout = new QVBoxLayout;
+  sideLayout->addWidget(samplingBox);
+  sideLayout->addWidget(analysisBox);
+  sideLayout->addStretch();
+
+  QHBoxLayout* topLayout = new QHBoxLayout;
+  topLayout->addWidget(parametersBox, 1);
+  topLayout->addLayout(sideLayout);
+
+  QVBoxLayout* mainLayout = new QVBoxLayout;
+  mainLayout->addLayout(topLayout);
+  mainLayout->addWidget(buttonBox);
+  setLayout(mainLayout);
+
+  samplingChanged(sampling_->currentIndex());
+
+  setWindowTitle(tr("Parameter sweep"));
+  resize(800, 450);
+}
+
+
+void SweepDialog::addParameter()
+{
+  std::map<std::string, double> values = component_values(netlist_);
+
+  std::set<std::string> used;
+  for(int r = 0; r < parameters_->rowCount(); ++r)
+    used.insert(static_cast<QComboBox*>(
+      parameters_->cellWidget(r, name_column))->currentText().toStdString());
+
+  // the first component not swept yet
+  QComboBox* name = new QComboBox;
+  std::map<std::string, double>::const_iterator first = values.end();
+  for(std::map<std::string, double>::const_iterator it = values.begin();
+      it != values.end(); ++it) {
+    name->addItem(QString::fromStdString(it->first));
+    if(first == values.end() && !used.count(it->first)) {
+      first = it;
+      name->setCurrentIndex(name->count() - 1);
+    }
+  }
+  if(first == values.end())
+    first = values.begin();
+
+  // half to one and a half times the current value
+  double low = first->second / 2.;
+  double high = first->second * 3. / 2.;
+
+  QSpinBox* levels = new QSpinBox;
+  levels->setRange(1, 1000);
+  levels->setValue(5);
+
+  int row = parameters_->rowCount();
+  parameters_->insertRow(row);
+  parameters_->setCellWidget(row, name_column, name);
+  parameters_->setCellWidget(row, min_column,
+    valueSpinBox(std::min(low, high)));
+  parameters_->setCellWidget(row, max_column,
+    valueSpinBox(std::max(low, high)));
+  parameters_->setCellWidget(row, levels_column, levels);
+  parameters_->selectRow(row);
+}
+
+
+void SweepDialog::removeParameter()
+{
+  int row = parameters_->currentRow();
+  if(row >= 0)
+    parameters_->removeRow(row);
+}
+
+
+void SweepDialog::samplingChanged(int index)
+{
+  samples_->setEnabled(index == latin_hypercube_sampling);
+  seed_->setEnabled(index == latin_hypercube_sampling);
+  parameters_->setColumnHidden(levels_column, index != grid_sampling);
+}
+
+
+std::vector<sapecng::sweep_parameter> SweepDialog::parameters() const
+{
+  std::vector<sapecng::sweep_parameter> parameters;
+  for(int r = 0; r < parameters_->rowCount(); ++r) {
+    sapecng::sweep_parameter par;
+    par.name = static_cast<QComboBox*>(
+      parameters_->cellWidget(r, name_column))->currentText().toStdString();
+    par.min = static_cast<QDoubleSpinBox*>(
+      parameters_->cellWidget(r, min_column))->value();
+    par.max = static_cast<QDoubleSpinBox*>(
+      parameters_->cellWidget(r, max_column))->value();
+    par.levels = static_cast<QSpinBox*>(
+      parameters_->cellWidget(r, levels_column))->value();
+    parameters.push_back(par);
+  }
+
+  return parameters;
+}
+
+
+void SweepDialog::run()
+{
+  std::vector<sapecng::sweep_parameter> parameters = this->parameters();
+  if(parameters.empty()) {
+    QMessageBox::warning(this, tr("Parameter sweep"),
+      tr("Add at least one component to sweep."));
+    return;
+  }
+
+  std::size_t block;
+  if(analysis_->currentIndex() == frequency_analysis) {
+    block = points_->value();
+  } else {
+    std::size_t steps =
+      std::size_t(std::ceil(duration_->value() / dt_->value()));
+    if(steps > max_steps) {
+      QMessageBox::warning(this, tr("Parameter sweep"),
+        tr("Too many time steps, increase the time step or reduce the duration."));
+      return;
+    }
+    block = std::max<std::size_t>(steps / stride_->value(), 1);
+  }
+
+  // count the samples before building them, the grid grows quickly
+  std::size_t count = samples_->value();
+  if(sampling_->currentIndex() == grid_sampling) {
+    count = 1;
+    for(std::vector<sapecng::sweep_parameter>::const_iterator it =
+          parameters.begin(); it != parameters.end() && count; ++it)
+      count = count > max_rows / it->levels ? 0 : count * it->levels;
+  }
+  if(!count || count > max_rows / block) {
+    QMessageBox::warning(this, tr("Parameter sweep"),
+      tr("The sweep table would have too many rows, reduce the samples."));
+    return;
+  }
+
+  std::vector< std::vector<double> > samples =
+    sampling_->currentIndex() == grid_sampling
+      ? sapecng::grid_samples(parameters)
+      : sapecng::latin_hypercube_samples(
+          parameters, samples_->value(), seed_->value());
+
+  QString fileName = QFileDialog::getSaveFileName(
+      this, tr("Save sweep table"), Settings().workspace(),
+      tr("%1;;%2")
+        .arg(tr("Sweep tables (*.tbl)"))
+        .arg(tr("All files (*)"))
+    );
+  if(fileName.isEmpty())
+    return;
+
+  QApplication::setOverrideCursor(Qt::WaitCursor);
+  try {
+    sapecng::sweep_table table =
+      analysis_->currentIndex() == frequency_analysis
+        ? frequencySweep(parameters, samples)
+        : transientSweep(parameters, samples);
+
+    std::ofstream out(
+      QFile::encodeName(fileName).constData(), std::ios::binary);
+    table.write(out);
+
+    QApplication::restoreOverrideCursor();
+    QLogger::info(tr("Parameter sweep of %1 samples written to %2.")
+      .arg(samples.size()).arg(fileName));
+  } catch(sapecng::sapecng_exception& e) {
+    QApplication::restoreOverrideCursor();
+    const std::string* info = boost::get_error_info<sapecng::what>(e);
+    QString message = info ? QString::fromStdString(*info) : QString();
+    QLogger::error(tr("Parameter sweep failed: ") + message);
+    QMessageBox::warning(this, tr("Parameter sweep"), message);
+  }
+}
+
+
+sapecng::sweep_table SweepDialog::frequencySweep(
+    const std::vector<sapecng::sweep_parameter>& parameters,
+    const std::vector< std::vector<double> >& samples
+  )
+{
+  if(!solved_) {
+    QLogger::info(tr("Solving..."));
+    sapecng::metacircuit meta;
+    meta(circuit_);
+    h_ = meta.raw();
+    solved_ = true;
+  }
+
+  // logarithmically spaced, as on a Bode plot
+  std::size_t points = points_->value();
+  double fmin = fmin_->value();
+  double fmax = fmax_->value();
+  std::vector<double> frequencies(points, fmin);
+  for(std::size_t i = 1; i < points; ++i)
+    frequencies[i] = fmin * std::pow(fmax / fmin, double(i) / (points - 1));
+
+  return sapecng::frequency_sweep(
+    h_, component_values(netlist_), parameters, samples, frequencies);
+}
+
+
+sapecng::sweep_table SweepDialog::transientSweep(
+    const std::vector<sapecng::sweep_parameter>& parameters,
+    const std::vector< std::vector<double> >& samples
+  ) const
+{
+  std::set<unsigned int> nodes;
+  const std::vector<sapecng::netlist::component>& comps =
+    netlist_.components();
+  for(std::vector<sapecng::netlist::component>::const_iterator it =
+        comps.begin(); it != comps.end(); ++it) {
+    nodes.insert(it->va);
+    nodes.insert(it->vb);
+  }
+  nodes.erase(sapecng::abstract_builder::GROUND);
+
+  double dt = dt_->value();
+  std::size_t steps = std::size_t(std::ceil(duration_->value() / dt));
+  double flow = flow_->value();
+
+  return sapecng::transient_sweep(
+    netlist_, parameters, samples, dt, steps, stride_->value(),
+    [flow](double) { return flow; },
+    std::function<double (std::size_t, double)>(),
+    std::vector<unsigned int>(nodes.begin(), nodes.end()));
+}
+
+
+}
@@ -0,0 +1,93 @@
+#ifndef SWEEPDIALOG_H
+#define SWEEPDIALOG_H
+
+
+#include "model/circuit.h"
+#include "model/metacircuit.h"
+#include "model/sweep.h"
+#include "model/transient.h"
+
+#include <QDialog>
+
+#include <utility>
+#include <vector>
+
+
+class QComboBox;
+class QDoubleSpinBox;
+class QSpinBox;
+class QStackedWidget;
+class QTableWidget;
+
+
+namespace qsapecng
+{
+
+
+/*
+ * Sweeps the values of some components of the netlist over a grid or a
+ * Latin hypercube and writes the results as a sweep table. The frequency
+ * sweep evaluates the transfer function of the circuit, solved the first
+ * time it is needed; the transient sweep holds the interface flow
+ * constant, flows of the prescribed flow components are zero.
+ */
+class SweepDialog: public QDialog
+{
+
+  Q_OBJECT
+
+public:
+  SweepDialog(
+      const sapecng::netlist& netlist,
+      sapecng::abstract_parser& parser,
+      QWidget* parent = 0
+    );
+
+private slots:
+  void addParameter();
+  void removeParameter();
+  void samplingChanged(int index);
+  void run();
+
+private:
+  std::vector<sapecng::sweep_parameter> parameters() const;
+  sapecng::sweep_table frequencySweep(
+      const std::vector<sapecng::sweep_parameter>& parameters,
+      const std::vector< std::vector<double> >& samples
+    );
+  sapecng::sweep_table transientSweep(
+      const std::vector<sapecng::sweep_parameter>& parameters,
+      const std::vector< std::vector<double> >& samples
+    ) const;
+
+private:
+  sapecng::netlist netlist_;
+  sapecng::circuit circuit_;
+  std::pair<
+      sapecng::metacircuit::expression,
+      sapecng::metacircuit::expression
+    > h_;
+  bool solved_;
+
+  QTableWidget* parameters_;
+  QComboBox* sampling_;
+  QSpinBox* samples_;
+  QSpinBox* seed_;
+
+  QComboBox* analysis_;
+  QStackedWidget* analysisPages_;
+  QDoubleSpinBox* fmin_;
+  QDoubleSpinBox* fmax_;
+  QSpinBox* points_;
+  QDoubleSpinBox* dt_;
+  QDoubleSpinBox* duration_;
+  QSpinBox* stride_;
+  QDoubleSpinBox* flow_;
+
+};
+
+
+}
+
+
+#endif // SWEEPDIALOG_H
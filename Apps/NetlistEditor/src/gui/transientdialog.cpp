@@ -0,0 +1,157 @@
+#include "gui/transientdialog.h"
+#include "gui/qlogger.h"
+
+#include <QDoubleSpinBox>
+#include <QPushButton>
+#include <QMessageBox>
+#include <QDialogButtonBox>
+#include <QGroupBox>
+#include <QPen>
+
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+
+#include <qwt_plot.h>
+#include <qwt_plot_curve.h>
+#include <qwt_plot_grid.h>
+#include <qwt_legend.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <set>
+
+
+namespace qsapecng
+{
+
+
+namespace
+{
+
+const std::size_t max_steps = 10000000;
+const std::size_t max_plot_points = 2000;
+
+}
+
+
+
+TransientDialog::TransientDialog(
+    const sapecng::netlist& netlist,
+    QWidget* parent
+  ): QDialog(parent), netlist_(netlist)
+{
+  dt_ = new QDoubleSpinBox;
+  dt_->setDecimals(6);
+  dt_->setRange(1e-6, 1.);
+  dt_->setValue(1e-3);
+  duration_ = new QDoubleSpinBox;
+  duration_->setDecimals(3);
+  duration_->setRange(1e-3, 1e4);
+  duration_->setValue(1.);
+  flow_ = new QDoubleSpinBox;
+  flow_->setDecimals(5);
+  flow_->setRange(
+    -std::numeric_limits<double>::max(), std::numeric_limits<double>::max());
+  flow_->setValue(0.);
+
+  QFormLayout* paramLayout = new QFormLayout;
+  paramLayout->addRow(tr("Time step (s):"), dt_);
+  paramLayout->addRow(tr("Duration (s):"), duration_);
+  paramLayout->addRow(tr("Interface flow:"), flow_);
+  paramLayout->setFieldGrowthPolicy(QFormLayout::FieldsStayAtSizeHint);
+  QGroupBox* paramBox = new QGroupBox(tr("Simulation"));
+  paramBox->setLayout(paramLayout);
+
+  QDialogButtonBox* buttonBox = new QDialogButtonBox;
+  QPushButton* runButton =
+    buttonBox->addButton(tr("&Run"), QDialogButtonBox::ApplyRole);
+  QPushButton* closeButton = buttonBox->addButton(QDialogButtonBox::Close);
+  connect(runButton, SIGNAL(clicked(bool)), this, SLOT(simulate()));
+  connect(closeButton, SIGNAL(clicked(bool)), this, SLOT(close()));
+
+  plot_ = new QwtPlot;
+  plot_->setAxisTitle(QwtPlot::xBottom, tr("Time (s)"));
+  plot_->setAxisTitle(QwtPlot::yLeft, tr("Pressure"));
+  plot_->insertLegend(new QwtLegend, QwtPlot::RightLegend);
+
+  QwtPlotGrid* grid = new QwtPlotGrid;
+  grid->setPen(QPen(Qt::gray, 0., Qt::DotLine));
+  grid->attach(plot_);
+
+  QVBoxLayout* sideLayout = new QVBoxLayout;
+  sideLayout->addWidget(paramBox);
+  sideLayout->addStretch();
+  sideLayout->addWidget(buttonBox);
+
+  QHBoxLayout* mainLayout = new QHBoxLayout;
+  mainLayout->addLayout(sideLayout);
+  mainLayout->addWidget(plot_, 1);
+  setLayout(mainLayout);
+
+  setWindowTitle(tr("Transient simulation"));
+  resize(900, 500);
+}
+
+
+void TransientDialog::simulate()
+{
+  std::set<unsigned int> nodes;
+  const std::vector<sapecng::netlist::component>& comps =
+    netlist_.components();
+  for(std::vector<sapecng::netlist::component>::const_iterator it =
+        comps.begin(); it != comps.end(); ++it) {
+    nodes.insert(it->va);
+    nodes.insert(it->vb);
+  }
+  nodes.erase(sapecng::abstract_builder::GROUND);
+
+  double dt = dt_->value();
+  std::size_t steps = std::size_t(std::ceil(duration_->value() / dt));
+  if(steps > max_steps) {
+    QMessageBox::warning(this, tr("Transient simulation"),
+      tr("Too many time steps, increase the time step or reduce the duration."));
+    return;
+  }
+  std::size_t stride = std::max<std::size_t>(steps / max_plot_points, 1);
+
+  std::vector< QVector<QPointF> > series(nodes.size());
+  try {
+    sapecng::transient sim(netlist_, dt);
+    sim.set_interface_flow(flow_->value());
+
+    for(std::size_t i = 1; i <= steps; ++i) {
+      sim.step();
+      if(i % stride == 0 || i == steps) {
+        std::size_t n = 0;
+        for(std::set<unsigned int>::const_iterator it = nodes.begin();
+            it != nodes.end(); ++it, ++n)
+          series[n].push_back(QPointF(sim.time(), sim.pressure(*it)));
+      }
+    }
+  } catch(sapecng::simulation_error& e) {
+    const std::string* info = boost::get_error_info<sapecng::what>(e);
+    QString message = info ? QString::fromStdString(*info) : QString();
+    QLogger::error(tr("Transient simulation failed: ") + message);
+    QMessageBox::warning(this, tr("Transient simulation"), message);
+    return;
+  }
+
+  plot_->detachItems(QwtPlotItem::Rtti_PlotCurve);
+
+  std::size_t n = 0;
+  for(std::set<unsigned int>::const_iterator it = nodes.begin();
+      it != nodes.end(); ++it, ++n) {
+    QwtPlotCurve* curve = new QwtPlotCurve(tr("P%1").arg(*it));
+    curve->setPen(QPen(QColor::fromHsv(int(360 * n / nodes.size()), 255, 200)));
+    curve->setData(new QwtPointSeriesData(series[n]));
+    curve->attach(plot_);
+  }
+
+  plot_->replot();
+  QLogger::info(tr("Transient simulation of %1 steps done.").arg(steps));
+}
+
+
+}
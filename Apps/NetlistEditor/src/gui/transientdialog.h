@@ -0,0 +1,48 @@
+#ifndef TRANSIENTDIALOG_H
+#define TRANSIENTDIALOG_H
+
+
+#include "model/transient.h"
+
+#include <QDialog>
+
+
+class QDoubleSpinBox;
+class QwtPlot;
+
+
+namespace qsapecng
+{
+
+
+/*
+ * Runs a numeric transient simulation of the netlist and plots the
+ * pressure of every node over time. The interface flow is held constant,
+ * flows of the prescribed flow components are zero.
+ */
+class TransientDialog: public QDialog
+{
+
+  Q_OBJECT
+
+public:
+  TransientDialog(const sapecng::netlist& netlist, QWidget* parent = 0);
+
+private slots:
+  void simulate();
+
+private:
+  sapecng::netlist netlist_;
+
+  QDoubleSpinBox* dt_;
+  QDoubleSpinBox* duration_;
+  QDoubleSpinBox* flow_;
+  QwtPlot* plot_;
+
+};
+
+
+}
+
+
+#endif // TRANSIENTDIALOG_H
@@ -182,6 +182,7 @@ void MarkedCurve::resetMarker()
 
 WorkPlane::WorkPlane(QWidget* parent)
   : QWidget(parent),
+    responseStep_(0), responseValid_(false),
     startFreq_(0), endFreq_(0), stepFreq_(0),
     oldStartFreq_(0), oldEndFreq_(0), oldStepFreq_(0)
 {
@@ -266,6 +267,7 @@ void WorkPlane::setData(
 
 void WorkPlane::setDirty()
 {
+  responseValid_ = false;
   attached_.clear();
   for(int i = 0; i < curves_.size(); ++i) {
     curves_[i].first->setVisible(false);
@@ -330,11 +332,10 @@ void WorkPlane::plot(WorkPlane::F f)
       std::pair< std::vector<double>, std::vector<double> > res;
       if(!curves_[f].second) {
         QLogger::info(QObject::tr("Calculate magnitude."));
-        std::map<std::string, double> values = actValues();
         res = sapecng::magnitude(
             std::make_pair(startFreq_->value(), endFreq_->value()),
             stepFreq_->value()
-          )(num_, den_, values);
+          )(response());
       }
 
       plot_->setTitle(functor_traits<sapecng::magnitude>::title);
@@ -367,11 +368,10 @@ void WorkPlane::plot(WorkPlane::F f)
       std::pair< std::vector<double>, std::vector<double> > res;
       if(!curves_[f].second) {
         QLogger::info(QObject::tr("Calculate phase."));
-        std::map<std::string, double> values = actValues();
         res = sapecng::phase(
             std::make_pair(startFreq_->value(), endFreq_->value()),
             stepFreq_->value()
-          )(num_, den_, values);
+          )(response());
       }
 
       plot_->setTitle(functor_traits<sapecng::phase>::title);
@@ -404,11 +404,10 @@ void WorkPlane::plot(WorkPlane::F f)
       std::pair< std::vector<double>, std::vector<double> > res;
       if(!curves_[f].second) {
         QLogger::info(QObject::tr("Calculate gain."));
-        std::map<std::string, double> values = actValues();
         res = sapecng::gain(
             std::make_pair(startFreq_->value(), endFreq_->value()),
             stepFreq_->value()
-          )(num_, den_, values);
+          )(response());
       }
 
       plot_->setTitle(functor_traits<sapecng::gain>::title);
@@ -441,11 +440,10 @@ void WorkPlane::plot(WorkPlane::F f)
       std::pair< std::vector<double>, std::vector<double> > res;
       if(!curves_[f].second) {
         QLogger::info(QObject::tr("Calculate loss."));
-        std::map<std::string, double> values = actValues();
         res = sapecng::loss(
             std::make_pair(startFreq_->value(), endFreq_->value()),
             stepFreq_->value()
-          )(num_, den_, values);
+          )(response());
       }
 
       plot_->setTitle(functor_traits<sapecng::loss>::title);
@@ -553,6 +551,28 @@ void WorkPlane::redraw()
 }
 
 
+const sapecng::frequency_response& WorkPlane::response()
+{
+  std::map<std::string, double> values = actValues();
+  std::pair<double, double> range =
+    std::make_pair(startFreq_->value(), endFreq_->value());
+  double step = stepFreq_->value();
+
+  if(!responseValid_ || values != responseValues_
+      || range != responseRange_ || step != responseStep_)
+  {
+    response_ = sapecng::frequency_response(
+        sapecng::rational_function(num_, den_, values), range, step);
+    responseValues_ = values;
+    responseRange_ = range;
+    responseStep_ = step;
+    responseValid_ = true;
+  }
+
+  return response_;
+}
+
+
 std::map<std::string, double> WorkPlane::actValues() const
 {
   std::map<std::string, double> values;
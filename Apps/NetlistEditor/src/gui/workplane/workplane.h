@@ -22,6 +22,7 @@
 
 
 #include "model/metacircuit.h"
+#include "functor/functor.hpp"
 
 #include <QWidget>
 #include <QMenu>
@@ -174,6 +175,7 @@ public slots:
 
 private:
   std::map<std::string, double> actValues() const;
+  const sapecng::frequency_response& response();
   void createMainLayout();
   void setupCurves();
   void setupCurve(
@@ -185,6 +187,13 @@ private:
   sapecng::metacircuit::expression num_;
   sapecng::metacircuit::expression den_;
 
+  // sweep shared by the frequency range curves
+  sapecng::frequency_response response_;
+  std::map<std::string, double> responseValues_;
+  std::pair<double, double> responseRange_;
+  double responseStep_;
+  bool responseValid_;
+
   QwtPlotGrid* grid_;
   QwtPlot_ContextMenu* plot_;
   QVector< QwtPlotCurve* > attached_;
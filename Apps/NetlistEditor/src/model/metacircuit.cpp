@@ -20,6 +20,9 @@
 #include "model/metacircuit.h"
 #include "boost-sapecng/mrt.hpp"
 
+#include <algorithm>
+#include <iterator>
+
 
 namespace sapecng
 {
@@ -128,6 +131,7 @@ void metacircuit::operator()(const circuit& circuit)
   digit_.second.clear();
   mixed_.first.clear();
   mixed_.second.clear();
+  symbols_.clear();
 
   // use circuit
   if(num_edges(circuit.vGraph()) == num_edges(circuit.iGraph())
@@ -138,202 +142,239 @@ void metacircuit::operator()(const circuit& circuit)
     const Graph& refG = circuit.iGraph();
     const std::vector<circuit::edge_descriptor>& refO = circuit.iGraph_order();
 
+    // intern symbols, ids follow the lexicographic order of the names
+    for(std::vector<circuit::edge_descriptor>::size_type i = 0;
+        i < refO.size(); ++i)
+    {
+      const std::string& name = get(boost::edge_name, refG)[ refO[i] ];
+      if(name.size())
+        symbols_.push_back(name);
+    }
+    std::sort(symbols_.begin(), symbols_.end());
+    symbols_.erase(
+        std::unique(symbols_.begin(), symbols_.end()), symbols_.end());
+
+    std::vector<edge_info> edges(refO.size());
+    for(std::vector<edge_info>::size_type i = 0; i < edges.size(); ++i) {
+      const std::string& name = get(boost::edge_name, refG)[ refO[i] ];
+      edges[i].type = get(boost::edge_type, refG)[ refO[i] ];
+      edges[i].weight = get(boost::edge_weight, refG)[ refO[i] ];
+      edges[i].degree = get(boost::edge_degree, refG)[ refO[i] ];
+      edges[i].symbol = -1;
+      if(name.size())
+        edges[i].symbol = std::lower_bound(
+            symbols_.begin(), symbols_.end(), name) - symbols_.begin();
+    }
+
     std::vector< bool > forcedIn(num_edges(refG), false);
     // put in forced edges
-    typedef
-    boost::property_map<sapecng::Graph, boost::edge_type_t>::const_type
-    FM_type;
-
-    FM_type FM = get(boost::edge_type, refG);
-
     for(std::vector<bool>::size_type i = 0; i < forcedIn.size(); ++i) {
-      if(FM[ refO[i] ] == sapecng::F)
+      if(edges[i].type == sapecng::F)
         forcedIn[i] = true;
     }
     //
     typedef std::vector<bool> Seq;
-    typedef std::vector< std::vector<bool> > Coll;
-
-    Coll coll;
-    boost::mrt_two_graphs_common_spanning_trees
-        <
-          sapecng::Graph,
-          std::vector< sapecng::circuit::edge_descriptor >,
-          boost::tree_collector< Coll, Seq >,
-          std::vector< bool >
-        >
+
+    // fold every tree into the expressions as soon as it is enumerated,
+    // the number of trees is exponential in the size of the circuit. The
+    // partial sums of the subproblems are merged in a fixed order, so the
+    // coefficients do not depend on the scheduling of the threads
+    tree_folder folder(*this, circuit, edges);
+    boost::parallel_mrt_two_graphs_common_spanning_trees
       (
         circuit.iGraph(),
         circuit.iGraph_order(),
         circuit.vGraph(),
         circuit.vGraph_order(),
-        boost::tree_collector< Coll, Seq >(coll),
+        folder,
+        [this](tree_folder& total, const tree_folder& part) {
+          merge(total.raw_.first, part.raw_.first);
+          merge(total.raw_.second, part.raw_.second);
+          merge(total.digit_.first, part.digit_.first);
+          merge(total.digit_.second, part.digit_.second);
+          merge(total.mixed_.first, part.mixed_.first);
+          merge(total.mixed_.second, part.mixed_.second);
+        },
         forcedIn
       );
 
-    for(Coll::size_type i = 0; i < coll.size(); ++i) {
-
-      int degree = 0;
-      basic_expression raw_rep =
-        std::make_pair< double, std::list<std::string> >
-          (1., std::list<std::string>());
-      basic_expression digit_rep =
-        std::make_pair< double, std::list<std::string> >
-          (1., std::list<std::string>());
-      basic_expression mixed_rep =
-        std::make_pair< double, std::list<std::string> >
-          (1., std::list<std::string>());
-
-      Seq inL = coll[i];
-
-      int sign = 1;
-      sign *= get_sign(
-          num_vertices(circuit.iGraph()),
-          circuit.iGraph(),
-          circuit.iGraph_order(),
-          inL
-        );
-      sign *= get_sign(
-          num_vertices(circuit.vGraph()),
-          circuit.vGraph(),
-          circuit.vGraph_order(),
-          inL
-        );
+    std::pair<terms, terms>& raw = folder.raw_;
+    std::pair<terms, terms>& digit = folder.digit_;
+    std::pair<terms, terms>& mixed = folder.mixed_;
 
-      raw_rep.first *= sign;
-      digit_rep.first *= sign;
-      mixed_rep.first *= sign;
-
-      bool numerator_part = false;
-      bool denominator_part = false;
-      for(Seq::size_type j = 0; j < inL.size(); ++j) {
-        if(inL[j] && (FM[ refO[j] ] == sapecng::GREF))
-          numerator_part = true;
-
-        if(inL[j] && (FM[ refO[j] ] == sapecng::YREF))
-          denominator_part = true;
-
-        if((inL[j] && FM[ refO[j] ] == sapecng::Y)
-            || (!inL[j] && FM[ refO[j] ] == sapecng::Z)
-          )
-        {
-          // read all data, creating complex expressions
-        /*  if(get(boost::edge_symbolic, refG)[ refO[j] ]) {
-            if(get(boost::edge_name, refG)[ refO[j] ].size())
-              mixed_rep.second.push_back(get(boost::edge_name, refG)[ refO[j] ]);
-          } else {
-            mixed_rep.first *= get(boost::edge_weight, refG)[ refO[j] ];
-          }*/
-
-          digit_rep.first *= get(boost::edge_weight, refG)[ refO[j] ];
-          if(get(boost::edge_name, refG)[ refO[j] ].size())
-            raw_rep.second.push_back(get(boost::edge_name, refG)[ refO[j] ]);
-          else
-            raw_rep.first *= get(boost::edge_weight, refG)[ refO[j] ];
-
-          degree += get(boost::edge_degree, refG)[ refO[j] ];
-        }
+    simplify(raw);
+    simplify(digit);
+    simplify(mixed);
 
-      }
+    raw_ = std::make_pair(as_expression(raw.first), as_expression(raw.second));
+    digit_ = std::make_pair(
+        as_expression(digit.first), as_expression(digit.second));
+    mixed_ = std::make_pair(
+        as_expression(mixed.first), as_expression(mixed.second));
+  }
 
-      raw_rep.second.sort();
-      digit_rep.second.sort();
-      mixed_rep.second.sort();
-
-      if(numerator_part) {
-        append(degree, raw_.first, raw_rep);
-        append(degree, digit_.first, digit_rep);
-        append(degree, mixed_.first, mixed_rep);
-      } else if(denominator_part) {
-        append(degree, raw_.second, raw_rep);
-        append(degree, digit_.second, digit_rep);
-        append(degree, mixed_.second, mixed_rep);
-      }
+}
 
+
+metacircuit::tree_folder::tree_folder(
+    metacircuit& mc,
+    const circuit& circ,
+    const std::vector<edge_info>& edges
+  ): mc_(mc), circ_(circ), edges_(edges)
+{ }
+
+
+void metacircuit::tree_folder::operator()(const std::vector<bool>& inL)
+{
+  typedef std::vector<bool> Seq;
+
+  int degree = 0;
+  double raw_coeff = 1.;
+  double digit_coeff = 1.;
+  double mixed_coeff = 1.;
+  monomial raw_rep;
+
+  int sign = 1;
+  sign *= mc_.get_sign(
+      num_vertices(circ_.iGraph()),
+      circ_.iGraph(),
+      circ_.iGraph_order(),
+      inL
+    );
+  sign *= mc_.get_sign(
+      num_vertices(circ_.vGraph()),
+      circ_.vGraph(),
+      circ_.vGraph_order(),
+      inL
+    );
+
+  raw_coeff *= sign;
+  digit_coeff *= sign;
+  mixed_coeff *= sign;
+
+  bool numerator_part = false;
+  bool denominator_part = false;
+  for(Seq::size_type j = 0; j < inL.size(); ++j) {
+    const edge_info& edge = edges_[j];
+
+    if(inL[j] && (edge.type == sapecng::GREF))
+      numerator_part = true;
+
+    if(inL[j] && (edge.type == sapecng::YREF))
+      denominator_part = true;
+
+    if((inL[j] && edge.type == sapecng::Y)
+        || (!inL[j] && edge.type == sapecng::Z)
+      )
+    {
+      digit_coeff *= edge.weight;
+      if(edge.symbol != -1)
+        raw_rep.push_back(edge.symbol);
+      else
+        raw_coeff *= edge.weight;
+
+      degree += edge.degree;
     }
 
-    simplify(raw_);
-    simplify(digit_);
-    simplify(mixed_);
   }
 
+  std::sort(raw_rep.begin(), raw_rep.end());
+
+  if(numerator_part) {
+    raw_.first[degree][raw_rep] += raw_coeff;
+    digit_.first[degree][monomial()] += digit_coeff;
+    mixed_.first[degree][monomial()] += mixed_coeff;
+  } else if(denominator_part) {
+    raw_.second[degree][raw_rep] += raw_coeff;
+    digit_.second[degree][monomial()] += digit_coeff;
+    mixed_.second[degree][monomial()] += mixed_coeff;
+  }
 }
 
 
-void metacircuit::append(int deg, expression& e, const basic_expression& be)
+void metacircuit::merge(terms& t, const terms& part)
 {
-  if(e.find(deg) == e.end()) {
-    e[deg].push_back(be);
-  } else {
-    degree_expression::iterator it;
-    for(it = e[deg].begin(); it != e[deg].end(); ++it) {
-      if(it->second == be.second) {
-        it->first += be.first;
-        break;
-      }
+  for(terms::const_iterator it = part.begin(); it != part.end(); ++it)
+  {
+    degree_terms& dt = t[it->first];
+    for(degree_terms::const_iterator
+        dit = it->second.begin(); dit != it->second.end(); ++dit)
+      dt[dit->first] += dit->second;
+  }
+}
+
+
+metacircuit::expression metacircuit::as_expression(const terms& t) const
+{
+  expression e;
+  for(terms::const_iterator it = t.begin(); it != t.end(); ++it)
+  {
+    // sorted by symbols, hashing gives no meaningful order
+    std::vector< std::pair<monomial, double> >
+      sorted(it->second.begin(), it->second.end());
+    std::sort(sorted.begin(), sorted.end());
+
+    degree_expression& de = e[it->first];
+    for(std::vector< std::pair<monomial, double> >::const_iterator
+        sit = sorted.begin(); sit != sorted.end(); ++sit)
+    {
+      std::list<std::string> symbols;
+      for(monomial::const_iterator
+          mit = sit->first.begin(); mit != sit->first.end(); ++mit)
+        symbols.push_back(symbols_[*mit]);
+      de.push_back(std::make_pair(sit->second, symbols));
     }
-    if(it == e[deg].end())
-      e[deg].push_back(be);
   }
+
+  return e;
 }
 
 
-void metacircuit::simplify(std::pair<expression, expression>& p)
+void metacircuit::simplify(std::pair<terms, terms>& p)
 {
   compress(p.first);
   compress(p.second);
 
   if(p.first.size() == 0) {
 
-    expression en;
-    degree_expression den;
-    basic_expression ben = std::make_pair(0., std::list<std::string>());
-    den.push_back(ben);
-    en[0] = den;
+    terms en;
+    en[0][monomial()] = 0.;
 
-    expression ed;
-    degree_expression ded;
-    basic_expression bed = std::make_pair(1., std::list<std::string>());
-    ded.push_back(bed);
-    ed[0] = ded;
+    terms ed;
+    ed[0][monomial()] = 1.;
 
     p.first = en;
     p.second = ed;
 
   } else if(p.second.size() == 0) {
 
-    expression en;
-    degree_expression den;
-    basic_expression ben = std::make_pair(1., std::list<std::string>());
-    den.push_back(ben);
-    en[0] = den;
+    terms en;
+    en[0][monomial()] = 1.;
 
-    expression ed;
-    degree_expression ded;
-    basic_expression bed = std::make_pair(0., std::list<std::string>());
-    ded.push_back(bed);
-    ed[0] = ded;
+    terms ed;
+    ed[0][monomial()] = 0.;
 
     p.first = en;
     p.second = ed;
 
   } else {
 
-    while(p.first.find(0) == p.first.end()
-        && p.second.find(0) == p.second.end())
+    // degrees are never negative, drop the common power of s
+    int shift = std::min(p.first.begin()->first, p.second.begin()->first);
+    if(shift > 0)
     {
-      expression en;
-      for(expression::iterator
+      terms en;
+      for(terms::iterator
           it = p.first.begin(); it != p.first.end(); ++it)
-        en[it->first - 1] = it->second;
+        en[it->first - shift].swap(it->second);
 
-      expression ed;
-      for(expression::iterator
+      terms ed;
+      for(terms::iterator
           it = p.second.begin(); it != p.second.end(); ++it)
-        ed[it->first - 1] = it->second;
+        ed[it->first - shift].swap(it->second);
 
-      p.first = en;
-      p.second = ed;
+      p.first.swap(en);
+      p.second.swap(ed);
     }
 
     if(group_minus(p.first) && group_minus(p.second)) {
@@ -347,31 +388,21 @@ void metacircuit::simplify(std::pair<expression, expression>& p)
       normalize(p.second, div);
     }
 
-    std::list<std::string> candidates = p.first.begin()->second.front().second;
-    for(std::list<std::string>::const_iterator
-        it = candidates.begin(); it != candidates.end(); ++it)
-    {
-      if(has_candidate(p.first, *it)
-          && has_candidate(p.second, *it))
-      {
-        remove_candidate(p.first, *it);
-        remove_candidate(p.second, *it);
-      }
+    monomial factor = p.first.begin()->second.begin()->first;
+    factor = common_factor(p.first, factor);
+    factor = common_factor(p.second, factor);
+    if(factor.size()) {
+      remove_factor(p.first, factor);
+      remove_factor(p.second, factor);
     }
 
     if(p.first == p.second) {
 
-      expression en;
-      degree_expression den;
-      basic_expression ben = std::make_pair(1., std::list<std::string>());
-      den.push_back(ben);
-      en[0] = den;
+      terms en;
+      en[0][monomial()] = 1.;
 
-      expression ed;
-      degree_expression ded;
-      basic_expression bed = std::make_pair(1., std::list<std::string>());
-      ded.push_back(bed);
-      ed[0] = ded;
+      terms ed;
+      ed[0][monomial()] = 1.;
 
       p.first = en;
       p.second = ed;
@@ -382,155 +413,221 @@ void metacircuit::simplify(std::pair<expression, expression>& p)
 }
 
 
-void metacircuit::compress(expression& e)
+void metacircuit::compress(terms& t)
 {
-  for(expression::iterator it = e.begin(); it != e.end(); ++it) {
-    it->second.remove_if(detail::basic_checker());
-    if(detail::degree_checker()(*it))
-      e.erase(it);
+  for(terms::iterator it = t.begin(); it != t.end(); ) {
+    for(degree_terms::iterator dit = it->second.begin();
+        dit != it->second.end(); )
+    {
+      if(dit->second == 0)
+        dit = it->second.erase(dit);
+      else
+        ++dit;
+    }
+
+    if(it->second.size() == 0)
+      t.erase(it++);
+    else
+      ++it;
   }
 }
 
 
-bool metacircuit::group_minus(const expression& e)
+bool metacircuit::group_minus(const terms& t)
 {
-  bool has_positive = false;;
-  for(expression::const_iterator
-      it = e.begin(); it != e.end() && !has_positive; ++it)
+  for(terms::const_iterator it = t.begin(); it != t.end(); ++it)
   {
-    for(degree_expression::const_iterator
+    for(degree_terms::const_iterator
         dit = it->second.begin(); dit != it->second.end(); ++dit)
     {
-      if(dit->first > 0)
-        has_positive = true;
+      if(dit->second > 0)
+        return false;
     }
   }
 
-  return !has_positive;
+  return true;
 }
 
 
-void metacircuit::toggle_minus(expression& e)
+void metacircuit::toggle_minus(terms& t)
 {
-  for(expression::iterator it = e.begin(); it != e.end(); ++it)
+  for(terms::iterator it = t.begin(); it != t.end(); ++it)
   {
-    for(degree_expression::iterator
+    for(degree_terms::iterator
         dit = it->second.begin(); dit != it->second.end(); ++dit)
-      dit->first *= -1;
+      dit->second *= -1;
   }
 }
 
 
-bool metacircuit::has_candidate(const expression& e, const std::string& c)
+metacircuit::monomial metacircuit::common_factor(
+    const terms& t,
+    const monomial& candidate
+  )
 {
-  bool miss = false;
-  for(expression::const_iterator
-      it = e.begin(); it != e.end() && !miss; ++it)
+  // multiset intersection of the sorted symbol ids of all the terms
+  monomial factor = candidate;
+  for(terms::const_iterator
+      it = t.begin(); it != t.end() && factor.size(); ++it)
   {
-    for(degree_expression::const_iterator
-        dit = it->second.begin(); dit != it->second.end() && !miss; ++dit)
+    for(degree_terms::const_iterator
+        dit = it->second.begin(); dit != it->second.end() && factor.size();
+        ++dit)
     {
-      if(std::find(dit->second.begin(), dit->second.end(), c)
-          == dit->second.end())
-        miss = true;
+      monomial common;
+      std::set_intersection(
+          factor.begin(), factor.end(),
+          dit->first.begin(), dit->first.end(),
+          std::back_inserter(common)
+        );
+      factor.swap(common);
     }
   }
 
-  return !miss;
+  return factor;
 }
 
 
-void metacircuit::remove_candidate(expression& e, const std::string& c)
+void metacircuit::remove_factor(terms& t, const monomial& factor)
 {
-  for(expression::iterator it = e.begin(); it != e.end(); ++it)
+  for(terms::iterator it = t.begin(); it != t.end(); ++it)
   {
-    for(degree_expression::iterator
+    degree_terms dt;
+    for(degree_terms::const_iterator
         dit = it->second.begin(); dit != it->second.end(); ++dit)
-      dit->second.erase(std::find(dit->second.begin(), dit->second.end(), c));
+    {
+      monomial reduced;
+      std::set_difference(
+          dit->first.begin(), dit->first.end(),
+          factor.begin(), factor.end(),
+          std::back_inserter(reduced)
+        );
+      dt[reduced] = dit->second;
+    }
+    it->second.swap(dt);
   }
 }
 
 
-double metacircuit::find_div(const expression& e)
+double metacircuit::find_div(const terms& t)
 {
-  degree_expression top_expr = e.rbegin()->second;
-  degree_expression::iterator dit = top_expr.begin();
+  const degree_terms& top_terms = t.rbegin()->second;
+  degree_terms::const_iterator dit = top_terms.begin();
 
-  bool miss = false;
-  double base = std::abs(dit->first);
-  for(++dit; dit != top_expr.end() && !miss; ++dit)
-    if(std::abs(dit->first) != base)
-      miss = true;
+  double base = std::abs(dit->second);
+  for(++dit; dit != top_terms.end(); ++dit)
+    if(std::abs(dit->second) != base)
+      return 1.;
 
-  if(!miss)
-    return base;
-
-  return 1.;
+  return base;
 }
 
 
-void metacircuit::normalize(expression& e, double div)
+void metacircuit::normalize(terms& t, double div)
 {
-  for(expression::iterator it = e.begin(); it != e.end(); ++it)
+  for(terms::iterator it = t.begin(); it != t.end(); ++it)
   {
-    for(degree_expression::iterator
+    for(degree_terms::iterator
         dit = it->second.begin(); dit != it->second.end(); ++dit)
-      dit->first /= div;
+      dit->second /= div;
   }
 }
 
 
+//
+// Determinant of the reduced incidence matrix of the tree (rows: every
+// vertex but the last one, columns: tree edges in order). Rooting the tree
+// at the removed vertex and pairing each vertex with the edge to its parent
+// makes the matrix triangular up to a permutation, so the determinant is
+// the parity of that permutation times the orientation of the parent edges.
+//
 int metacircuit::get_sign(
     size_t vertices,
     const Graph& graph,
-    std::vector< circuit::edge_descriptor > order,
-    std::vector<bool> inL
+    const std::vector< circuit::edge_descriptor >& order,
+    const std::vector<bool>& inL
   )
 {
-  size_t row = vertices;
-  size_t col = vertices - 1;
-
-  int* matrix = new int[row * col];
-  for(size_t i = 0; i < row; ++i)
-    for(size_t j = 0; j < col; ++j)
-      matrix[col * i + j] = 0;
-
-  for(std::vector<bool>::size_type i = 0, j = 0; i < inL.size(); ++i) {
+  if(vertices < 2)
+    return 1;
+
+  size_t root = vertices - 1;
+
+  // tree adjacency as linked lists of edge ends
+  std::vector<int> head(vertices, -1);
+  std::vector<int> next;
+  std::vector<size_t> other;
+  std::vector<size_t> column;
+  std::vector<int> orientation;
+  next.reserve(2 * root);
+  other.reserve(2 * root);
+  column.reserve(2 * root);
+  orientation.reserve(2 * root);
+
+  size_t col = 0;
+  for(std::vector<bool>::size_type i = 0; i < inL.size(); ++i) {
     if(inL[i]) {
-      matrix[col * source(order[i], graph) + j] = -1;
-      matrix[col * target(order[i], graph) + j] = +1;
-      ++j;
+      size_t s = source(order[i], graph);
+      size_t t = target(order[i], graph);
+
+      next.push_back(head[s]);
+      other.push_back(t);
+      column.push_back(col);
+      orientation.push_back(+1);
+      head[s] = next.size() - 1;
+
+      next.push_back(head[t]);
+      other.push_back(s);
+      column.push_back(col);
+      orientation.push_back(-1);
+      head[t] = next.size() - 1;
+
+      ++col;
     }
   }
 
+  if(col != root)
+    return 0;
+
+  // parent edge column of every vertex, sign from the edge orientation
+  const size_t none = vertices;
+  std::vector<size_t> parent_col(vertices, none);
+  std::vector<size_t> stack(1, root);
+  parent_col[root] = root;
+
   int det = 1;
-  for(size_t ofs = 0; ofs < col; ++ofs) {
-    for(size_t iter = ofs; iter < row; ++iter) {
-      if(matrix[iter * col + ofs] != 0) {
-        if(iter != ofs) {
-          for(size_t cnt = ofs; cnt < col; ++cnt) {
-            int swap = matrix[iter * col + cnt];
-            matrix[iter * col + cnt] = matrix[ofs * col + cnt];
-            matrix[ofs * col + cnt] = swap;
-          }
-          det *= -1;
-        }
-        for(iter = ofs + 1; iter < row; ++iter) {
-          if(matrix[iter * col + ofs] != 0) {
-            int weight = -1 * matrix[ofs * col + ofs] / matrix[iter * col + ofs];
-            for(size_t cnt = ofs; cnt < col; ++cnt)
-              matrix[iter * col + cnt] += matrix[ofs * col + cnt] * weight;
-          }
-        }
-        iter = row;
+  size_t reached = 1;
+  while(!stack.empty()) {
+    size_t u = stack.back();
+    stack.pop_back();
+    for(int k = head[u]; k != -1; k = next[k]) {
+      size_t v = other[k];
+      if(parent_col[v] == none) {
+        parent_col[v] = column[k];
+        // diagonal entry: +1 if v is the target of its parent edge
+        det *= orientation[k];
+        stack.push_back(v);
+        ++reached;
       }
     }
   }
 
-  for(size_t iter = 0; iter < col; ++iter)
-    det *= matrix[iter * col + iter];
-
-  delete matrix;
+  if(reached != vertices)
+    return 0;
+
+  // parity of the permutation vertex -> parent edge column
+  std::vector<bool> visited(root, false);
+  for(size_t v = 0; v < root; ++v) {
+    if(!visited[v]) {
+      size_t length = 0;
+      for(size_t w = v; !visited[w]; w = parent_col[w]) {
+        visited[w] = true;
+        ++length;
+      }
+      if(length % 2 == 0)
+        det *= -1;
+    }
+  }
 
   return det;
 }
@@ -22,6 +22,8 @@
 
 
 #include "model/circuit.h"
+#include <boost/unordered_map.hpp>
+#include <vector>
 #include <list>
 #include <map>
 
@@ -31,33 +33,6 @@ namespace sapecng
 
 
 
-namespace detail
-{
-
-
-struct basic_checker
-{
-
-bool operator()(const std::pair< double, std::list<std::string> >& e) const
-  { return (e.first == 0); }
-
-};
-
-
-struct degree_checker
-{
-
-bool operator()(const std::pair< int, std::list<
-    std::pair< double, std::list<std::string> > > >& e) const
-  { return (e.second.size() == 0); }
-
-};
-
-
-}
-
-
-
 class metacircuit
 {
 
@@ -85,16 +60,51 @@ public:
     mixed() const { return mixed_; }
 
 private:
-  void append(int deg, expression& e, const basic_expression& be);
-  void simplify(std::pair<expression, expression>& p);
-
-  void compress(expression& e);
-  bool group_minus(const expression& e);
-  void toggle_minus(expression& e);
-  bool has_candidate(const expression& e, const std::string& c);
-  void remove_candidate(expression& e, const std::string& c);
-  double find_div(const expression& e);
-  void normalize(expression& e, double div);
+  // Working representation. Symbols are interned in lexicographic order,
+  // so sorted sequences of ids compare like the symbol lists they stand for.
+  typedef std::vector<int> monomial;
+  typedef boost::unordered_map< monomial, double > degree_terms;
+  typedef std::map< int, degree_terms > terms;
+
+  struct edge_info
+  {
+    EdgeType type;
+    double weight;
+    int symbol;
+    int degree;
+  };
+
+  // common spanning tree visitor, folds each tree into its own partial
+  // expressions (one visitor per enumeration subproblem)
+  struct tree_folder
+  {
+    tree_folder(
+        metacircuit& mc,
+        const circuit& circ,
+        const std::vector<edge_info>& edges
+      );
+    void operator()(const std::vector<bool>& inL);
+
+    metacircuit& mc_;
+    const circuit& circ_;
+    const std::vector<edge_info>& edges_;
+    std::pair<terms, terms> raw_;
+    std::pair<terms, terms> digit_;
+    std::pair<terms, terms> mixed_;
+  };
+  friend struct tree_folder;
+
+  void merge(terms& t, const terms& part);
+  void simplify(std::pair<terms, terms>& p);
+  expression as_expression(const terms& t) const;
+
+  void compress(terms& t);
+  bool group_minus(const terms& t);
+  void toggle_minus(terms& t);
+  monomial common_factor(const terms& t, const monomial& candidate);
+  void remove_factor(terms& t, const monomial& factor);
+  double find_div(const terms& t);
+  void normalize(terms& t, double div);
 
   static std::string stringify(double x);
   static std::string as_string(const degree_expression& e);
@@ -103,8 +113,8 @@ private:
   int get_sign(
       size_t vertices,
       const Graph& graph,
-      std::vector< circuit::edge_descriptor > order,
-      std::vector<bool> inL
+      const std::vector< circuit::edge_descriptor >& order,
+      const std::vector<bool>& inL
     );
 
 private:
@@ -112,6 +122,8 @@ private:
   std::pair<metacircuit::expression, metacircuit::expression> digit_;
   std::pair<metacircuit::expression, metacircuit::expression> mixed_;
 
+  std::vector<std::string> symbols_;
+
 };
 
 
@@ -0,0 +1,265 @@
+#include "model/sweep.h"
+#include "functor/functor.hpp"
+#include "boost-sapecng/parallel_for.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+#include <random>
+#include <sstream>
+
+
+namespace sapecng
+{
+
+
+namespace
+{
+
+std::vector<std::string> sweep_columns(
+    const std::vector<sweep_parameter>& parameters,
+    const std::vector< std::vector<double> >& samples
+  )
+{
+  std::vector<std::string> names(1, "sample");
+  for(std::vector<sweep_parameter>::const_iterator it = parameters.begin();
+      it != parameters.end(); ++it)
+    names.push_back(it->name);
+
+  for(std::vector< std::vector<double> >::const_iterator it =
+        samples.begin(); it != samples.end(); ++it)
+    if(it->size() != parameters.size())
+      throw simulation_error()
+        << what("sample size does not match the parameters");
+
+  return names;
+}
+
+
+// the leading columns of the rows [first, first + count) of a sample
+void fill_sample(
+    sweep_table& table,
+    std::size_t sample,
+    const std::vector<double>& values,
+    std::size_t first,
+    std::size_t count
+  )
+{
+  std::fill_n(table.column(0).begin() + first, count, double(sample));
+  for(std::size_t p = 0; p < values.size(); ++p)
+    std::fill_n(table.column(p + 1).begin() + first, count, values[p]);
+}
+
+
+template<class T>
+void write_binary(std::ostream& os, const T& value)
+{
+  os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+}
+
+
+
+std::vector< std::vector<double> >
+grid_samples(const std::vector<sweep_parameter>& parameters)
+{
+  std::vector< std::vector<double> > samples(1);
+
+  for(std::vector<sweep_parameter>::const_iterator it = parameters.begin();
+      it != parameters.end(); ++it) {
+    std::size_t levels = std::max<std::size_t>(it->levels, 1);
+
+    std::vector< std::vector<double> > next;
+    next.reserve(samples.size() * levels);
+    for(std::vector< std::vector<double> >::const_iterator
+          sit = samples.begin(); sit != samples.end(); ++sit)
+      for(std::size_t l = 0; l < levels; ++l) {
+        next.push_back(*sit);
+        next.back().push_back(levels == 1 ? it->min
+          : it->min + (it->max - it->min) * l / (levels - 1));
+      }
+
+    samples.swap(next);
+  }
+
+  return samples;
+}
+
+
+std::vector< std::vector<double> >
+latin_hypercube_samples(
+    const std::vector<sweep_parameter>& parameters,
+    std::size_t samples,
+    unsigned int seed
+  )
+{
+  std::vector< std::vector<double> > result(
+    samples, std::vector<double>(parameters.size()));
+
+  std::mt19937 engine(seed);
+  std::uniform_real_distribution<double> unit(0., 1.);
+
+  std::vector<std::size_t> strata(samples);
+  for(std::size_t p = 0; p < parameters.size(); ++p) {
+    for(std::size_t i = 0; i < samples; ++i)
+      strata[i] = i;
+    std::shuffle(strata.begin(), strata.end(), engine);
+
+    const sweep_parameter& par = parameters[p];
+    for(std::size_t i = 0; i < samples; ++i)
+      result[i][p] = par.min + (par.max - par.min)
+        * (strata[i] + unit(engine)) / samples;
+  }
+
+  return result;
+}
+
+
+
+sweep_table::sweep_table(
+    const std::vector<std::string>& names,
+    std::size_t rows
+  ): names_(names), data_(names.size(), std::vector<double>(rows)),
+     rows_(rows)
+{ }
+
+
+void sweep_table::write(std::ostream& os) const
+{
+  os.write("SAPECTBL", 8);
+  write_binary<std::uint32_t>(os, 1);
+  write_binary<std::uint32_t>(os, names_.size());
+  write_binary<std::uint64_t>(os, rows_);
+
+  for(std::vector<std::string>::const_iterator it = names_.begin();
+      it != names_.end(); ++it) {
+    write_binary<std::uint32_t>(os, it->size());
+    os.write(it->data(), it->size());
+  }
+
+  for(std::vector< std::vector<double> >::const_iterator it =
+        data_.begin(); it != data_.end(); ++it)
+    os.write(reinterpret_cast<const char*>(it->data()),
+      it->size() * sizeof(double));
+
+  if(!os)
+    throw stream_write_error() << what("cannot write the sweep table");
+}
+
+
+
+sweep_table frequency_sweep(
+    const std::pair<metacircuit::expression, metacircuit::expression>& h,
+    const std::map<std::string, double>& values,
+    const std::vector<sweep_parameter>& parameters,
+    const std::vector< std::vector<double> >& samples,
+    const std::vector<double>& frequencies,
+    unsigned int threads
+  )
+{
+  std::vector<std::string> names = sweep_columns(parameters, samples);
+  names.push_back("frequency");
+  names.push_back("magnitude");
+  names.push_back("phase");
+
+  std::size_t block = frequencies.size();
+  std::size_t base = parameters.size() + 1;
+  sweep_table table(names, samples.size() * block);
+
+  boost::parallel_for(samples.size(), threads,
+      [&](std::size_t, std::size_t s) {
+    std::map<std::string, double> sample_values(values);
+    for(std::size_t p = 0; p < parameters.size(); ++p)
+      sample_values[parameters[p].name] = samples[s][p];
+
+    std::vector< std::complex<double> > response =
+      rational_function(h.first, h.second, sample_values)
+        .frequency_response(frequencies);
+
+    std::size_t first = s * block;
+    fill_sample(table, s, samples[s], first, block);
+    for(std::size_t i = 0; i < block; ++i) {
+      table.column(base)[first + i] = frequencies[i];
+      table.column(base + 1)[first + i] = std::abs(response[i]);
+      table.column(base + 2)[first + i] = std::arg(response[i]);
+    }
+  });
+
+  return table;
+}
+
+
+sweep_table transient_sweep(
+    const netlist& netlist,
+    const std::vector<sweep_parameter>& parameters,
+    const std::vector< std::vector<double> >& samples,
+    double dt,
+    std::size_t steps,
+    std::size_t stride,
+    const std::function<double (double)>& interface_flow,
+    const std::function<double (std::size_t, double)>& prescribed_flow,
+    const std::vector<unsigned int>& nodes,
+    unsigned int threads
+  )
+{
+  class netlist probe(netlist);
+  for(std::vector<sweep_parameter>::const_iterator it = parameters.begin();
+      it != parameters.end(); ++it)
+    if(!probe.set_value(it->name, 0.))
+      throw simulation_error() << what("no component named " + it->name);
+
+  std::vector<std::string> names = sweep_columns(parameters, samples);
+  names.push_back("time");
+  for(std::vector<unsigned int>::const_iterator it = nodes.begin();
+      it != nodes.end(); ++it) {
+    std::ostringstream name;
+    name << "P" << *it;
+    names.push_back(name.str());
+  }
+
+  std::vector<std::size_t> prescribed;
+  for(std::size_t i = 0; i < netlist.components().size(); ++i)
+    if(netlist.components()[i].prescribed_flow)
+      prescribed.push_back(i);
+
+  stride = std::max<std::size_t>(stride, 1);
+  std::size_t block = steps / stride;
+  std::size_t base = parameters.size() + 1;
+  sweep_table table(names, samples.size() * block);
+
+  boost::parallel_for(samples.size(), threads,
+      [&](std::size_t, std::size_t s) {
+    class netlist sample_netlist(netlist);
+    for(std::size_t p = 0; p < parameters.size(); ++p)
+      sample_netlist.set_value(parameters[p].name, samples[s][p]);
+
+    transient sim(sample_netlist, dt);
+
+    std::size_t first = s * block;
+    fill_sample(table, s, samples[s], first, block);
+    for(std::size_t row = first; row < first + block; ++row) {
+      for(std::size_t i = 0; i < stride; ++i) {
+        // backward Euler: the sources are taken at the end of the step
+        double t = sim.time() + sim.dt();
+        if(interface_flow)
+          sim.set_interface_flow(interface_flow(t));
+        if(prescribed_flow)
+          for(std::size_t c = 0; c < prescribed.size(); ++c)
+            sim.set_prescribed_flow(prescribed[c],
+              prescribed_flow(prescribed[c], t));
+        sim.step();
+      }
+
+      table.column(base)[row] = sim.time();
+      for(std::size_t n = 0; n < nodes.size(); ++n)
+        table.column(base + 1 + n)[row] = sim.pressure(nodes[n]);
+    }
+  });
+
+  return table;
+}
+
+
+}
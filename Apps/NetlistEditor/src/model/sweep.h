@@ -0,0 +1,130 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+
+#include "model/metacircuit.h"
+#include "model/transient.h"
+
+#include <functional>
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+
+
+namespace sapecng
+{
+
+
+// Range of values taken by one component in a sweep. The name is the
+// symbol of the component in the metacircuit expressions, or its name in
+// the netlist for the transient sweeps.
+struct sweep_parameter
+{
+  std::string name;
+  double min;
+  double max;
+  std::size_t levels;  // grid samples only
+};
+
+
+// Every combination of the parameter levels, one row per sample, with
+// the first parameter varying slowest.
+std::vector< std::vector<double> >
+grid_samples(const std::vector<sweep_parameter>& parameters);
+
+// Latin hypercube of the parameter ranges: every parameter hits each of
+// the samples strata exactly once, at a random point within it.
+std::vector< std::vector<double> >
+latin_hypercube_samples(
+    const std::vector<sweep_parameter>& parameters,
+    std::size_t samples,
+    unsigned int seed = 0
+  );
+
+
+
+/*
+ * Named columns of doubles, filled by the sweeps and written as a binary
+ * table:
+ *
+ *   "SAPECTBL", uint32 version, uint32 columns, uint64 rows,
+ *   for every column: uint32 name length, name,
+ *   for every column: rows doubles.
+ *
+ * Integers and doubles are stored in the native byte order, so that the
+ * columns can be mapped straight into numpy or pandas.
+ */
+class sweep_table
+{
+
+public:
+  sweep_table(const std::vector<std::string>& names, std::size_t rows);
+
+  inline std::size_t columns() const
+    { return names_.size(); }
+
+  inline std::size_t rows() const
+    { return rows_; }
+
+  inline const std::string& name(std::size_t column) const
+    { return names_[column]; }
+
+  inline std::vector<double>& column(std::size_t column)
+    { return data_[column]; }
+
+  inline const std::vector<double>& column(std::size_t column) const
+    { return data_[column]; }
+
+  void write(std::ostream& os) const;
+
+private:
+  std::vector<std::string> names_;
+  std::vector< std::vector<double> > data_;
+  std::size_t rows_;
+
+};
+
+
+
+/*
+ * The sweeps evaluate every sample on its own worker thread (threads = 0
+ * means one per hardware thread) and lay the results out sample after
+ * sample, whatever the order they were computed in. The columns are
+ * "sample", the parameters, then the ones listed for each sweep.
+ */
+
+// columns: "frequency", "magnitude", "phase"
+sweep_table frequency_sweep(
+    const std::pair<metacircuit::expression, metacircuit::expression>& h,
+    const std::map<std::string, double>& values,
+    const std::vector<sweep_parameter>& parameters,
+    const std::vector< std::vector<double> >& samples,
+    const std::vector<double>& frequencies,
+    unsigned int threads = 0
+  );
+
+// columns: "time", then "P<node>" for every node; the network is sampled
+// every stride steps. The callbacks are called from all the workers at
+// once, at the end time of every step: interface_flow gives the flow
+// entering the 3D interface node, prescribed_flow the one through each
+// component marked as prescribed flow (by index in the netlist). Either
+// may be empty, which leaves the flow at zero.
+sweep_table transient_sweep(
+    const netlist& netlist,
+    const std::vector<sweep_parameter>& parameters,
+    const std::vector< std::vector<double> >& samples,
+    double dt,
+    std::size_t steps,
+    std::size_t stride,
+    const std::function<double (double)>& interface_flow,
+    const std::function<double (std::size_t, double)>& prescribed_flow,
+    const std::vector<unsigned int>& nodes,
+    unsigned int threads = 0
+  );
+
+
+}
+
+
+#endif // SWEEP_H
@@ -0,0 +1,583 @@
+#include "model/transient.h"
+#include "utility/strings.h"
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+
+
+namespace sapecng
+{
+
+
+bool netlist::set_value(const std::string& name, double value)
+{
+  bool found = false;
+  for(std::vector<component>::iterator it = components_.begin();
+      it != components_.end(); ++it)
+    if(it->name == name) {
+      it->value = value;
+      found = true;
+    }
+
+  return found;
+}
+
+
+
+void netlist_builder::add_threeD_interface_node(
+    unsigned int v,
+    std::map<std::string,std::string> props
+  )
+{
+  netlist_.interface_ = v;
+}
+
+
+void netlist_builder::add_prescribed_pressure_node(
+    std::string name,
+    double value,
+    unsigned int v,
+    std::map<std::string,std::string> props
+  )
+{
+  netlist_.pressures_[v] = value;
+}
+
+
+void netlist_builder::add_dual_component(
+    abstract_builder::dual_component_type c_type,
+    std::string name,
+    std::vector<double> parameterValues,
+    unsigned int va,
+    unsigned int vb,
+    std::map<std::string,std::string> props
+  )
+{
+  netlist::component c;
+  c.name = name;
+  c.value = parameterValues.empty() ? 0. : parameterValues.front();
+  c.va = va;
+  c.vb = vb;
+
+  std::map<std::string,std::string>::const_iterator control =
+    props.find(predefinedStrings::componentControlTypeFieldName);
+  c.prescribed_flow = (control != props.end()
+    && control->second == predefinedStrings::periodicPrescribedFlowString);
+
+  switch(c_type)
+  {
+  case abstract_builder::Component_Resistor:
+    c.type = netlist::resistor;
+    break;
+  case abstract_builder::G:
+    c.type = netlist::conductance;
+    break;
+  case abstract_builder::Component_Inductor:
+    c.type = netlist::inductor;
+    break;
+  case abstract_builder::Component_Capacitor:
+    c.type = netlist::capacitor;
+    break;
+  case abstract_builder::Component_Diode:
+    c.type = netlist::diode;
+    break;
+  case abstract_builder::V:
+    c.type = netlist::pressure_source;
+    break;
+  case abstract_builder::I:
+    c.type = netlist::flow_source;
+    break;
+  default:
+    throw simulation_error()
+      << what("unsupported component in transient simulation: " + name);
+  }
+
+  netlist_.components_.push_back(c);
+}
+
+
+void netlist_builder::add_quad_component(
+    abstract_builder::quad_component_type c_type,
+    std::string name,
+    std::vector<double> parameterValues,
+    bool hasControl,
+    unsigned int va,
+    unsigned int vb,
+    unsigned int vac,
+    unsigned int vbc,
+    std::map<std::string,std::string> props
+  )
+{
+  throw simulation_error()
+    << what("unsupported component in transient simulation: " + name);
+}
+
+
+
+/*
+ * Sparse LU factorization with a minimum degree choice of the pivot column
+ * and threshold partial pivoting within it: among the rows whose entry is
+ * within a tenth of the largest one the shortest row wins. Both keep the
+ * fill-in low on the mostly tree-like lumped networks, whatever order the
+ * nodes and the branches were numbered in.
+ */
+class transient::sparse_lu
+{
+
+public:
+  sparse_lu(std::vector< std::map<int, double> >& rows);
+
+  void solve(std::vector<double>& b) const;
+
+private:
+  typedef std::vector< std::pair<int, double> > sparse_vector;
+
+  std::vector<int> pivot_;
+  std::vector<int> column_;
+  std::vector<sparse_vector> lower_;
+  std::vector<sparse_vector> upper_;
+
+};
+
+
+transient::sparse_lu::sparse_lu(std::vector< std::map<int, double> >& rows)
+  : pivot_(rows.size()), column_(rows.size()),
+    lower_(rows.size()), upper_(rows.size())
+{
+  std::size_t n = rows.size();
+
+  double scale = 0.;
+  std::vector< std::set<int> > cols(n);
+  for(std::size_t r = 0; r < n; ++r)
+    for(std::map<int, double>::const_iterator it = rows[r].begin();
+        it != rows[r].end(); ++it) {
+      cols[it->first].insert(r);
+      scale = std::max(scale, std::fabs(it->second));
+    }
+
+  // remaining columns sorted by their number of entries
+  std::set< std::pair<std::size_t, int> > degree;
+  for(std::size_t c = 0; c < n; ++c)
+    degree.insert(std::make_pair(cols[c].size(), c));
+
+  for(std::size_t k = 0; k < n; ++k) {
+    int c = degree.begin()->second;
+    degree.erase(degree.begin());
+
+    double max = 0.;
+    for(std::set<int>::const_iterator r = cols[c].begin();
+        r != cols[c].end(); ++r)
+      max = std::max(max, std::fabs(rows[*r][c]));
+
+    if(max <= 1e-14 * scale)
+      throw simulation_error()
+        << what("singular system: check for floating nodes or loops of "
+                "pressure sources");
+
+    int p = -1;
+    for(std::set<int>::const_iterator r = cols[c].begin();
+        r != cols[c].end(); ++r)
+      if(std::fabs(rows[*r][c]) >= 0.1 * max
+          && (p < 0 || rows[*r].size() < rows[p].size()))
+        p = *r;
+
+    pivot_[k] = p;
+    column_[k] = c;
+
+    std::map<int, double>& prow = rows[p];
+    for(std::map<int, double>::const_iterator it = prow.begin();
+        it != prow.end(); ++it)
+      if(it->first != c) {
+        degree.erase(std::make_pair(cols[it->first].size(), it->first));
+        cols[it->first].erase(p);
+        degree.insert(std::make_pair(cols[it->first].size(), it->first));
+      }
+    cols[c].erase(p);
+
+    double d = prow[c];
+    for(std::set<int>::const_iterator r = cols[c].begin();
+        r != cols[c].end(); ++r) {
+      std::map<int, double>& row = rows[*r];
+      double f = row[c] / d;
+      lower_[k].push_back(std::make_pair(*r, f));
+      row.erase(c);
+
+      for(std::map<int, double>::const_iterator it = prow.begin();
+          it != prow.end(); ++it) {
+        if(it->first == c)
+          continue;
+
+        std::pair<std::map<int, double>::iterator, bool> ins =
+          row.insert(std::make_pair(it->first, 0.));
+        if(ins.second) {
+          degree.erase(std::make_pair(cols[it->first].size(), it->first));
+          cols[it->first].insert(*r);
+          degree.insert(std::make_pair(cols[it->first].size(), it->first));
+        }
+        ins.first->second -= f * it->second;
+      }
+    }
+    cols[c].clear();
+
+    // the diagonal goes first, followed by the not yet eliminated columns
+    upper_[k].push_back(std::make_pair(c, d));
+    for(std::map<int, double>::const_iterator it = prow.begin();
+        it != prow.end(); ++it)
+      if(it->first != c)
+        upper_[k].push_back(*it);
+    prow.clear();
+  }
+}
+
+
+void transient::sparse_lu::solve(std::vector<double>& b) const
+{
+  std::size_t n = pivot_.size();
+
+  for(std::size_t k = 0; k < n; ++k) {
+    double v = b[pivot_[k]];
+    for(sparse_vector::const_iterator it = lower_[k].begin();
+        it != lower_[k].end(); ++it)
+      b[it->first] -= it->second * v;
+  }
+
+  std::vector<double> x(n);
+  for(std::size_t k = n; k-- > 0; ) {
+    double s = b[pivot_[k]];
+    for(sparse_vector::const_iterator it = upper_[k].begin() + 1;
+        it != upper_[k].end(); ++it)
+      s -= it->second * x[it->first];
+    x[column_[k]] = s / upper_[k].front().second;
+  }
+
+  b.swap(x);
+}
+
+
+
+transient::transient(const netlist& netlist, double dt)
+  : netlist_(netlist), dt_(dt), time_(0.), interface_flow_(0.)
+{
+  if(!(dt_ > 0.))
+    throw simulation_error() << what("time step must be positive");
+
+  const std::vector<netlist::component>& comps = netlist_.components();
+
+  std::set<unsigned int> nodes;
+  for(std::vector<netlist::component>::const_iterator it = comps.begin();
+      it != comps.end(); ++it) {
+    nodes.insert(it->va);
+    nodes.insert(it->vb);
+  }
+  for(std::map<unsigned int, double>::const_iterator it =
+        netlist_.prescribed_pressures().begin();
+      it != netlist_.prescribed_pressures().end(); ++it)
+    nodes.insert(it->first);
+  nodes.insert(netlist_.interface_node());
+  nodes.erase(abstract_builder::GROUND);
+
+  int next = 0;
+  for(std::set<unsigned int>::const_iterator it = nodes.begin();
+      it != nodes.end(); ++it)
+    node_[*it] = next++;
+
+  ends_.resize(comps.size());
+  branch_.assign(comps.size(), -1);
+  for(std::size_t i = 0; i < comps.size(); ++i) {
+    const netlist::component& c = comps[i];
+    ends_[i].first = c.va == abstract_builder::GROUND ? -1 : node_[c.va];
+    ends_[i].second = c.vb == abstract_builder::GROUND ? -1 : node_[c.vb];
+    if(c.prescribed_flow)
+      continue;
+
+    switch(c.type)
+    {
+    case netlist::diode:
+      diodes_.push_back(i);
+      // fall through
+    case netlist::inductor:
+    case netlist::pressure_source:
+      branch_[i] = next++;
+      break;
+    case netlist::resistor:
+      if(c.value == 0.)
+        throw simulation_error() << what("zero resistance: " + c.name);
+      break;
+    default:
+      break;
+    }
+  }
+
+  for(std::map<unsigned int, double>::const_iterator it =
+        netlist_.prescribed_pressures().begin();
+      it != netlist_.prescribed_pressures().end(); ++it)
+    if(it->first != abstract_builder::GROUND)
+      pbranch_[it->first] = next++;
+
+  size_ = next;
+  pressures_ = netlist_.prescribed_pressures();
+
+  x_.assign(size_, 0.);
+  for(std::map<unsigned int, double>::const_iterator it = pressures_.begin();
+      it != pressures_.end(); ++it)
+    if(it->first != abstract_builder::GROUND)
+      x_[node_[it->first]] = it->second;
+
+  flow_.assign(comps.size(), 0.);
+  prescribed_.assign(comps.size(), 0.);
+  open_.assign(diodes_.size(), true);
+}
+
+
+void transient::set_prescribed_flow(std::size_t component, double flow)
+{
+  prescribed_.at(component) = flow;
+}
+
+
+void transient::set_prescribed_pressure(unsigned int node, double pressure)
+{
+  std::map<unsigned int, double>::iterator it = pressures_.find(node);
+  if(it == pressures_.end())
+    throw simulation_error() << what("not a prescribed pressure node");
+  it->second = pressure;
+}
+
+
+void transient::set_pressure(unsigned int node, double pressure)
+{
+  std::map<unsigned int, int>::const_iterator it = node_.find(node);
+  if(it == node_.end())
+    throw simulation_error() << what("unknown node");
+  x_[it->second] = pressure;
+}
+
+
+double transient::pressure(unsigned int node) const
+{
+  if(node == abstract_builder::GROUND)
+    return 0.;
+
+  std::map<unsigned int, int>::const_iterator it = node_.find(node);
+  if(it == node_.end())
+    throw simulation_error() << what("unknown node");
+  return x_[it->second];
+}
+
+
+double transient::flow(std::size_t component) const
+{
+  return flow_.at(component);
+}
+
+
+double transient::drop(const std::vector<double>& x, std::size_t i) const
+{
+  int a = ends_[i].first;
+  int b = ends_[i].second;
+  return (a < 0 ? 0. : x[a]) - (b < 0 ? 0. : x[b]);
+}
+
+
+const transient::sparse_lu& transient::factorization()
+{
+  boost::shared_ptr<sparse_lu>& lu = factorizations_[open_];
+  if(lu)
+    return *lu;
+
+  std::vector< std::map<int, double> > rows(size_);
+  struct stamp
+  {
+    std::vector< std::map<int, double> >& rows;
+    void operator()(int r, int c, double v) const
+      { if(r >= 0 && c >= 0) rows[r][c] += v; }
+  } add = { rows };
+
+  const std::vector<netlist::component>& comps = netlist_.components();
+  for(std::size_t i = 0; i < comps.size(); ++i) {
+    const netlist::component& c = comps[i];
+    if(c.prescribed_flow)
+      continue;
+
+    int a = ends_[i].first;
+    int b = ends_[i].second;
+    int q = branch_[i];
+
+    double g = 0.;
+    switch(c.type)
+    {
+    case netlist::resistor:
+      g = 1. / c.value;
+      break;
+    case netlist::conductance:
+      g = c.value;
+      break;
+    case netlist::capacitor:
+      g = c.value / dt_;
+      break;
+    default:
+      break;
+    }
+
+    if(g != 0.) {
+      add(a, a, g);
+      add(b, b, g);
+      add(a, b, -g);
+      add(b, a, -g);
+    }
+
+    if(q < 0)
+      continue;
+
+    // the branch flow leaves a and enters b
+    add(a, q, 1.);
+    add(b, q, -1.);
+
+    switch(c.type)
+    {
+    case netlist::inductor:
+      // Pa - Pb - L/dt Q = - L/dt Q_prev
+      add(q, a, 1.);
+      add(q, b, -1.);
+      add(q, q, -c.value / dt_);
+      break;
+    case netlist::diode:
+      // open: Pa - Pb - R Q = 0, closed: Q = 0
+      if(open_[std::lower_bound(diodes_.begin(), diodes_.end(), i)
+            - diodes_.begin()]) {
+        add(q, a, 1.);
+        add(q, b, -1.);
+        add(q, q, -std::max(c.value, 0.));
+      } else
+        add(q, q, 1.);
+      break;
+    case netlist::pressure_source:
+      // Pa - Pb = V
+      add(q, a, 1.);
+      add(q, b, -1.);
+      break;
+    default:
+      break;
+    }
+  }
+
+  for(std::map<unsigned int, int>::const_iterator it = pbranch_.begin();
+      it != pbranch_.end(); ++it) {
+    int n = node_[it->first];
+    add(n, it->second, 1.);
+    add(it->second, n, 1.);
+  }
+
+  lu.reset(new sparse_lu(rows));
+  return *lu;
+}
+
+
+void transient::assemble(std::vector<double>& rhs) const
+{
+  rhs.assign(size_, 0.);
+
+  const std::vector<netlist::component>& comps = netlist_.components();
+  for(std::size_t i = 0; i < comps.size(); ++i) {
+    const netlist::component& c = comps[i];
+    int a = ends_[i].first;
+    int b = ends_[i].second;
+
+    double source = 0.;
+    if(c.prescribed_flow)
+      source = -prescribed_[i];
+    else switch(c.type)
+    {
+    case netlist::capacitor:
+      source = c.value / dt_ * drop(x_, i);
+      break;
+    case netlist::flow_source:
+      source = -c.value;
+      break;
+    case netlist::inductor:
+      rhs[branch_[i]] = -c.value / dt_ * x_[branch_[i]];
+      break;
+    case netlist::pressure_source:
+      rhs[branch_[i]] = c.value;
+      break;
+    default:
+      break;
+    }
+
+    if(a >= 0)
+      rhs[a] += source;
+    if(b >= 0)
+      rhs[b] -= source;
+  }
+
+  for(std::map<unsigned int, int>::const_iterator it = pbranch_.begin();
+      it != pbranch_.end(); ++it)
+    rhs[it->second] = pressures_.find(it->first)->second;
+
+  if(netlist_.interface_node() != abstract_builder::GROUND)
+    rhs[node_.find(netlist_.interface_node())->second] += interface_flow_;
+}
+
+
+void transient::step()
+{
+  const std::vector<netlist::component>& comps = netlist_.components();
+
+  std::vector<double> rhs;
+  assemble(rhs);
+
+  // diodes switch until their state agrees with the solution, bounded
+  // to stay clear of chattering on a stiff network
+  std::vector<double> x;
+  for(std::size_t iter = 0; ; ++iter) {
+    x = rhs;
+    factorization().solve(x);
+
+    bool changed = false;
+    if(iter <= diodes_.size())
+      for(std::size_t d = 0; d < diodes_.size(); ++d) {
+        std::size_t i = diodes_[d];
+        if(open_[d] ? x[branch_[i]] < 0. : drop(x, i) > 0.) {
+          open_[d] = !open_[d];
+          changed = true;
+        }
+      }
+
+    if(!changed)
+      break;
+  }
+
+  for(std::size_t i = 0; i < comps.size(); ++i) {
+    const netlist::component& c = comps[i];
+    double dp = drop(x, i);
+
+    if(c.prescribed_flow)
+      flow_[i] = prescribed_[i];
+    else if(branch_[i] >= 0)
+      flow_[i] = x[branch_[i]];
+    else switch(c.type)
+    {
+    case netlist::resistor:
+      flow_[i] = dp / c.value;
+      break;
+    case netlist::conductance:
+      flow_[i] = dp * c.value;
+      break;
+    case netlist::capacitor:
+      flow_[i] = c.value / dt_ * (dp - drop(x_, i));
+      break;
+    case netlist::flow_source:
+      flow_[i] = c.value;
+      break;
+    default:
+      break;
+    }
+  }
+
+  x_.swap(x);
+  time_ += dt_;
+}
+
+
+}
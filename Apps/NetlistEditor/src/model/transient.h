@@ -0,0 +1,220 @@
+#ifndef TRANSIENT_H
+#define TRANSIENT_H
+
+
+#include "parser/parser.h"
+#include "exception/sapecngexception.h"
+
+#include <boost/shared_ptr.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+
+namespace sapecng
+{
+
+
+/*
+ * Numeric view of a boundary-condition netlist.
+ *
+ * Unlike circuit, which folds every component into the two-graph
+ * representation used by the symbolic analysis, the netlist keeps the
+ * components as they are exported to the flowsolver, together with the
+ * prescribed pressure nodes and the 3D interface node. Volume tracking
+ * chambers and the quad components have no numeric model yet, the builder
+ * throws a simulation_error when it meets one.
+ */
+class netlist
+{
+
+friend class netlist_builder;
+
+public:
+  enum component_type
+    {
+      resistor,
+      conductance,
+      inductor,
+      capacitor,
+      diode,
+      pressure_source,
+      flow_source
+    };
+
+  struct component
+  {
+    component_type type;
+    std::string name;
+    double value;
+    unsigned int va;
+    unsigned int vb;
+    bool prescribed_flow;
+  };
+
+  netlist(): interface_(0) { }
+
+  inline const std::vector<component>& components() const
+    { return components_; }
+
+  inline const std::map<unsigned int, double>& prescribed_pressures() const
+    { return pressures_; }
+
+  inline unsigned int interface_node() const
+    { return interface_; }
+
+  // sets the value of every component with the given name, returns
+  // whether there was any
+  bool set_value(const std::string& name, double value);
+
+private:
+  std::vector<component> components_;
+  std::map<unsigned int, double> pressures_;
+  unsigned int interface_;
+
+};
+
+
+
+class netlist_builder: public abstract_builder
+{
+
+public:
+  netlist_builder(netlist& netlist): netlist_(netlist) { }
+
+  void add_circuit_properties(std::map<std::string,std::string> map) { }
+  void add_circuit_property(std::string name, std::string value) { }
+
+  void add_wire_component(
+      std::map<std::string,std::string> props =
+        std::map<std::string,std::string>()
+    ) { }
+
+  void add_threeD_interface_node(
+      unsigned int v,
+      std::map<std::string,std::string> props =
+        std::map<std::string,std::string>()
+    );
+
+  void add_prescribed_pressure_node(
+      std::string name,
+      double value,
+      unsigned int v,
+      std::map<std::string,std::string> props =
+        std::map<std::string,std::string>()
+    );
+
+  void add_dual_component(
+      abstract_builder::dual_component_type c_type,
+      std::string name,
+      std::vector<double> parameterValues,
+      unsigned int va,
+      unsigned int vb,
+      std::map<std::string,std::string> props =
+        std::map<std::string,std::string>()
+    );
+
+  void add_quad_component(
+      abstract_builder::quad_component_type c_type,
+      std::string name,
+      std::vector<double> parameterValues,
+      bool hasControl,
+      unsigned int va,
+      unsigned int vb,
+      unsigned int vac,
+      unsigned int vbc,
+      std::map<std::string,std::string> props =
+        std::map<std::string,std::string>()
+    );
+
+  void add_unknow_component(
+      std::map<std::string,std::string> props =
+        std::map<std::string,std::string>()
+    ) { }
+
+  void flush() { }
+
+private:
+  netlist& netlist_;
+
+};
+
+
+
+/*
+ * Backward Euler time stepping of a netlist by modified nodal analysis.
+ *
+ * Pressures play the role of the nodal potentials and flows the one of the
+ * branch currents. Inductors, diodes, pressure sources and prescribed
+ * pressure nodes get an extra branch unknown; everything else is stamped
+ * straight into the nodal equations. The sparse system only depends on the
+ * time step and on the open/closed state of the diodes, so it is factorized
+ * once for every state that shows up and reused by all the later steps.
+ */
+class transient
+{
+
+public:
+  transient(const netlist& netlist, double dt);
+
+  // flow entering the network at the 3D interface node
+  inline void set_interface_flow(double flow)
+    { interface_flow_ = flow; }
+
+  // flow through a component marked as periodic prescribed flow
+  void set_prescribed_flow(std::size_t component, double flow);
+
+  // overrides the value of a prescribed pressure node
+  void set_prescribed_pressure(unsigned int node, double pressure);
+
+  // initial condition, meaningful before the first step only
+  void set_pressure(unsigned int node, double pressure);
+
+  void step();
+
+  inline double time() const
+    { return time_; }
+
+  inline double dt() const
+    { return dt_; }
+
+  double pressure(unsigned int node) const;
+  double flow(std::size_t component) const;
+
+private:
+  class sparse_lu;
+
+  double drop(const std::vector<double>& x, std::size_t component) const;
+  void assemble(std::vector<double>& rhs) const;
+  const sparse_lu& factorization();
+
+private:
+  netlist netlist_;
+  double dt_;
+  double time_;
+  double interface_flow_;
+
+  std::map<unsigned int, int> node_;
+  std::vector< std::pair<int, int> > ends_;
+  std::vector<int> branch_;
+  std::vector<std::size_t> diodes_;
+  std::map<unsigned int, int> pbranch_;
+  std::size_t size_;
+
+  std::vector<double> x_;
+  std::vector<double> flow_;
+  std::vector<double> prescribed_;
+  std::map<unsigned int, double> pressures_;
+  std::vector<bool> open_;  // one per diode
+
+  std::map< std::vector<bool>, boost::shared_ptr<sparse_lu> >
+    factorizations_;
+
+};
+
+
+}
+
+
+#endif // TRANSIENT_H
@@ -1,9 +1,21 @@
 #include "AsyncTask.h"
 
+#include <typeinfo>
 
 namespace crimson {
 namespace async {
 
+    Task::Task()
+    {
+        progressMadeSignal.connect([this](unsigned int steps) {
+            if (!TaskProfiler::getInstance().isEnabled()) {
+                return;
+            }
+            std::lock_guard<std::mutex> lock(_profileMutex);
+            _profile.progress.emplace_back(TaskProfileRecord::Clock::now(), steps);
+        });
+    }
+
     void Task::run()
     {
         if (isCancelling()) {
@@ -13,10 +25,19 @@ namespace async {
 
         setState(State_Running);
         try {
+            if (restoreResultFromCache()) {
+                setState(State_Finished, std::string("Result restored from cache."));
+                return;
+            }
+
             State resultState;
             std::string message; 
             std::tie(resultState, message) = runTask();
 
+            if (resultState == State_Finished && !isCancelling()) {
+                storeResultInCache();
+            }
+
             // In case the actual task didn't react to cancellation request, process it here
             setState(isCancelling() ? State_Cancelled : resultState, message);
         }
@@ -42,11 +63,76 @@ namespace async {
 
     void Task::setState(State state, const std::string& message)
     {
+        _updateProfile(state);
+
         _state = state;
         _lastStateChangeMessage = message;
         taskStateChangedSignal(state, message);
     }
 
+    void Task::setProfileName(const std::string& name)
+    {
+        std::lock_guard<std::mutex> lock(_profileMutex);
+        _profile.name = name;
+    }
+
+    void Task::markQueued()
+    {
+        std::lock_guard<std::mutex> lock(_profileMutex);
+        _profile.queuedTime = TaskProfileRecord::Clock::now();
+        _profile.queued = true;
+    }
+
+    TaskProfileRecord Task::getProfile() const
+    {
+        std::lock_guard<std::mutex> lock(_profileMutex);
+        return _profile;
+    }
+
+    void Task::_updateProfile(State state)
+    {
+        TaskProfileRecord completedProfile;
+        {
+            std::lock_guard<std::mutex> lock(_profileMutex);
+            TaskProfileRecord::Clock::time_point now = TaskProfileRecord::Clock::now();
+
+            switch (state) {
+            case State_Starting:
+                // Tasks not submitted through markQueued() are considered queued when started
+                if (!_profile.queued) {
+                    _profile.queuedTime = now;
+                    _profile.queued = true;
+                }
+                break;
+            case State_Running:
+                _profile.startTime = now;
+                _profile.started = true;
+                _profile.threadId = std::this_thread::get_id();
+                break;
+            case State_Cancelling:
+                if (!_profile.cancelRequested) {
+                    _profile.cancelRequestTime = now;
+                    _profile.cancelRequested = true;
+                }
+                break;
+            default:
+                break;
+            }
+
+            if (!isStateTerminal(state) || _profile.finalState != -1) {
+                return;
+            }
+
+            _profile.endTime = now;
+            _profile.finalState = state;
+            if (_profile.name.empty()) {
+                _profile.name = typeid(*this).name();
+            }
+            completedProfile = _profile;
+        }
+
+        TaskProfiler::getInstance().addRecord(completedProfile);
+    }
+
 }
 }
-
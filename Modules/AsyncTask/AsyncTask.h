@@ -2,10 +2,12 @@
 
 #include <string>
 #include <exception>
+#include <mutex>
 
 #include <boost/signals2.hpp>
 
 #include "AsyncTaskExports.h"
+#include "TaskProfiler.h"
 
 namespace crimson {
 namespace async {
@@ -31,7 +33,7 @@ public:
      */
     static bool isStateTerminal(State state) { return state == State_Cancelled || state == State_Failed || state == State_Finished; }
 
-    Task() = default;
+    Task();
     Task(const Task&) = default;
     virtual ~Task() {}
 
@@ -75,6 +77,23 @@ public:
      */
     const std::string& getLastStateChangeMessage() const { return _lastStateChangeMessage; }
 
+    ///@{ 
+    /*!
+     * \brief   Sets the name used to identify the task in the profiling records.
+     */
+    void setProfileName(const std::string& name);
+
+    /*!
+     * \brief   Records the time the task has been submitted for execution.
+     */
+    void markQueued();
+
+    /*!
+     * \brief   Gets the timing information collected for the task so far.
+     */
+    TaskProfileRecord getProfile() const;
+    ///@} 
+
 protected:
 
     /*!
@@ -88,10 +107,27 @@ protected:
      * \brief   Call this method in your override of runTask() to check if a cancellation request has been issued.
      */
     bool isCancelling() const;
+
+    /*!
+     * \brief   Called before runTask(). Override to serve the task result from a cache.
+     *
+     * \return  true if the result has been restored and runTask() should not be executed.
+     */
+    virtual bool restoreResultFromCache() { return false; }
+
+    /*!
+     * \brief   Called after runTask() has finished successfully. Override to store the task result in a cache.
+     */
+    virtual void storeResultInCache() {}
     
 private:
+    void _updateProfile(State state);
+
     State _state = State_Idle;
     std::string _lastStateChangeMessage;
+
+    mutable std::mutex _profileMutex;
+    TaskProfileRecord _profile;
 };
 
 }
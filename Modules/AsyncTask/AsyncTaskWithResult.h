@@ -1,13 +1,22 @@
 #pragma once
 
 #include "AsyncTask.h"
+#include "TaskResultCache.h"
+
+#include <typeinfo>
 
 #include <boost/optional.hpp>
 
 namespace crimson {
 namespace async {
 
-/*! \brief   An asynchronous task which stores the result of task execution. */
+/*!
+ * \brief   An asynchronous task which stores the result of task execution.
+ *
+ *  Tasks whose result is fully determined by their inputs can override inputHash() to enable
+ *  memoization: the results are then stored in TaskResultCache and served from it instead of
+ *  re-running the task with identical inputs.
+ */
 template<typename T>
 class TaskWithResult : public Task {
 public:
@@ -19,15 +28,69 @@ public:
      */
     boost::optional<T> getResult() { return _result; }
 
+    /*!
+     * \brief   Gets the deterministic hash of all the inputs of the task. An empty string (default)
+     *  means that the task result cannot be memoized.
+     */
+    virtual std::string inputHash() const { return std::string(); }
+
 protected:
     void setResult(const T& result)
     {
         _result = result;
     }
 
+    /*!
+     * \brief   Creates a copy of the result to be stored in or retrieved from the cache. Override
+     *  if T has reference semantics and the users of the result may modify it.
+     */
+    virtual T copyResult(const T& result) const { return result; }
+
+    // Task
+    bool restoreResultFromCache() override
+    {
+        std::string key = _cacheKey();
+        if (key.empty()) {
+            return false;
+        }
+
+        boost::optional<boost::any> cachedResult = TaskResultCache::getInstance().find(key);
+        if (!cachedResult) {
+            return false;
+        }
+
+        const T* typedResult = boost::any_cast<T>(&cachedResult.get());
+        if (!typedResult) {
+            return false;
+        }
+
+        setResult(copyResult(*typedResult));
+        return true;
+    }
+
+    void storeResultInCache() override
+    {
+        std::string key = _cacheKey();
+        if (key.empty() || !_result) {
+            return;
+        }
+
+        TaskResultCache::getInstance().insert(key, boost::any(copyResult(_result.get())));
+    }
+
 private:
+    std::string _cacheKey() const
+    {
+        std::string hash = inputHash();
+        if (hash.empty()) {
+            return hash;
+        }
+        // Distinguish between the task types having the same inputs
+        return std::string(typeid(*this).name()) + "_" + hash;
+    }
+
     boost::optional<T> _result;
 };
 
 }
-}
\ No newline at end of file
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <type_traits>
+
+namespace crimson {
+namespace async {
+
+/*!
+ * \brief   Incremental content hash used by tasks to describe their inputs.
+ *
+ *  Uses 64-bit FNV-1a so that the digest is stable across runs and platforms, which allows
+ *  it to be used as a key for the on-disk result cache.
+ */
+class TaskInputHash {
+public:
+    /*!
+     * \brief   Appends raw bytes to the hash.
+     */
+    TaskInputHash& addBytes(const void* data, size_t size)
+    {
+        auto bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            _state ^= bytes[i];
+            _state *= 1099511628211ull;
+        }
+        return *this;
+    }
+
+    /*!
+     * \brief   Appends an arithmetic or enumeration value to the hash.
+     */
+    template <typename T>
+    typename std::enable_if<std::is_arithmetic<T>::value || std::is_enum<T>::value, TaskInputHash&>::type add(T value)
+    {
+        return addBytes(&value, sizeof(T));
+    }
+
+    /*!
+     * \brief   Appends a string to the hash. The length is hashed as well to keep the sequences of strings unambiguous.
+     */
+    TaskInputHash& add(const std::string& value)
+    {
+        add(static_cast<uint64_t>(value.size()));
+        return addBytes(value.data(), value.size());
+    }
+
+    TaskInputHash& add(const char* value) { return add(std::string(value)); }
+
+    /*!
+     * \brief   Gets the hash value.
+     */
+    uint64_t value() const { return _state; }
+
+    /*!
+     * \brief   Gets the hash value formatted as a 16-digit hexadecimal string.
+     */
+    std::string hexDigest() const
+    {
+        char buffer[17];
+        std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(_state));
+        return buffer;
+    }
+
+private:
+    uint64_t _state = 14695981039346656037ull;
+};
+
+}
+}
@@ -0,0 +1,248 @@
+#include "TaskProfiler.h"
+#include "AsyncTask.h"
+
+#include <map>
+#include <sstream>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+
+namespace crimson {
+namespace async {
+
+    namespace {
+        double secondsBetween(TaskProfileRecord::Clock::time_point from, TaskProfileRecord::Clock::time_point to)
+        {
+            return std::chrono::duration_cast<std::chrono::duration<double>>(to - from).count();
+        }
+
+        std::string escapeJson(const std::string& s)
+        {
+            std::string result;
+            result.reserve(s.size());
+            for (char c : s) {
+                switch (c) {
+                case '"': result += "\\\""; break;
+                case '\\': result += "\\\\"; break;
+                case '\n': result += "\\n"; break;
+                case '\t': result += "\\t"; break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        result += ' ';
+                    }
+                    else {
+                        result += c;
+                    }
+                }
+            }
+            return result;
+        }
+
+        const char* stateName(int state)
+        {
+            switch (state) {
+            case Task::State_Cancelled: return "Cancelled";
+            case Task::State_Failed: return "Failed";
+            case Task::State_Finished: return "Finished";
+            default: return "Unknown";
+            }
+        }
+    }
+
+    double TaskProfileRecord::queueWaitSeconds() const
+    {
+        return queued && started ? secondsBetween(queuedTime, startTime) : 0;
+    }
+
+    double TaskProfileRecord::runSeconds() const
+    {
+        return started && finalState != -1 ? secondsBetween(startTime, endTime) : 0;
+    }
+
+    double TaskProfileRecord::cancellationLatencySeconds() const
+    {
+        return cancelRequested && finalState != -1 ? secondsBetween(cancelRequestTime, endTime) : 0;
+    }
+
+    TaskProfiler::TaskProfiler()
+        : _epoch(TaskProfileRecord::Clock::now())
+    {
+    }
+
+    TaskProfiler& TaskProfiler::getInstance()
+    {
+        static TaskProfiler instance;
+        return instance;
+    }
+
+    void TaskProfiler::setEnabled(bool enabled)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _enabled = enabled;
+    }
+
+    bool TaskProfiler::isEnabled() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _enabled;
+    }
+
+    void TaskProfiler::setMaxRecords(size_t maxRecords)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _maxRecords = maxRecords;
+        while (_records.size() > _maxRecords) {
+            _records.pop_front();
+        }
+    }
+
+    void TaskProfiler::addRecord(const TaskProfileRecord& record)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_enabled || _maxRecords == 0) {
+            return;
+        }
+
+        _records.push_back(record);
+        while (_records.size() > _maxRecords) {
+            _records.pop_front();
+        }
+    }
+
+    std::vector<TaskProfileRecord> TaskProfiler::getRecords() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return std::vector<TaskProfileRecord>(_records.begin(), _records.end());
+    }
+
+    void TaskProfiler::clear()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _records.clear();
+    }
+
+    std::string TaskProfiler::toChromeTrace() const
+    {
+        std::vector<TaskProfileRecord> records = getRecords();
+
+        auto toMicroseconds = [this](TaskProfileRecord::Clock::time_point t) {
+            return static_cast<long long>(std::chrono::duration_cast<std::chrono::microseconds>(t - _epoch).count());
+        };
+
+        // Map the thread ids to small integers; 0 is reserved for the queue wait events
+        std::map<std::thread::id, int> threadIndices;
+        for (const TaskProfileRecord& record : records) {
+            if (record.started && threadIndices.find(record.threadId) == threadIndices.end()) {
+                int index = static_cast<int>(threadIndices.size()) + 1;
+                threadIndices[record.threadId] = index;
+            }
+        }
+
+        std::ostringstream out;
+        out << "{\"traceEvents\":[";
+
+        bool first = true;
+        auto beginEvent = [&out, &first]() {
+            out << (first ? "\n" : ",\n");
+            first = false;
+        };
+
+        beginEvent();
+        out << R"({"name":"thread_name","ph":"M","pid":1,"tid":0,"args":{"name":"Task queue"}})";
+        for (const auto& threadIndexPair : threadIndices) {
+            beginEvent();
+            out << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << threadIndexPair.second
+                << R"(,"args":{"name":"Worker )" << threadIndexPair.second << "\"}}";
+        }
+
+        for (const TaskProfileRecord& record : records) {
+            std::string name = escapeJson(record.name);
+
+            if (record.queued && record.started) {
+                beginEvent();
+                out << R"({"name":")" << name << R"(","cat":"queue","ph":"X","pid":1,"tid":0,"ts":)"
+                    << toMicroseconds(record.queuedTime) << R"(,"dur":)"
+                    << toMicroseconds(record.startTime) - toMicroseconds(record.queuedTime) << "}";
+            }
+
+            if (!record.started) {
+                continue;
+            }
+
+            int tid = threadIndices[record.threadId];
+
+            beginEvent();
+            out << R"({"name":")" << name << R"(","cat":"task","ph":"X","pid":1,"tid":)" << tid
+                << R"(,"ts":)" << toMicroseconds(record.startTime) << R"(,"dur":)"
+                << toMicroseconds(record.endTime) - toMicroseconds(record.startTime) << R"(,"args":{"state":")"
+                << stateName(record.finalState) << R"(","queueWaitMs":)" << record.queueWaitSeconds() * 1000
+                << R"(,"cancellationLatencyMs":)" << record.cancellationLatencySeconds() * 1000 << "}}";
+
+            unsigned int stepsMade = 0;
+            for (const auto& progress : record.progress) {
+                stepsMade += progress.second;
+                beginEvent();
+                out << R"({"name":"progress","cat":"progress","ph":"i","s":"t","pid":1,"tid":)" << tid
+                    << R"(,"ts":)" << toMicroseconds(progress.first) << R"(,"args":{"stepsMade":)" << stepsMade << "}}";
+            }
+
+            if (record.cancelRequested) {
+                beginEvent();
+                out << R"({"name":"cancel requested","cat":"cancel","ph":"i","s":"t","pid":1,"tid":)" << tid
+                    << R"(,"ts":)" << toMicroseconds(record.cancelRequestTime) << "}";
+            }
+        }
+
+        out << "\n]}\n";
+        return out.str();
+    }
+
+    bool TaskProfiler::exportChromeTrace(const std::string& fileName) const
+    {
+        std::ofstream out(fileName);
+        if (!out) {
+            return false;
+        }
+        out << toChromeTrace();
+        return static_cast<bool>(out);
+    }
+
+    std::string TaskProfiler::summary() const
+    {
+        struct Aggregate {
+            size_t count = 0;
+            size_t cancelled = 0;
+            double totalQueueWait = 0, maxQueueWait = 0;
+            double totalRun = 0, maxRun = 0;
+            double totalCancellationLatency = 0, maxCancellationLatency = 0;
+        };
+
+        std::map<std::string, Aggregate> aggregates;
+        for (const TaskProfileRecord& record : getRecords()) {
+            Aggregate& a = aggregates[record.name];
+            ++a.count;
+            a.totalQueueWait += record.queueWaitSeconds();
+            a.maxQueueWait = std::max(a.maxQueueWait, record.queueWaitSeconds());
+            a.totalRun += record.runSeconds();
+            a.maxRun = std::max(a.maxRun, record.runSeconds());
+            if (record.cancelRequested) {
+                ++a.cancelled;
+                a.totalCancellationLatency += record.cancellationLatencySeconds();
+                a.maxCancellationLatency = std::max(a.maxCancellationLatency, record.cancellationLatencySeconds());
+            }
+        }
+
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(3);
+        out << "Task | count | queue wait avg/max (s) | run avg/max (s) | cancelled | cancellation latency avg/max (s)\n";
+        for (const auto& nameAggregatePair : aggregates) {
+            const Aggregate& a = nameAggregatePair.second;
+            out << nameAggregatePair.first << " | " << a.count << " | " << a.totalQueueWait / a.count << "/" << a.maxQueueWait
+                << " | " << a.totalRun / a.count << "/" << a.maxRun << " | " << a.cancelled << " | "
+                << (a.cancelled > 0 ? a.totalCancellationLatency / a.cancelled : 0.0) << "/" << a.maxCancellationLatency << "\n";
+        }
+        return out.str();
+    }
+
+}
+}
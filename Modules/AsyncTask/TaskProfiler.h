@@ -0,0 +1,116 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <chrono>
+#include <thread>
+
+#include "AsyncTaskExports.h"
+
+namespace crimson {
+namespace async {
+
+/*! \brief   Timing information collected during the lifetime of a single task. */
+struct AsyncTask_EXPORT TaskProfileRecord {
+    typedef std::chrono::steady_clock Clock;
+
+    std::string name;                   ///< Task name (description) used for reporting
+    std::thread::id threadId;           ///< The thread which has executed the task
+
+    Clock::time_point queuedTime;       ///< Time when the task has been added to the task manager
+    Clock::time_point startTime;        ///< Time when the task has started running
+    Clock::time_point endTime;          ///< Time when the task has reached a terminal state
+    Clock::time_point cancelRequestTime;///< Time when the cancellation has been requested
+
+    bool queued = false;                ///< Whether queuedTime is valid
+    bool started = false;               ///< Whether startTime is valid
+    bool cancelRequested = false;       ///< Whether cancelRequestTime is valid
+    int finalState = -1;                ///< The terminal Task::State, -1 if the task has not completed
+
+    std::vector<std::pair<Clock::time_point, unsigned int>> progress; ///< Progress reports (time, steps made)
+
+    /*! \brief   Time spent between being queued and starting execution, in seconds. */
+    double queueWaitSeconds() const;
+
+    /*! \brief   Time spent executing the task, in seconds. */
+    double runSeconds() const;
+
+    /*! \brief   Time between the cancellation request and task completion, in seconds. 0 if the task was not cancelled. */
+    double cancellationLatencySeconds() const;
+};
+
+/*!
+ * \brief   Collects the profile records of completed tasks. The records can be exported in the
+ *  Chrome trace-event format (viewable in chrome://tracing) or as an aggregate summary.
+ *
+ *  Profiling is disabled by default.
+ */
+class AsyncTask_EXPORT TaskProfiler {
+public:
+    /*!
+     * \brief   Gets the global profiler instance.
+     */
+    static TaskProfiler& getInstance();
+
+    ///@{
+    /*!
+     * \brief   Enables or disables collection of task profile records.
+     */
+    void setEnabled(bool enabled);
+    bool isEnabled() const;
+    ///@}
+
+    /*!
+     * \brief   Sets the maximum number of records kept. The oldest records are discarded first.
+     */
+    void setMaxRecords(size_t maxRecords);
+
+    /*!
+     * \brief   Adds the record of a completed task. Ignored if profiling is disabled.
+     */
+    void addRecord(const TaskProfileRecord& record);
+
+    /*!
+     * \brief   Gets a copy of all the collected records.
+     */
+    std::vector<TaskProfileRecord> getRecords() const;
+
+    /*!
+     * \brief   Removes all the collected records.
+     */
+    void clear();
+
+    /*!
+     * \brief   Formats the collected records as Chrome trace-event JSON.
+     */
+    std::string toChromeTrace() const;
+
+    /*!
+     * \brief   Writes the Chrome trace-event JSON to a file.
+     *
+     * \return  false if the file could not be written.
+     */
+    bool exportChromeTrace(const std::string& fileName) const;
+
+    /*!
+     * \brief   Formats an aggregate summary per task name: count, total and maximum queue wait,
+     *  run time and cancellation latency.
+     */
+    std::string summary() const;
+
+private:
+    TaskProfiler();
+    TaskProfiler(const TaskProfiler&) = delete;
+    TaskProfiler& operator=(const TaskProfiler&) = delete;
+
+    mutable std::mutex _mutex;
+    bool _enabled = false;
+    size_t _maxRecords = 10000;
+    std::deque<TaskProfileRecord> _records;
+    TaskProfileRecord::Clock::time_point _epoch;
+};
+
+}
+}
@@ -0,0 +1,114 @@
+#include "TaskResultCache.h"
+
+namespace crimson {
+namespace async {
+
+    TaskResultCache& TaskResultCache::getInstance()
+    {
+        static TaskResultCache instance;
+        return instance;
+    }
+
+    void TaskResultCache::setCapacity(size_t capacity)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _capacity = capacity;
+        while (_entries.size() > _capacity) {
+            _index.erase(_entries.back().first);
+            _entries.pop_back();
+        }
+    }
+
+    size_t TaskResultCache::getCapacity() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _capacity;
+    }
+
+    void TaskResultCache::setDiskStore(const std::shared_ptr<ITaskResultDiskStore>& diskStore)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _diskStore = diskStore;
+    }
+
+    std::shared_ptr<ITaskResultDiskStore> TaskResultCache::getDiskStore() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _diskStore;
+    }
+
+    boost::optional<boost::any> TaskResultCache::find(const std::string& key)
+    {
+        std::shared_ptr<ITaskResultDiskStore> diskStore;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_capacity == 0) {
+                return boost::none;
+            }
+
+            auto iter = _index.find(key);
+            if (iter != _index.end()) {
+                _entries.splice(_entries.begin(), _entries, iter->second);
+                return iter->second->second;
+            }
+
+            diskStore = _diskStore;
+        }
+
+        if (!diskStore) {
+            return boost::none;
+        }
+
+        // Disk access is done without holding the lock
+        boost::optional<boost::any> result = diskStore->load(key);
+        if (result) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _insertInMemory(key, *result);
+        }
+        return result;
+    }
+
+    void TaskResultCache::insert(const std::string& key, const boost::any& result)
+    {
+        std::shared_ptr<ITaskResultDiskStore> diskStore;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_capacity == 0) {
+                return;
+            }
+            _insertInMemory(key, result);
+            diskStore = _diskStore;
+        }
+
+        if (diskStore) {
+            diskStore->save(key, result);
+        }
+    }
+
+    void TaskResultCache::clear()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _entries.clear();
+        _index.clear();
+    }
+
+    void TaskResultCache::_insertInMemory(const std::string& key, const boost::any& result)
+    {
+        auto iter = _index.find(key);
+        if (iter != _index.end()) {
+            iter->second->second = result;
+            _entries.splice(_entries.begin(), _entries, iter->second);
+            return;
+        }
+
+        _entries.emplace_front(key, result);
+        _index[key] = _entries.begin();
+
+        while (_entries.size() > _capacity) {
+            _index.erase(_entries.back().first);
+            _entries.pop_back();
+        }
+    }
+
+}
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <string>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+
+#include <boost/any.hpp>
+#include <boost/optional.hpp>
+
+#include "AsyncTaskExports.h"
+
+namespace crimson {
+namespace async {
+
+/*!
+ * \brief   An interface for the persistent storage of the memoized task results.
+ *
+ *  Implementations decide which result types they are able to store. save() should return false
+ *  for the types it cannot handle.
+ */
+class AsyncTask_EXPORT ITaskResultDiskStore {
+public:
+    virtual ~ITaskResultDiskStore() {}
+
+    /*!
+     * \brief   Saves the result associated with a key.
+     *
+     * \return  true if the result has been stored.
+     */
+    virtual bool save(const std::string& key, const boost::any& result) = 0;
+
+    /*!
+     * \brief   Loads the result associated with a key. Returns an empty optional if no result has been stored.
+     */
+    virtual boost::optional<boost::any> load(const std::string& key) = 0;
+};
+
+/*!
+ * \brief   Thread-safe LRU cache of the task results keyed by the task input hash (see
+ *  TaskWithResult::inputHash()).
+ *
+ *  The cache holds complete copies of the results (e.g. meshes or solid models) and is therefore
+ *  disabled by default: memoization has to be enabled explicitly by setting a non-zero capacity.
+ *  The disk store is optional and is consulted only if the in-memory lookup fails.
+ */
+class AsyncTask_EXPORT TaskResultCache {
+public:
+    /*!
+     * \brief   Gets the global result cache instance.
+     */
+    static TaskResultCache& getInstance();
+
+    ///@{
+    /*!
+     * \brief   Sets the maximum number of results kept in memory. The default capacity of 0 disables memoization.
+     */
+    void setCapacity(size_t capacity);
+    size_t getCapacity() const;
+    ///@}
+
+    ///@{
+    /*!
+     * \brief   Sets the optional persistent store. Pass nullptr to disable the on-disk caching.
+     */
+    void setDiskStore(const std::shared_ptr<ITaskResultDiskStore>& diskStore);
+    std::shared_ptr<ITaskResultDiskStore> getDiskStore() const;
+    ///@}
+
+    /*!
+     * \brief   Finds the result by key. A successful lookup marks the entry as most recently used.
+     */
+    boost::optional<boost::any> find(const std::string& key);
+
+    /*!
+     * \brief   Inserts the result into the cache, evicting the least recently used entries if necessary.
+     */
+    void insert(const std::string& key, const boost::any& result);
+
+    /*!
+     * \brief   Removes all the results from the in-memory cache.
+     */
+    void clear();
+
+private:
+    TaskResultCache() = default;
+    TaskResultCache(const TaskResultCache&) = delete;
+    TaskResultCache& operator=(const TaskResultCache&) = delete;
+
+    void _insertInMemory(const std::string& key, const boost::any& result);
+
+    typedef std::list<std::pair<std::string, boost::any>> EntryList;
+
+    mutable std::mutex _mutex;
+    size_t _capacity = 0;
+    EntryList _entries; ///< Most recently used entries first
+    std::unordered_map<std::string, EntryList::iterator> _index;
+    std::shared_ptr<ITaskResultDiskStore> _diskStore;
+};
+
+}
+}
@@ -0,0 +1,190 @@
+#include <mitkTestingMacros.h>
+#include <mitkTestFixture.h>
+#include <mitkIOUtil.h>
+
+#include <AsyncTaskWithResult.h>
+#include <TaskResultCache.h>
+
+#include <cstdio>
+#include <fstream>
+#include <typeinfo>
+
+namespace {
+
+// Stores integer results as text files, one file per key
+class IntTaskResultDiskStore : public crimson::async::ITaskResultDiskStore {
+public:
+    IntTaskResultDiskStore(const std::string& directory) : _directory(directory) {}
+
+    bool save(const std::string& key, const boost::any& result) override
+    {
+        const int* value = boost::any_cast<int>(&result);
+        if (!value) {
+            return false;
+        }
+        std::ofstream out(_fileName(key));
+        out << *value;
+        return static_cast<bool>(out);
+    }
+
+    boost::optional<boost::any> load(const std::string& key) override
+    {
+        std::ifstream in(_fileName(key));
+        int value;
+        if (!(in >> value)) {
+            return boost::none;
+        }
+        return boost::any(value);
+    }
+
+private:
+    std::string _fileName(const std::string& key) const { return _directory + "/" + key + ".txt"; }
+
+    std::string _directory;
+};
+
+class IntTask : public crimson::async::TaskWithResult<int> {
+public:
+    IntTask(const std::string& hash, int value) : _hash(hash), _value(value) {}
+
+    std::string inputHash() const override { return _hash; }
+    std::string cacheKey() const { return std::string(typeid(*this).name()) + "_" + _hash; }
+
+    int runCount = 0;
+
+protected:
+    std::tuple<State, std::string> runTask() override
+    {
+        ++runCount;
+        setResult(_value);
+        return std::make_tuple(State_Finished, std::string());
+    }
+
+private:
+    std::string _hash;
+    int _value;
+};
+
+}
+
+class TaskResultCacheTestSuite : public mitk::TestFixture
+{
+    CPPUNIT_TEST_SUITE(TaskResultCacheTestSuite);
+    MITK_TEST(testLRUEviction);
+    MITK_TEST(testResultTypeMismatch);
+    MITK_TEST(testZeroCapacity);
+    MITK_TEST(testReloadFromDisk);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() override
+    {
+        auto& cache = crimson::async::TaskResultCache::getInstance();
+        cache.setDiskStore(nullptr);
+        cache.clear();
+        cache.setCapacity(2);
+    }
+
+    void tearDown() override
+    {
+        auto& cache = crimson::async::TaskResultCache::getInstance();
+        cache.setDiskStore(nullptr);
+        cache.setCapacity(0);
+        cache.clear();
+        if (!directory.empty()) {
+            for (const char* key : {"a", "b"}) {
+                std::remove((directory + "/" + key + ".txt").c_str());
+            }
+            std::remove(directory.c_str());
+            directory.clear();
+        }
+    }
+
+    void testLRUEviction()
+    {
+        auto& cache = crimson::async::TaskResultCache::getInstance();
+        cache.insert("a", boost::any(1));
+        cache.insert("b", boost::any(2));
+
+        // Touch "a" so that "b" becomes the least recently used entry
+        CPPUNIT_ASSERT(cache.find("a"));
+        cache.insert("c", boost::any(3));
+
+        CPPUNIT_ASSERT(!cache.find("b"));
+        auto a = cache.find("a");
+        auto c = cache.find("c");
+        CPPUNIT_ASSERT(a && c);
+        CPPUNIT_ASSERT_EQUAL(1, boost::any_cast<int>(*a));
+        CPPUNIT_ASSERT_EQUAL(3, boost::any_cast<int>(*c));
+
+        // Shrinking the cache evicts the least recently used entries
+        cache.setCapacity(1);
+        CPPUNIT_ASSERT(!cache.find("a"));
+        CPPUNIT_ASSERT(cache.find("c"));
+    }
+
+    void testResultTypeMismatch()
+    {
+        IntTask task("mismatch", 42);
+        crimson::async::TaskResultCache::getInstance().insert(task.cacheKey(), boost::any(std::string("not an int")));
+
+        // A result of the wrong type must be ignored and the task executed
+        task.run();
+        CPPUNIT_ASSERT_EQUAL(1, task.runCount);
+        CPPUNIT_ASSERT_EQUAL(crimson::async::Task::State_Finished, task.getState());
+        CPPUNIT_ASSERT(task.getResult());
+        CPPUNIT_ASSERT_EQUAL(42, task.getResult().get());
+
+        // ... and the stale entry replaced with the correct result
+        IntTask secondTask("mismatch", 0);
+        secondTask.run();
+        CPPUNIT_ASSERT_EQUAL(0, secondTask.runCount);
+        CPPUNIT_ASSERT_EQUAL(42, secondTask.getResult().get());
+    }
+
+    void testZeroCapacity()
+    {
+        auto& cache = crimson::async::TaskResultCache::getInstance();
+        cache.insert("a", boost::any(1));
+        cache.setCapacity(0);
+        CPPUNIT_ASSERT(!cache.find("a"));
+
+        cache.insert("b", boost::any(2));
+        CPPUNIT_ASSERT(!cache.find("b"));
+
+        IntTask task("zero", 1);
+        task.run();
+        IntTask secondTask("zero", 1);
+        secondTask.run();
+        CPPUNIT_ASSERT_EQUAL(1, task.runCount);
+        CPPUNIT_ASSERT_EQUAL(1, secondTask.runCount);
+    }
+
+    void testReloadFromDisk()
+    {
+        auto& cache = crimson::async::TaskResultCache::getInstance();
+        directory = mitk::IOUtil::CreateTemporaryDirectory("TaskResultCacheTest-XXXXXX");
+
+        cache.setDiskStore(std::make_shared<IntTaskResultDiskStore>(directory));
+        cache.insert("a", boost::any(1));
+        cache.insert("b", boost::any(2));
+
+        // Simulate an application restart: empty memory and a new store over the same directory
+        cache.clear();
+        cache.setDiskStore(std::make_shared<IntTaskResultDiskStore>(directory));
+
+        auto a = cache.find("a");
+        CPPUNIT_ASSERT(a);
+        CPPUNIT_ASSERT_EQUAL(1, boost::any_cast<int>(*a));
+
+        // The reloaded entry is now served from memory
+        cache.setDiskStore(nullptr);
+        CPPUNIT_ASSERT(cache.find("a"));
+        CPPUNIT_ASSERT(!cache.find("b"));
+    }
+
+private:
+    std::string directory;
+};
+
+MITK_TEST_SUITE_REGISTRATION(TaskResultCache)
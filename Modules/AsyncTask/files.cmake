@@ -1,4 +1,6 @@
 set(CPP_FILES
   AsyncTask.cpp   
   AsyncTaskWithResult.cpp
+  TaskResultCache.cpp
+  TaskProfiler.cpp
 )
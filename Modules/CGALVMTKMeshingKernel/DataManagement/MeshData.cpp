@@ -20,6 +20,8 @@
 
 #include <boost/container/static_vector.hpp>
 
+#include <algorithm>
+#include <array>
 #include <unordered_map>
 #include <unordered_set>
 #include <numeric>
@@ -423,6 +425,65 @@ std::vector<int> MeshData::getAdjacentElements(int elementIndex) const
     return adjacentElements;
 }
 
+void MeshData::getElementAdjacency(std::vector<int>& offsets, std::vector<int>& adjacentElements) const
+{
+    vtkUnstructuredGridBase* ug = getUnstructuredGridRepresentation()->GetVtkUnstructuredGrid();
+
+    // Local face node indices of vtkTetra, in the order of vtkTetra::GetFace()
+    static const int tetraFaces[4][3] = {{0, 1, 3}, {1, 2, 3}, {2, 0, 3}, {0, 2, 1}};
+
+    struct ElementFace {
+        std::array<vtkIdType, 3> sortedNodeIds;
+        int elementFaceIndex; ///< element * 4 + local face index
+        bool operator<(const ElementFace& rhs) const { return sortedNodeIds < rhs.sortedNodeIds; }
+    };
+
+    // Match the element faces by sorting them by their node ids instead of querying the cell links for each face
+    std::vector<ElementFace> elementFaces;
+    elementFaces.reserve(4 * _firstTriangleCellId);
+
+    vtkNew<vtkIdList> pointIds;
+    for (int elementId = 0; elementId < _firstTriangleCellId; ++elementId) {
+        if (ug->GetCellType(elementId) != VTK_TETRA) {
+            continue;
+        }
+
+        ug->GetCellPoints(elementId, pointIds.GetPointer());
+        for (int face = 0; face < 4; ++face) {
+            ElementFace elementFace;
+            for (int i = 0; i < 3; ++i) {
+                elementFace.sortedNodeIds[i] = pointIds->GetId(tetraFaces[face][i]);
+            }
+            std::sort(elementFace.sortedNodeIds.begin(), elementFace.sortedNodeIds.end());
+            elementFace.elementFaceIndex = 4 * elementId + face;
+            elementFaces.push_back(elementFace);
+        }
+    }
+
+    std::sort(elementFaces.begin(), elementFaces.end());
+
+    std::vector<int> neighborAcrossFace(4 * _firstTriangleCellId, -1);
+    for (size_t i = 0; i + 1 < elementFaces.size(); ++i) {
+        if (elementFaces[i].sortedNodeIds == elementFaces[i + 1].sortedNodeIds) {
+            neighborAcrossFace[elementFaces[i].elementFaceIndex] = elementFaces[i + 1].elementFaceIndex / 4;
+            neighborAcrossFace[elementFaces[i + 1].elementFaceIndex] = elementFaces[i].elementFaceIndex / 4;
+        }
+    }
+
+    offsets.assign(1, 0);
+    offsets.reserve(_firstTriangleCellId + 1);
+    adjacentElements.clear();
+    adjacentElements.reserve(4 * _firstTriangleCellId);
+    for (int elementId = 0; elementId < _firstTriangleCellId; ++elementId) {
+        for (int face = 0; face < 4; ++face) {
+            if (neighborAcrossFace[4 * elementId + face] != -1) {
+                adjacentElements.push_back(neighborAcrossFace[4 * elementId + face]);
+            }
+        }
+        offsets.push_back(static_cast<int>(adjacentElements.size()));
+    }
+}
+
 int MeshData::getNNodes() const { return _unstructuredGridRepresentation->GetVtkUnstructuredGrid()->GetNumberOfPoints(); }
 
 int MeshData::getNEdges() const { return _nEdges; }
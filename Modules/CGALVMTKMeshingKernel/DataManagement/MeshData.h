@@ -117,6 +117,14 @@ public:
      */
     std::vector<int> getAdjacentElements(int elementIndex) const;
 
+    /*!
+     * \brief   Gets the adjacent elements of all the elements in compressed sparse row format.
+     *
+     *  The elements adjacent to element i are adjacentElements[offsets[i]] ... adjacentElements[offsets[i + 1] - 1],
+     *  in the same order as returned by getAdjacentElements(i).
+     */
+    void getElementAdjacency(std::vector<int>& offsets, std::vector<int>& adjacentElements) const;
+
 	/*!
 	* \brief   Gets the node id's for a model face with face identifier faceId.
 	*/
@@ -25,6 +25,8 @@
 //#include <DiscreteSolidData.h>
 #include <OCCBRepData.h>
 #include <MeshData.h>
+#include <ISolidModelKernel.h>
+#include <TaskInputHash.h>
 
 #include <TopoDS_Shape.hxx>
 #include <TopoDS_Vertex.hxx>
@@ -91,6 +93,7 @@
 #include <vtkCellLocator.h>
 #include <vtkExtractCells.h>
 #include <vtkFeatureEdges.h>
+#include <vtkCallbackCommand.h>
 
 #include <Wm5ContMinSphere3.h>
 #include <Wm5ApprPlaneFit3.h>
@@ -138,11 +141,84 @@ namespace crimson
 			crimson::async::TaskWithResult<mitk::BaseData::Pointer>::cancel();
 		}
 
+		std::string inputHash() const override
+		{
+			std::string solidHash = ISolidModelKernel::solidContentHash(solid);
+			if (solidHash.empty()) {
+				return std::string();
+			}
+
+			async::TaskInputHash hash;
+			hash.add(solidHash);
+
+			hash.add(params.meshSurfaceOnly).add(params.surfaceOptimizationLevel);
+			hash.add(params.maxRadiusEdgeRatio).add(params.minDihedralAngle).add(params.maxDihedralAngle);
+			hash.add(params.volumeOptimizationLevel);
+			addLocalParametersHash(hash, params.defaultLocalParameters);
+
+			// The vessel names are only used for messages and do not affect the result
+			hash.add(static_cast<uint64_t>(localParams.size()));
+			for (const auto& faceIdParamsPair : localParams) {
+				hash.add(faceIdParamsPair.first.faceType);
+				hash.add(static_cast<uint64_t>(faceIdParamsPair.first.parentSolidIndices.size()));
+				for (const std::string& parentIndex : faceIdParamsPair.first.parentSolidIndices) {
+					hash.add(parentIndex);
+				}
+				addLocalParametersHash(hash, faceIdParamsPair.second);
+			}
+
+			return hash.hexDigest();
+		}
+
 	protected:
+		/*!
+		 * \brief   Makes a VTK algorithm abort its execution when the task is cancelled. Only has effect
+		 *  for the algorithms that check the abort flag, e.g. crimsonTetGenWrapper.
+		 */
+		void abortOnCancellation(vtkAlgorithm* algorithm)
+		{
+			vtkNew<vtkCallbackCommand> abortCommand;
+			abortCommand->SetClientData(this);
+			abortCommand->SetCallback(&MeshingTask::_abortIfCancelling);
+			algorithm->AddObserver(vtkCommand::ProgressEvent, abortCommand.GetPointer());
+		}
+
+		mitk::BaseData::Pointer copyResult(const mitk::BaseData::Pointer& result) const override
+		{
+			if (result.IsNull()) {
+				return result;
+			}
+			return dynamic_cast<mitk::BaseData*>(result->Clone().GetPointer());
+		}
+
+		static void addLocalParametersHash(async::TaskInputHash& hash, const IMeshingKernel::LocalMeshingParameters& localParameters)
+		{
+			auto addOptional = [&hash](const auto& value) {
+				hash.add(static_cast<bool>(value));
+				if (value) {
+					hash.add(*value);
+				}
+			};
+
+			addOptional(localParameters.size);
+			addOptional(localParameters.sizeRelative);
+			hash.add(localParameters.useBoundaryLayers);
+			addOptional(localParameters.thickness);
+			hash.add(localParameters.numSubLayers).add(localParameters.subLayerRatio);
+		}
+
 		mitk::BaseData::Pointer solid;
 		IMeshingKernel::GlobalMeshingParameters params;
 		std::map<FaceIdentifier, IMeshingKernel::LocalMeshingParameters> localParams;
 		std::map<VesselPathAbstractData::VesselPathUIDType, std::string> vesselUIDtoNameMap;
+
+	private:
+		static void _abortIfCancelling(vtkObject* caller, unsigned long, void* clientData, void*)
+		{
+			if (static_cast<MeshingTask*>(clientData)->isCancelling()) {
+				static_cast<vtkAlgorithm*>(caller)->SetAbortExecute(1);
+			}
+		}
 	};
 
 
@@ -296,6 +372,10 @@ namespace crimson
                 // Map to constrain the edges between different face IDs
 
                 for (const FaceEdgeSize& edgeSize : edgeSizes) {
+                    if (isCancelling()) {
+                        return std::make_tuple(State_Cancelled, std::string("Operation cancelled."));
+                    }
+
                     // Map to constrain the edges between different face IDs
                     auto cstmap = mesh.add_property_map<edge_descriptor, bool>("e:cst", false).first;
 
@@ -472,6 +552,7 @@ namespace crimson
                     mesher->SetMinDihedral(params.minDihedralAngle);
                     mesher->SetMaxDihedral(params.maxDihedralAngle);
                     mesher->SetMaxRatio(params.maxRadiusEdgeRatio);
+                    abortOnCancellation(mesher.GetPointer());
                     mesher->Update();
 
                     writeVTU(mesher->GetOutput(), "06 - mesh result");
@@ -487,6 +568,9 @@ namespace crimson
                     cleaner->Update();
 
                     finalResult = runTetGen(cleaner->GetOutput());
+                    if (isCancelling()) {
+                        return std::make_tuple(State_Cancelled, std::string("Operation cancelled."));
+                    }
                     if (finalResult->GetNumberOfCells() == 0) {
                         return std::make_pair(State_Failed, std::string("TetGen failed, see log for details."));
                     }
@@ -793,6 +877,9 @@ namespace crimson
                     meshToSurface->Update();
 
                     vtkSmartPointer<vtkUnstructuredGrid> result = runTetGen(meshToSurface->GetOutput());
+                    if (isCancelling()) {
+                        return std::make_tuple(State_Cancelled, std::string("Operation cancelled."));
+                    }
                     if (result->GetNumberOfCells() == 0) {
                         return std::make_pair(State_Failed, std::string("TetGen failed, see log for details."));
                     }
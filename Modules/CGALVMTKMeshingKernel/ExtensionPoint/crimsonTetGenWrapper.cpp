@@ -92,6 +92,13 @@ crimsonTetGenWrapper::~crimsonTetGenWrapper()
     }
 }
 
+bool crimsonTetGenWrapper::TetGenAbortCallback(void *self)
+{
+  crimsonTetGenWrapper *wrapper = static_cast<crimsonTetGenWrapper*>(self);
+  wrapper->UpdateProgress(wrapper->GetProgress());
+  return wrapper->GetAbortExecute() != 0;
+}
+
 int crimsonTetGenWrapper::RequestData(
   vtkInformation *vtkNotUsed(request),
   vtkInformationVector **inputVector,
@@ -446,13 +453,31 @@ int crimsonTetGenWrapper::RequestData(
   char tetgenOptions[512];
   strcpy(tetgenOptions, this->FullString.empty() ? tetgenOptionString.c_str() : this->FullString.c_str());
   cout<<"TetGen command line options: "<<tetgenOptions<<endl;
+  tetgenbehavior tetgenBehavior;
+  if (!tetgenBehavior.parse_commandline(tetgenOptions))
+    {
+    vtkErrorMacro(<<"Invalid TetGen command line options.");
+    this->LastRunExitStatus = 1;
+    return 1;
+    }
+  tetgenBehavior.abortcallback = &crimsonTetGenWrapper::TetGenAbortCallback;
+  tetgenBehavior.abortcallbackdata = this;
+
+  this->AbortExecute = 0;
   try
     {
-    tetrahedralize(tetgenOptions,&in_tetgenio,&out_tetgenio);
+    tetrahedralize(&tetgenBehavior,&in_tetgenio,&out_tetgenio);
     }
   catch ( ... )
     {
-    vtkErrorMacro(<<"TetGen quit with an exception.");
+    if (this->AbortExecute)
+      {
+      vtkWarningMacro(<<"TetGen meshing aborted.");
+      }
+    else
+      {
+      vtkErrorMacro(<<"TetGen quit with an exception.");
+      }
     this->LastRunExitStatus = 1;
     return 1;
     }
@@ -145,6 +145,10 @@ class crimsonTetGenWrapper : public vtkUnstructuredGridAlgorithm
 
   virtual int RequestData(vtkInformation *, vtkInformationVector **, vtkInformationVector *);
 
+  // Polled by TetGen during meshing. Fires a ProgressEvent so that observers
+  // can request abortion with SetAbortExecute(1).
+  static bool TetGenAbortCallback(void *self);
+
   std::string FullString;
   int PLC;
   int Refine;
@@ -25315,6 +25315,7 @@ void tetgenmesh::repairencsegs(int chkencflag)
     badsubsegs->traversalinit();
     bface = (face *) badsubsegs->traverse();
     while ((bface != NULL) && (steinerleft != 0)) {
+      checkabort(256);
       // Skip a deleleted element.
       if (bface->shver >= 0) {
         // A queued segment may have been deleted (split).
@@ -25815,6 +25816,7 @@ void tetgenmesh::repairencfacs(int chkencflag)
     badsubfacs->traversalinit();
     bface = (face *) badsubfacs->traverse();
     while ((bface != NULL) && (steinerleft != 0)) {
+      checkabort(256);
       // Skip a deleted element.
       if (bface->shver >= 0) {
         // A queued subface may have been deleted (split).
@@ -26307,6 +26309,7 @@ void tetgenmesh::repairbadtets(int chkencflag)
     badtetrahedrons->traversalinit();
     bface = (triface *) badtetrahedrons->traverse();
     while ((bface != NULL) && (steinerleft != 0)) {
+      checkabort(256);
       // Skip a deleted element.
       if (bface->ver >= 0) {
         // A queued tet may have been deleted.
@@ -27886,6 +27889,7 @@ void tetgenmesh::optimizemesh()
     iter = 0;
 
     while (iter < optpasses) {
+      checkabort();
       smtcount = sptcount = remcount = 0l;
       if (b->optscheme & 2) {
         smtcount += improvequalitybysmoothing(&opm);
@@ -32083,6 +32087,22 @@ void tetgenmesh::outmesh2vtk(char* ofilename)
 ////                                                                       ////
 ////                                                                       ////
 
+///////////////////////////////////////////////////////////////////////////////
+//                                                                           //
+// checkabort()    Terminate meshing if the user callback requests it.       //
+//                                                                           //
+///////////////////////////////////////////////////////////////////////////////
+
+void tetgenmesh::checkabort(int interval)
+{
+  if ((b == NULL) || (b->abortcallback == NULL)) return;
+  if (++abortcheckcount < interval) return;
+  abortcheckcount = 0;
+  if (b->abortcallback(b->abortcallbackdata)) {
+    terminatetetgen(this, 10);
+  }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 //                                                                           //
 // tetrahedralize()    The interface for users using TetGen library to       //
@@ -32141,6 +32161,7 @@ void tetrahedralize(tetgenbehavior *b, tetgenio *in, tetgenio *out,
   }
 
   tv[2] = clock();
+  m.checkabort();
 
   if (!b->quiet) {
     if (b->refine) {
@@ -32184,6 +32205,7 @@ void tetrahedralize(tetgenbehavior *b, tetgenio *in, tetgenio *out,
 
 
   tv[3] = clock();
+  m.checkabort();
 
   if ((b->metric) && (m.bgm != NULL)) { // -m
     m.bgm->initializepools();
@@ -32209,6 +32231,7 @@ void tetrahedralize(tetgenbehavior *b, tetgenio *in, tetgenio *out,
   }
 
   tv[4] = clock();
+  m.checkabort();
 
   if (b->plc && !b->refine) { // -p
     if (b->nobisect) { // -Y
@@ -32255,12 +32278,14 @@ void tetrahedralize(tetgenbehavior *b, tetgenio *in, tetgenio *out,
   }
 
   tv[5] = clock();
+  m.checkabort();
 
   if (b->coarsen) { // -R
     m.meshcoarsening();
   }
 
   tv[6] = clock();
+  m.checkabort();
 
   if (!b->quiet) {
     if (b->coarsen) {
@@ -32273,6 +32298,7 @@ void tetrahedralize(tetgenbehavior *b, tetgenio *in, tetgenio *out,
   }
 
   tv[7] = clock();
+  m.checkabort();
 
   if (!b->quiet) {
     if ((b->plc && b->nobisect) || b->coarsen) {
@@ -32287,6 +32313,7 @@ void tetrahedralize(tetgenbehavior *b, tetgenio *in, tetgenio *out,
   }
 
   tv[8] = clock();
+  m.checkabort();
 
   if (!b->quiet) {
     if ((b->plc || b->refine) && b->insertaddpoints) { // -i
@@ -32301,6 +32328,7 @@ void tetrahedralize(tetgenbehavior *b, tetgenio *in, tetgenio *out,
   }
 
   tv[9] = clock();
+  m.checkabort();
 
   if (!b->quiet) {
     if (b->quality) {
@@ -687,6 +687,11 @@ public:
   char hole_mesh_filename[1024];
   int apply_flow_bc;                                               // '-K', 0.
 
+  // Optional callback polled during the long-running meshing phases. Meshing 
+  //   is aborted (by terminatetetgen()) if the callback returns true.
+  bool (*abortcallback)(void *);
+  void *abortcallbackdata;
+
   // The input object of TetGen. They are recognized by either the input 
   //   file extensions or by the specified options. 
   // Currently the following objects are supported:
@@ -800,6 +805,8 @@ public:
     hole_mesh_filename[0] = '\0';
     apply_flow_bc = 0;
 
+    abortcallback = NULL;
+    abortcallbackdata = NULL;
   }
 
 }; // class tetgenbehavior
@@ -2176,6 +2183,7 @@ public:
     hullsize = 0l;
     meshedges = meshhulledges = 0l;
     steinerleft = -1;
+    abortcheckcount = 0;
     dupverts = 0l;
     unuverts = 0l;
     nonregularcount = 0l;
@@ -2281,6 +2289,11 @@ public:
     freememory();
   } // ~tetgenmesh()
 
+  // Poll the abort callback (see tetgenbehavior::abortcallback). 'interval'
+  //   allows calling it only every n-th time from the inner loops.
+  void checkabort(int interval = 1);
+  int abortcheckcount;
+
 };                                               // End of class tetgenmesh.
 
 ///////////////////////////////////////////////////////////////////////////////
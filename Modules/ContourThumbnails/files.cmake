@@ -0,0 +1,9 @@
+file(GLOB_RECURSE H_FILES RELATIVE "${CMAKE_CURRENT_SOURCE_DIR}" "${CMAKE_CURRENT_SOURCE_DIR}/include/*")
+
+set(CPP_FILES
+  ThumbnailGenerator.cpp
+)
+
+set(MOC_H_FILES
+  include/ThumbnailGenerator.h
+)
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <memory>
+
+#include <QObject>
+#include <QImage>
+
+#include <mitkDataNode.h>
+
+#include "ContourThumbnailsExports.h"
+
+//////////////////////////////////////////////////////////////////////////
+// Forward declarations
+
+namespace mitk {
+    class DataStorage;
+}
+//////////////////////////////////////////////////////////////////////////
+
+namespace crimson {
+
+class ThumbnailGeneratorPrivate;
+
+/*! \brief   Thumbnail generator creates the contour thumbnail images asynchronously for use in
+ *  ContourModelingView and PCMRIMappingWidget.
+ *
+ *  The thumbnails do not go through the rendering pipeline. The image is resliced along the contour plane
+ *  and the contour is rasterized on top of it in worker threads.
+ */
+class ContourThumbnails_EXPORT ThumbnailGenerator : public QObject {
+    Q_OBJECT
+public:
+    /*!
+     * \brief   Constructor.
+     *
+     * \param   dataStorage The data storage searched for the background image if none is passed with
+     *  the request. May be nullptr, in which case such thumbnails show the contour only.
+     */
+    ThumbnailGenerator(mitk::DataStorage* dataStorage);
+    ~ThumbnailGenerator();
+
+    /*!
+     * \brief   Add a node to the thumbnail generation queue. The background is the topmost visible image
+     *  in the data storage containing the contour plane.
+     */
+    void requestThumbnail(mitk::DataNode::ConstPointer planarFigureNode, mitk::TimePointType time = 0);
+
+    /*!
+     * \brief   Add a node to the thumbnail generation queue using imageNode as the background. A null
+     *  imageNode results in a thumbnail showing the contour only.
+     */
+    void requestThumbnail(mitk::DataNode::ConstPointer planarFigureNode, mitk::DataNode::ConstPointer imageNode,
+                          mitk::TimePointType time = 0);
+
+    /*!
+     * \brief   Cancel the request to generate thumbnail for a node.
+     */
+    void cancelThumbnailRequest(mitk::DataNode::ConstPointer planarFigureNode);
+
+signals:
+    void thumbnailGenerated(mitk::DataNode::ConstPointer node, QImage thumbnail);
+
+private:
+    ThumbnailGenerator(const ThumbnailGenerator&) = delete;
+    ThumbnailGenerator& operator=(const ThumbnailGenerator&) = delete;
+
+    void _startThumbnailGeneration(mitk::DataNode::ConstPointer planarFigureNode, mitk::DataNode::ConstPointer imageNode,
+                                   mitk::TimePointType time);
+    mitk::DataNode::ConstPointer _findImageNode(const mitk::DataNode* planarFigureNode) const;
+
+    std::unique_ptr<ThumbnailGeneratorPrivate> d;
+
+private slots:
+    void _startPendingThumbnails();
+    void _deliverThumbnails();
+};
+
+} // namespace crimson
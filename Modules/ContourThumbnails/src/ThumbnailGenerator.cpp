@@ -0,0 +1,360 @@
+#include "ThumbnailGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <QTimer>
+#include <QTime>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QPainter>
+#include <QPolygonF>
+
+#include <vtkImageData.h>
+#include <vtkSmartPointer.h>
+
+#include <mitkDataStorage.h>
+#include <mitkImage.h>
+#include <mitkLevelWindow.h>
+#include <mitkPlanarFigure.h>
+#include <mitkNodePredicateDataType.h>
+
+namespace crimson {
+
+namespace {
+
+struct DataNodeConstPointerHasher {
+    std::size_t operator()(mitk::DataNode::ConstPointer ptr) const { return std::hash<const mitk::DataNode*>()(ptr.GetPointer()); }
+};
+
+const int thumbnailSize = 128;
+
+/*! \brief   The data needed to create a thumbnail, copied from the data nodes in the GUI thread. */
+struct ThumbnailRenderInput {
+    mitk::PlaneGeometry::Pointer planeGeometry;
+
+    mitk::Image::ConstPointer image; ///< Keeps imageData alive
+    vtkSmartPointer<vtkImageData> imageData;
+    mitk::BaseGeometry::Pointer imageGeometry;
+    double lowerWindowBound = 0;
+    double upperWindowBound = 1;
+
+    std::vector<mitk::Point2D> contour;
+    bool contourClosed = true;
+    QColor contourColor = Qt::white;
+    float contourLineWidth = 1;
+};
+
+/*!
+ * \brief   Reslices the image along the contour plane and draws the contour. Only uses the input data,
+ *  so it is safe to call from a worker thread.
+ */
+QImage renderThumbnail(const ThumbnailRenderInput& input)
+{
+    QImage img(thumbnailSize, thumbnailSize, QImage::Format_RGB888);
+    img.fill(Qt::black);
+
+    // Fit the plane extent into the thumbnail keeping the aspect ratio
+    double extentX = input.planeGeometry->GetExtentInMM(0);
+    double extentY = input.planeGeometry->GetExtentInMM(1);
+    double mmPerPixel = std::max(extentX, extentY) / thumbnailSize;
+    double originX = (extentX - mmPerPixel * thumbnailSize) / 2;
+    double originY = (extentY - mmPerPixel * thumbnailSize) / 2;
+
+    auto toThumbnail = [&](const mitk::Point2D& p) {
+        return QPointF((p[0] - originX) / mmPerPixel, thumbnailSize - (p[1] - originY) / mmPerPixel);
+    };
+
+    if (input.imageData && mmPerPixel > 0) {
+        // The continuous image index is an affine function of the plane coordinates, so it is enough to
+        // transform the plane origin and the two axis directions once
+        auto planeToIndex = [&](double x, double y) {
+            mitk::Point2D planePoint;
+            planePoint[0] = x;
+            planePoint[1] = y;
+            mitk::Point3D worldPoint, indexPoint;
+            input.planeGeometry->Map(planePoint, worldPoint);
+            input.imageGeometry->WorldToIndex(worldPoint, indexPoint);
+            return indexPoint;
+        };
+
+        mitk::Point3D indexOrigin = planeToIndex(originX + mmPerPixel / 2, originY + mmPerPixel * (thumbnailSize - 0.5));
+        mitk::Vector3D indexStepX = planeToIndex(originX + mmPerPixel * 1.5, originY + mmPerPixel * (thumbnailSize - 0.5)) - indexOrigin;
+        mitk::Vector3D indexStepY = planeToIndex(originX + mmPerPixel / 2, originY + mmPerPixel * (thumbnailSize - 1.5)) - indexOrigin;
+
+        int dims[3];
+        input.imageData->GetDimensions(dims);
+        double windowWidth = std::max(input.upperWindowBound - input.lowerWindowBound, 1e-12);
+
+        for (int j = 0; j < thumbnailSize; ++j) {
+            uchar* scanLine = img.scanLine(j);
+            mitk::Point3D index = indexOrigin + indexStepY * j;
+
+            for (int i = 0; i < thumbnailSize; ++i, index += indexStepX) {
+                int voxel[3];
+                bool inside = true;
+                for (int k = 0; k < 3; ++k) {
+                    voxel[k] = static_cast<int>(std::floor(index[k] + 0.5));
+                    inside = inside && voxel[k] >= 0 && voxel[k] < dims[k];
+                }
+
+                if (!inside) {
+                    continue;
+                }
+
+                double value = input.imageData->GetScalarComponentAsDouble(voxel[0], voxel[1], voxel[2], 0);
+                double gray = std::min(std::max((value - input.lowerWindowBound) / windowWidth, 0.0), 1.0) * 255;
+                std::fill_n(scanLine + 3 * i, 3, static_cast<uchar>(gray + 0.5));
+            }
+        }
+    }
+
+    if (input.contour.size() > 1 && mmPerPixel > 0) {
+        QPolygonF polygon;
+        for (const mitk::Point2D& p : input.contour) {
+            polygon << toThumbnail(p);
+        }
+
+        QPainter painter(&img);
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.setPen(QPen(input.contourColor, input.contourLineWidth));
+        if (input.contourClosed) {
+            painter.drawPolygon(polygon);
+        }
+        else {
+            painter.drawPolyline(polygon);
+        }
+    }
+
+    return img;
+}
+
+} // namespace
+
+class ThumbnailGeneratorPrivate {
+public:
+    mitk::DataStorage* dataStorage;
+    QTimer thumbnailUpdateTimer;
+
+    struct ThumbnailRequestInfo {
+        QTime requestTime;
+        bool findImageNode; ///< Use the topmost image from dataStorage instead of imageNode
+        mitk::DataNode::ConstPointer imageNode;
+        mitk::TimePointType time;
+    };
+
+    std::unordered_map<mitk::DataNode::ConstPointer, ThumbnailRequestInfo, DataNodeConstPointerHasher> thumbnailUpdateMap;
+
+    // Id of the thumbnail generation job currently running for a node
+    unsigned int lastJobId = 0;
+    std::unordered_map<mitk::DataNode::ConstPointer, unsigned int, DataNodeConstPointerHasher> runningJobs;
+
+    struct ThumbnailResult {
+        mitk::DataNode::ConstPointer node;
+        unsigned int jobId;
+        QImage thumbnail;
+        std::shared_ptr<ThumbnailRenderInput> input; ///< Released in the GUI thread
+    };
+
+    std::mutex finishedJobsMutex;
+    std::vector<ThumbnailResult> finishedJobs;
+
+    // Must be the last member - waits for the running jobs on destruction
+    QThreadPool threadPool;
+};
+
+class ThumbnailRenderJob : public QRunnable {
+public:
+    ThumbnailRenderJob(ThumbnailGenerator* generator, ThumbnailGeneratorPrivate* d, ThumbnailGeneratorPrivate::ThumbnailResult result)
+        : _generator(generator)
+        , _d(d)
+        , _result(std::move(result))
+    {
+    }
+
+    void run() override
+    {
+        _result.thumbnail = renderThumbnail(*_result.input);
+        {
+            std::lock_guard<std::mutex> lock(_d->finishedJobsMutex);
+            _d->finishedJobs.push_back(_result);
+
+            // itk::SmartPointer cannot be moved, so drop the references held by the job while the GUI thread
+            // cannot take the result yet. This way the data is always released in the GUI thread.
+            _result.node = nullptr;
+            _result.input.reset();
+        }
+        QMetaObject::invokeMethod(_generator, "_deliverThumbnails", Qt::QueuedConnection);
+    }
+
+private:
+    ThumbnailGenerator* _generator;
+    ThumbnailGeneratorPrivate* _d;
+    ThumbnailGeneratorPrivate::ThumbnailResult _result;
+};
+
+ThumbnailGenerator::ThumbnailGenerator(mitk::DataStorage* dataStorage)
+    : d(new ThumbnailGeneratorPrivate)
+{
+    d->dataStorage = dataStorage;
+
+    d->thumbnailUpdateTimer.start(100);
+    connect(&d->thumbnailUpdateTimer, SIGNAL(timeout()), this, SLOT(_startPendingThumbnails()));
+}
+
+ThumbnailGenerator::~ThumbnailGenerator()
+{
+}
+
+void ThumbnailGenerator::requestThumbnail(mitk::DataNode::ConstPointer planarFigureNode, mitk::TimePointType time)
+{
+    ThumbnailGeneratorPrivate::ThumbnailRequestInfo& request = d->thumbnailUpdateMap[planarFigureNode];
+    request.requestTime.restart();
+    request.findImageNode = true;
+    request.imageNode = nullptr;
+    request.time = time;
+}
+
+void ThumbnailGenerator::requestThumbnail(mitk::DataNode::ConstPointer planarFigureNode, mitk::DataNode::ConstPointer imageNode,
+                                          mitk::TimePointType time)
+{
+    ThumbnailGeneratorPrivate::ThumbnailRequestInfo& request = d->thumbnailUpdateMap[planarFigureNode];
+    request.requestTime.restart();
+    request.findImageNode = false;
+    request.imageNode = imageNode;
+    request.time = time;
+}
+
+void ThumbnailGenerator::cancelThumbnailRequest(mitk::DataNode::ConstPointer planarFigureNode)
+{
+    d->thumbnailUpdateMap.erase(planarFigureNode);
+    d->runningJobs.erase(planarFigureNode);
+}
+
+mitk::DataNode::ConstPointer ThumbnailGenerator::_findImageNode(const mitk::DataNode* planarFigureNode) const
+{
+    if (!d->dataStorage) {
+        return nullptr;
+    }
+
+    // Use the topmost visible image containing the contour plane, as the rendering would
+    auto figure = static_cast<const mitk::PlanarFigure*>(planarFigureNode->GetData());
+    mitk::Point3D planeCenter = figure->GetPlaneGeometry()->GetCenter();
+
+    mitk::DataNode::ConstPointer imageNode;
+    int topLayer = std::numeric_limits<int>::min();
+
+    mitk::DataStorage::SetOfObjects::ConstPointer images = d->dataStorage->GetSubset(mitk::TNodePredicateDataType<mitk::Image>::New());
+    for (const mitk::DataNode::Pointer& node : *images) {
+        if (!node->IsVisible(nullptr) || node->GetProperty("helper object") ||
+            node->GetProperty("lofting.contour_segmentation_image")) {
+            continue;
+        }
+
+        if (!node->GetData()->GetGeometry()->IsInside(planeCenter)) {
+            continue;
+        }
+
+        int layer = 0;
+        node->GetIntProperty("layer", layer);
+        if (imageNode.IsNull() || layer > topLayer) {
+            imageNode = node.GetPointer();
+            topLayer = layer;
+        }
+    }
+
+    return imageNode;
+}
+
+void ThumbnailGenerator::_startThumbnailGeneration(mitk::DataNode::ConstPointer planarFigureNode,
+                                                   mitk::DataNode::ConstPointer imageNode, mitk::TimePointType time)
+{
+    auto figure = static_cast<mitk::PlanarFigure*>(planarFigureNode->GetData());
+    if (!figure || !figure->GetPlaneGeometry()) {
+        return;
+    }
+
+    // Collect the input data in the GUI thread so that the worker does not touch the data nodes
+    auto input = std::make_shared<ThumbnailRenderInput>();
+    input->planeGeometry = figure->GetPlaneGeometry()->Clone();
+
+    if (figure->GetPolyLinesSize() > 0) {
+        input->contour = figure->GetPolyLine(0);
+    }
+    input->contourClosed = figure->IsClosed();
+
+    float color[3];
+    if (planarFigureNode->GetColor(color, nullptr, "planarfigure.default.line.color")) {
+        input->contourColor = QColor::fromRgbF(color[0], color[1], color[2]);
+    }
+    planarFigureNode->GetFloatProperty("planarfigure.line.width", input->contourLineWidth);
+
+    auto image = imageNode ? dynamic_cast<const mitk::Image*>(imageNode->GetData()) : nullptr;
+    if (image && image->IsInitialized()) {
+        int timeStep = image->GetTimeGeometry()->TimePointToTimeStep(time);
+        input->image = image;
+        input->imageData = const_cast<mitk::Image*>(image)->GetVtkImageData(timeStep);
+        input->imageGeometry = image->GetGeometry(timeStep)->Clone();
+
+        mitk::LevelWindow levelWindow;
+        if (imageNode->GetLevelWindow(levelWindow)) {
+            input->lowerWindowBound = levelWindow.GetLowerWindowBound();
+            input->upperWindowBound = levelWindow.GetUpperWindowBound();
+        }
+        else if (input->imageData) {
+            double range[2];
+            input->imageData->GetScalarRange(range);
+            input->lowerWindowBound = range[0];
+            input->upperWindowBound = range[1];
+        }
+    }
+
+    unsigned int jobId = ++d->lastJobId;
+    d->runningJobs[planarFigureNode] = jobId;
+
+    d->threadPool.start(
+        new ThumbnailRenderJob(this, d.get(), ThumbnailGeneratorPrivate::ThumbnailResult{planarFigureNode, jobId, QImage(), input}));
+}
+
+void ThumbnailGenerator::_startPendingThumbnails()
+{
+    for (auto iter = d->thumbnailUpdateMap.begin(); iter != d->thumbnailUpdateMap.end();) {
+        if (iter->second.requestTime.elapsed() > 300) { // Prevent continuous updates when the contour is being modified
+            mitk::DataNode::ConstPointer imageNode =
+                iter->second.findImageNode ? _findImageNode(iter->first) : iter->second.imageNode;
+            _startThumbnailGeneration(iter->first, imageNode, iter->second.time);
+            iter = d->thumbnailUpdateMap.erase(iter);
+        }
+        else {
+            ++iter;
+        }
+    }
+}
+
+void ThumbnailGenerator::_deliverThumbnails()
+{
+    std::vector<ThumbnailGeneratorPrivate::ThumbnailResult> finishedJobs;
+    {
+        std::lock_guard<std::mutex> lock(d->finishedJobsMutex);
+        finishedJobs.swap(d->finishedJobs);
+    }
+
+    for (const ThumbnailGeneratorPrivate::ThumbnailResult& result : finishedJobs) {
+        // Skip the results of cancelled jobs and the jobs superseded by a newer one
+        auto runningJobIter = d->runningJobs.find(result.node);
+        if (runningJobIter == d->runningJobs.end() || runningJobIter->second != result.jobId) {
+            continue;
+        }
+        d->runningJobs.erase(runningJobIter);
+
+        // Notify the listeners
+        emit thumbnailGenerated(result.node, result.thumbnail);
+    }
+}
+
+
+} // namespace crimson
@@ -153,55 +153,47 @@ void PCMRIData::timeInterpolate()
 	_mappedPCMRIvaluesInterpolated.resize(boost::extents[coordinatesMesh.size()][interpolated_t.size()]);
 	_mappedPCMRIvectorsInterpolated.resize(boost::extents[coordinatesMesh.size()][interpolated_t.size()]);
 
-	//do for all points
-	for (int i = 0; i < coordinatesMesh.size(); i++)
-	{
-
-		std::vector<IPCMRIKernel::BsplineGrid1DType::CoefficientType> values; // in this case, velocity
+	///****************************************************************************
+	///                    Initialise the B-spline grid
+	///****************************************************************************
+	/// The grid only depends on the time coordinates, therefore it is shared by all the points
+	double bounds[2 * ndmis]; // bounds of the domain, time in this case
+	bounds[0] = t[0];
+	bounds[1] = t[_parameters._nOriginal - 1];
+	IPCMRIKernel::BsplineGrid1DType::PointType grid_spacing;
+	double bspline_spacing_1D = (bounds[1] - bounds[0]) / (nControlPoints - 1);
+
+	grid_spacing[0] = bspline_spacing_1D; // for example!
+
+	IPCMRIKernel::BsplineGrid1DType::Pointer control_points(new IPCMRIKernel::BsplineGrid1DType(bounds, bsd, grid_spacing, 0)); /// the control point grid does not need border. This grid covers the whole ROI and there is no control_points division.
+	IPCMRIKernel::BsplineGrid1DType::IndexType cyclicDimensions;
+	cyclicDimensions[0] = 1; // first dimension is cyclic
+	control_points->SetCyclicDimensions(cyclicDimensions);
+	control_points->SetCyclicBounds(0, t[0], cycleDuration);
+	control_points->SetDebug(debug);
+	if (debug) std::cout << "\t\tUsing " << threads_to_use << " threads." << std::endl;
+	control_points->SetParallel(parallel_on, threads_to_use);
+	control_points->UpdateCyclicBehaviour();
+
+	double lambda = 0; // no regularization
+
+	// one row of samples per point
+	IPCMRIKernel::BsplineGrid1DType::DenseMatrixType values(coordinatesMesh.size(), _parameters._nOriginal);
+	for (int i = 0; i < coordinatesMesh.size(); i++){
 		for (int j = 0; j < _parameters._nOriginal; j++){
-			values.push_back(_mappedPCMRIvalues[i][j]);
+			values(i, j) = _mappedPCMRIvalues[i][j];
 		}
+	}
 
-		///****************************************************************************
-		///                    Initialise the B-spline grid
-		///****************************************************************************
-		double bounds[2 * ndmis]; // bounds of the domain, time in this case
-		bounds[0] = t[0];
-		bounds[1] = t[_parameters._nOriginal - 1];
-		IPCMRIKernel::BsplineGrid1DType::PointType grid_spacing;
-		double bspline_spacing_1D = (bounds[1] - bounds[0]) / (nControlPoints - 1);
-
-		grid_spacing[0] = bspline_spacing_1D; // for example!
-
-		IPCMRIKernel::BsplineGrid1DType::Pointer control_points(new IPCMRIKernel::BsplineGrid1DType(bounds, bsd, grid_spacing, 0)); /// the control point grid does not need border. This grid covers the whole ROI and there is no control_points division.
-		IPCMRIKernel::BsplineGrid1DType::IndexType cyclicDimensions;
-		cyclicDimensions[0] = 1; // first dimension is cyclic
-		control_points->SetCyclicDimensions(cyclicDimensions);
-		control_points->SetCyclicBounds(0, t[0], cycleDuration);
-		control_points->SetDebug(debug);
-		if (debug) std::cout << "\t\tUsing " << threads_to_use << " threads." << std::endl;
-		control_points->SetParallel(parallel_on, threads_to_use);
-		control_points->UpdateCyclicBehaviour();
-
-		double lambda = 0; // no regularization
-
-
-
-		fit_cyclicBspline1D<IPCMRIKernel::BsplineGrid1DType>(coordinates, values, lambda, control_points);
-
-		/// interpolate ---------------------------------------
-
-		std::vector<IPCMRIKernel::BsplineGrid1DType::CoefficientType>  interpolated_values;
-		interpolated_values = control_points->evaluate(interpolated_t);
-
-		//transform mapped PCMRI values relative to the plane of the model face
-		std::vector<mitk::Point3D> mappedPcmriValues3D;
-		std::vector<mitk::Vector3D> mappedPcmriVectors3D;
-		//std::vector<mitk::Point3D> mappedPcmriValues3D2;
-
+	/// fit and interpolate all the points at once ---------------------------------------
+	IPCMRIKernel::BsplineGrid1DType::DenseMatrixType interpolated_values =
+		fitAndEvaluateCyclicBspline1D<IPCMRIKernel::BsplineGrid1DType>(coordinates, values, lambda, control_points, interpolated_t);
 
+	//transform mapped PCMRI values relative to the plane of the model face
+	for (int i = 0; i < coordinatesMesh.size(); i++)
+	{
 		for (int j = 0; j < interpolated_t.size(); j++){
-			_mappedPCMRIvaluesInterpolated[i][j] = interpolated_values[j][0];
+			_mappedPCMRIvaluesInterpolated[i][j] = interpolated_values(i, j);
 			mitk::Vector3D mappedPcmriVector;
 			mappedPcmriVector[0] = _parameters._normal[0] * _mappedPCMRIvaluesInterpolated[i][j];
 			mappedPcmriVector[1] = _parameters._normal[1] * _mappedPCMRIvaluesInterpolated[i][j];
@@ -209,13 +201,6 @@ void PCMRIData::timeInterpolate()
 			_mappedPCMRIvectorsInterpolated[i][j] = mappedPcmriVector;
 
 		}
-		
-		// ----------------------- print to file ---------------------
-
-		///---------------------------------------------------------------------------//
-		///                       PRINT RESULTS TO FILE                               //
-		///---------------------------------------------------------------------------//
-
 	}
 
 
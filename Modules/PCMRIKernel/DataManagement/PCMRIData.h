@@ -128,6 +128,12 @@ public:
 	*/
 	mitk::Vector3D getSingleMappedPCMRIvector(int pointIndex, int timepointIndex) const { return _mappedPCMRIvectorsInterpolated[pointIndex][timepointIndex]; }
 
+	/*!
+	* \brief   Gets the number of mesh points and timepoints of the time-interpolated mapped vectors.
+	*/
+	int getNumberOfMappedPoints() const { return static_cast<int>(_mappedPCMRIvectorsInterpolated.shape()[0]); }
+	int getNumberOfMappedTimepoints() const { return static_cast<int>(_mappedPCMRIvectorsInterpolated.shape()[1]); }
+
 	/*!
 	* \brief   Gets the timepoints after time interpolation.
 	*/
@@ -195,6 +201,9 @@ private:
 	TimeInterpolationParameters _parameters; //time interpolation settings 
 	VisualizationParameters _parametersVis; //visualization settings 
 
+	//version of the archive the data was loaded from, which decides where PCMRIDataIO reads the mapped values from
+	unsigned int _archiveVersion = 1;
+
 	 template<class Archive>
      friend void serialize(Archive & ar, crimson::PCMRIData& data, const unsigned int version);
      friend class boost::serialization::access;
@@ -218,4 +227,4 @@ private:
 
 } // namespace crimson
 
-BOOST_CLASS_VERSION(crimson::PCMRIData, 0)
\ No newline at end of file
+BOOST_CLASS_VERSION(crimson::PCMRIData, 1)
\ No newline at end of file
@@ -20,6 +20,7 @@
 #include <boost/multi_array.hpp>
 
 #include "IPCMRIKernel.h"
+#include "LinearImageSampler.hxx"
 #include "ISolidModelKernel.h"
 #include "IMeshingKernel.h"
 
@@ -63,6 +64,8 @@
 
 #include <chrono>
 #include <numeric>
+#include <algorithm>
+#include <atomic>
 #include <math.h>
 
 #define _USE_MATH_DEFINES
@@ -149,33 +152,44 @@ namespace crimson
 		}
 	}
 
-	static double calculateParRecScaling(mitk::Image::Pointer pcmriImage)
+	// Calls func(unit, pixels, nPixels) for every 2D slice of the frames from startIndex on, where the unit
+	// numbers the slices consecutively from 0. The slices are spread over all the cores.
+	template <typename Func>
+	static void forEachImageSlice(WholeImageTypeFloat* image, int startIndex, bool firstSliceOnly, Func func)
 	{
-		int numPhases = 0;
-		int phaseEncodingVelocityValue = 0;
-		std::vector<short> phaseValues;
-		double max_ph = 0;
-
-		pcmriImage->GetPropertyList()->GetIntProperty("mapping.venc", phaseEncodingVelocityValue);
-		pcmriImage->GetPropertyList()->GetIntProperty("PAR.MaxNumberOfCardiacPhases", numPhases);
+		const WholeImageTypeFloat::RegionType& region = image->GetBufferedRegion();
+		int firstFrame = std::max(startIndex, static_cast<int>(region.GetIndex()[3]));
+		int nFrames = std::max(0, static_cast<int>(region.GetIndex()[3] + region.GetSize()[3]) - firstFrame);
+		int nSlices = firstSliceOnly ? 1 : static_cast<int>(region.GetSize()[2]);
+		int nUnits = nFrames * nSlices;
+		size_t nPixels = region.GetSize()[0] * region.GetSize()[1];
+
+		forEachBlock(nUnits, threadCount(nUnits), [&](int, int firstUnit, int lastUnit) {
+			for (int unit = firstUnit; unit < lastUnit; ++unit) {
+				WholeImageTypeFloat::IndexType index = region.GetIndex();
+				index[2] += unit % nSlices;
+				index[3] = firstFrame + unit / nSlices;
+				func(unit, image->GetBufferPointer() + image->ComputeOffset(index), nPixels);
+			}
+		});
+	}
 
-		for (int i = 2*numPhases; i < pcmriImage->GetDimensions()[3]; i++)
-		{
-			for (int j = 0; j < pcmriImage->GetDimensions()[0]; j++)
-			{
-				for (int z = 0; z < pcmriImage->GetDimensions()[1]; z++)
-				{
-					itk::Index<3> idx;
-					idx[0] = j;
-					idx[1] = z;
-					idx[2] = 0;
-					phaseValues.push_back(pcmriImage->GetPixelValueByIndex(idx, i));
-					auto pixValue = pcmriImage->GetPixelValueByIndex(idx, i);
-					if (pcmriImage->GetPixelValueByIndex(idx, i)>max_ph)
-						max_ph = pcmriImage->GetPixelValueByIndex(idx, i);
-				}
+	double IPCMRIKernel::calculateParRecScaling(WholeImageTypeFloat::Pointer phaseImage, int startIndex)
+	{
+		// The phase values are only inspected in the first slice
+		const WholeImageTypeFloat::RegionType& region = phaseImage->GetBufferedRegion();
+		int nFrames = std::max(0, static_cast<int>(region.GetIndex()[3] + region.GetSize()[3]) - startIndex);
+		std::vector<float> sliceMaxima(nFrames, 0.0f);
+
+		forEachImageSlice(phaseImage.GetPointer(), startIndex, true, [&sliceMaxima](int unit, const float* pixels, size_t nPixels) {
+			float max_ph = 0;
+			for (size_t i = 0; i < nPixels; ++i) {
+				max_ph = std::max(max_ph, pixels[i]);
 			}
-		}
+			sliceMaxima[unit] = max_ph;
+		});
+
+		double max_ph = sliceMaxima.empty() ? 0 : *std::max_element(sliceMaxima.begin(), sliceMaxima.end());
 
 		int power = ceil(log2(max_ph));
 		double scale = (pow(2, power)) / 2;
@@ -183,6 +197,20 @@ namespace crimson
 		return scale;
 	}
 
+	void IPCMRIKernel::applyLinearScaling(WholeImageTypeFloat::Pointer image, double slope, double intercept)
+	{
+		float a = static_cast<float>(slope);
+		float b = static_cast<float>(intercept);
+
+		forEachImageSlice(image.GetPointer(), 0, false, [a, b](int, float* pixels, size_t nPixels) {
+			for (size_t i = 0; i < nPixels; ++i) {
+				pixels[i] = a * pixels[i] + b;
+			}
+		});
+
+		image->Modified();
+	}
+
 	static double calculateDicomScaling(mitk::Image::Pointer magnitudeImage, mitk::Image::Pointer phaseImage)
 	{
 		auto propList = phaseImage->GetPropertyList();
@@ -212,7 +240,8 @@ namespace crimson
 		MappingTask(const IPCMRIKernel::ContourSet& contoursPCMRI, const mitk::PlanarFigure::Pointer contourModel,
 			const MeshData::Pointer mesh, const FaceIdentifier face,
 			mitk::Point2D pcmriLandmark, mitk::Point2D mraLandmark, WholeImageTypeFloat::Pointer pcmriImage,
-			bool imageFlipped, std::string meshNodeUID, int cardiacFrequency, int startIndex)
+			bool imageFlipped, std::string meshNodeUID, int cardiacFrequency, int startIndex,
+			echo::solvers::PreconditionerType preconditioner, bool warmStart)
 			: contoursPCMRI(contoursPCMRI)
 			, contourModel(contourModel)
 			, mesh(mesh)
@@ -224,6 +253,8 @@ namespace crimson
 			, meshNodeUID(meshNodeUID)
 			, cardiacFrequency(cardiacFrequency)
 			, startIndex(startIndex)
+			, preconditioner(preconditioner)
+			, warmStart(warmStart)
 
 		{
 		}
@@ -241,7 +272,6 @@ namespace crimson
 
 			//setup stuff
 
-			Eigen::setNbThreads(threads_to_use);
 			Eigen::initParallel();
 
 			/// We are assuming that the first point is the reference point for the rotation.
@@ -314,14 +344,35 @@ namespace crimson
 			std::vector<double> _originalFlow(contoursPCMRI.size());
 			std::vector<double> _originalFlow2;
 
+			// The model face area is the same for all the slices
+			double area = mesh->calculateArea(face);
+			auto radius = sqrt(area / 3.14);
+
 			if (isCancelling()) {
 				return std::make_tuple(State_Cancelled, std::string("Operation cancelled."));
 			}
 
 			try {
 
+				/// The solution of the last slice mapped by a worker, used as the starting point of the next one
+				struct SliceSolution {
+					std::vector<unsigned int> kept_nodes;
+					IPCMRIKernel::BsplineGridType::DenseMatrixType coefficients;
+				};
+
+				// The image geometry is the same for all the slices and workers
+				const LinearImageSampler<WholeImageTypeFloat> sampler(pcmriImage);
+
+				// The slices are independent, map them concurrently. Each worker processes a run of consecutive slices,
+				// so that every solve can start from the previous cardiac phase
+				int nSlices = static_cast<int>(contoursPCMRI.size());
+				int nWorkers = threadCount(nSlices);
+
+				// The B-spline grids are only parallelised if the slices are not, to keep the number of threads to the number of cores
+				bool gridParallel = parallel_on && nWorkers == 1;
+
 				//do stuff for one contour at a time
-				for (int slice = 0; slice < contoursPCMRI.size(); ++slice) {
+				auto mapSlice = [&](int slice, SliceSolution& previousSolution) {
 
 					//extract PCMRI boundary points into an array
 					const mitk::PlanarFigure::Pointer figure = contoursPCMRI[slice];
@@ -448,8 +499,8 @@ namespace crimson
 
 					std::vector< IPCMRIKernel::BsplineGridType::PointType> interpolated_contourA, interpolated_contourB;
 
-					interpolateClosedContour<IPCMRIKernel::BsplineGrid1DType, IPCMRIKernel::BsplineGridType>(rotated_centred_coordinatesModel, interpolated_contour_angle, interpolated_contourA);
-					interpolateClosedContour<IPCMRIKernel::BsplineGrid1DType, IPCMRIKernel::BsplineGridType>(centred_coordinatesImage, interpolated_contour_angle, interpolated_contourB);
+					interpolateClosedContour<IPCMRIKernel::BsplineGrid1DType, IPCMRIKernel::BsplineGridType>(rotated_centred_coordinatesModel, interpolated_contour_angle, interpolated_contourA, gridParallel);
+					interpolateClosedContour<IPCMRIKernel::BsplineGrid1DType, IPCMRIKernel::BsplineGridType>(centred_coordinatesImage, interpolated_contour_angle, interpolated_contourB, gridParallel);
 
 
 
@@ -502,7 +553,7 @@ namespace crimson
 
 					IPCMRIKernel::BsplineGridType::Pointer control_points2D(new IPCMRIKernel::BsplineGridType(bounds, bsd, grid_spacing, 0));
 					/// the control point grid does not need border. This grid covers the whole ROI and there is no control_points division.
-					control_points2D->SetParallel(parallel_on, threads_to_use);
+					control_points2D->SetParallel(gridParallel, threads_to_use);
 
 
 					IPCMRIKernel::BsplineGridType::DenseVectorType values_vectorx(IPCMRIKernel::BsplineGridType::ODims*contour_deformation_vectorsx.size(), 1);
@@ -544,14 +595,18 @@ namespace crimson
 
 
 					///---------------------------------------
-					///     Do For X
+					///     Solve for X and Y
 					///---------------------------------------
+					/// Both components share the system matrix, so it is assembled and preconditioned once
+					/// and the two right-hand sides are solved for together
 					{
-
+						IPCMRIKernel::BsplineGridType::DenseMatrixType bxy;
 						{ /// Keep scope to save memory
-							Eigen::setNbThreads(8);
 							A = B.transpose() *B;
 							b = B.transpose()*values_vectorx;
+							bxy.resize(b.rows(), 2);
+							bxy.col(0) = b;
+							bxy.col(1) = B.transpose()*values_vectory;
 						}
 
 						// Regularisation
@@ -563,78 +618,53 @@ namespace crimson
 						if (debug) std::cout << "\tCompute coefficients in this control_points" << std::endl;
 						/// Available additional solvers
 						/// BiCGSTAB + IncompletLUT preconditioner
-						/// SparseQRf
+						/// SparseQR
 						/// SPQR
 						/// PastixLU
 
-						IPCMRIKernel::BsplineGridType::DenseVectorType x;//,x2,x3,x4;
 						echo::solvers::ConfigurationParameter config;
 						config.max_iterations = 10000; /// This number might look huge but we need to get to the desired tolerance
 						config.tol = 1E-06;
 						config.verbose = true;
-						std::string str_solver;
-
-						/// Add some condition like if the matrix is larger than e.g. 5000 x 5000 then use an iterative method such as BiCGSTAB
-						if (debug) std::cout << "\tSolve linear system where A is " << A.rows() << "x" << A.cols() << std::endl;
-						//echo::solvers::solveWithSPQR<BsplineGridType::SparseMatrixType, BsplineGridType::DenseVectorType>(A,b,x,config); str_solver="_SPQR";
-						/// This can happen if there is a region with very densely populated points
-						echo::solvers::solveWithGMRES<IPCMRIKernel::BsplineGridType::SparseMatrixType, IPCMRIKernel::BsplineGridType::DenseVectorType>(A, b, x, config); str_solver = "_GMRES";
-						//echo::solvers::solveWithBiCGSTAB<BsplineGridType::SparseMatrixType, BsplineGridType::DenseVectorType>(A,b,x,config); str_solver="_BiCGSTAB";
-
-						if (debug) std::cout << "\tCoefficients computed, replace control_points values with the calculated coefficients" << std::endl;
-						/// Reorganize x into an array of coefficients, taking into account the reordering
-						control_points2D->setAll<IPCMRIKernel::BsplineGridType::DenseVectorType>(x, kept_nodes);
-
-
-						interpolated_vectorsx = control_points2D->evaluate(rotated_centred_coordinatesOut); //TODO or coordinatesOut_centred?
-						interpolated_vectorsxBorder = control_points2D->evaluate(interpolated_contourA); 
-					}
-
-					///---------------------------------------
-					///     Do For Y
-					///---------------------------------------
-					{
-
-
-
-						{ /// Keep scope to save memory
-							Eigen::setNbThreads(8);
-							A = B.transpose() *B;
-							b = B.transpose()*values_vectory;
+						config.preconditioner = preconditioner;
+						/// One block per row of control points. Rows lose the removed nodes, so the blocks start
+						/// wherever the kept nodes move on to the next row
+						int nodesPerRow = control_points2D->GetSizeWithBorder()[0];
+						config.block_size = nodesPerRow;
+						for (unsigned int i = 0; i < kept_nodes.size(); i++) {
+							if (i == 0 || kept_nodes[i] / nodesPerRow != kept_nodes[i - 1] / nodesPerRow) {
+								config.block_starts.push_back(i * IPCMRIKernel::BsplineGridType::ODims);
+							}
 						}
+						std::string str_solver;
 
-						// Regularisation
-						if (lambda){
-							A = A + lambda / (1 - lambda)*Agrad;/// See notes on p118 of my thesis for an explanation
+						/// Adjacent cardiac phases give nearly the same system, start from the previous phase's
+						/// coefficients when the same nodes were kept
+						IPCMRIKernel::BsplineGridType::DenseMatrixType x;
+						if (warmStart && previousSolution.kept_nodes == kept_nodes) {
+							x = previousSolution.coefficients;
+							config.use_guess = true;
 						}
 
-
-						if (debug) std::cout << "\tCompute coefficients in this control_points" << std::endl;
-						/// Available additional solvers
-						/// BiCGSTAB + IncompletLUT preconditioner
-						/// SparseQR
-						/// SPQR
-						/// PastixLU
-
-						IPCMRIKernel::BsplineGridType::DenseVectorType x;//,x2,x3,x4;
-						echo::solvers::ConfigurationParameter config;
-						config.max_iterations = 10000; /// This number might look huge but we need to get to the desired tolerance
-						config.tol = 1E-06;
-						config.verbose = true;
-						std::string str_solver;
-
 						/// Add some condition like if the matrix is larger than e.g. 5000 x 5000 then use an iterative method such as BiCGSTAB
 						if (debug) std::cout << "\tSolve linear system where A is " << A.rows() << "x" << A.cols() << std::endl;
 						//echo::solvers::solveWithSPQR<BsplineGridType::SparseMatrixType, BsplineGridType::DenseVectorType>(A,b,x,config); str_solver="_SPQR";
 						/// This can happen if there is a region with very densely populated points
-						echo::solvers::solveWithGMRES<IPCMRIKernel::BsplineGridType::SparseMatrixType, IPCMRIKernel::BsplineGridType::DenseVectorType>(A, b, x, config); str_solver = "_GMRES";
+						echo::solvers::solveWithGMRES<IPCMRIKernel::BsplineGridType::SparseMatrixType, IPCMRIKernel::BsplineGridType::DenseMatrixType>(A, bxy, x, config); str_solver = "_GMRES";
 						//echo::solvers::solveWithBiCGSTAB<BsplineGridType::SparseMatrixType, BsplineGridType::DenseVectorType>(A,b,x,config); str_solver="_BiCGSTAB";
 
+						previousSolution.kept_nodes = kept_nodes;
+						previousSolution.coefficients = x;
+
 						if (debug) std::cout << "\tCoefficients computed, replace control_points values with the calculated coefficients" << std::endl;
 						/// Reorganize x into an array of coefficients, taking into account the reordering
-						control_points2D->setAll<IPCMRIKernel::BsplineGridType::DenseVectorType>(x, kept_nodes);
+						IPCMRIKernel::BsplineGridType::DenseVectorType xx = x.col(0), xy = x.col(1);
 
+						control_points2D->setAll<IPCMRIKernel::BsplineGridType::DenseVectorType>(xx, kept_nodes);
+						interpolated_vectorsx = control_points2D->evaluate(rotated_centred_coordinatesOut); //TODO or coordinatesOut_centred?
+						interpolated_vectorsxBorder = control_points2D->evaluate(interpolated_contourA); 
 
+						control_points2D->setAll<IPCMRIKernel::BsplineGridType::DenseVectorType>(xy, kept_nodes);
 						interpolated_vectorsy = control_points2D->evaluate(rotated_centred_coordinatesOut);
 						interpolated_vectorsyBorder = control_points2D->evaluate(interpolated_contourA);
 					}
@@ -646,8 +676,6 @@ namespace crimson
 
 					std::vector<mitk::Point2D> coordinatesDisplaced;
 					std::vector<mitk::Point2D> coordinatesDisplacedBorder;
-					std::vector<mitk::Point2D> coordinatesDisplacedIndex;
-					std::vector<mitk::Point2D> coordinatesDisplacedIndexMapped;
 
 					for (int i = 0; i < interpolated_contourA.size(); i++)
 					{
@@ -661,36 +689,11 @@ namespace crimson
 						pointDisplaced[0] = rotated_centred_coordinatesOut[i][0] + interpolated_vectorsx[i][0] + centroidImage[0];
 						pointDisplaced[1] = rotated_centred_coordinatesOut[i][1] + interpolated_vectorsy[i][0] + centroidImage[1];
 						coordinatesDisplaced.push_back(pointDisplaced);
-						
-						itk::Index<4> idx, idx2;
-						itk::Point<float, 4> phyPoint, phyPoint2;
-						mitk::Point2D pointDisplacedIndex, pointDisplacedIndexMapped;
-						mitk::Point3D pointMapped;
-						phyPoint[0] = pointDisplaced[0];
-						phyPoint[1] = pointDisplaced[1];
-						phyPoint[2] = 0;
-						phyPoint[3] = slice;
-						pcmriImage->TransformPhysicalPointToIndex(phyPoint, idx);
-						pointDisplacedIndex[0] = idx[0];
-						pointDisplacedIndex[1] = idx[1];
-						coordinatesDisplacedIndex.push_back(pointDisplacedIndex);
-
-						plane->Map(pointDisplaced, pointMapped);
-						phyPoint2[0] = pointMapped[0];
-						phyPoint2[1] = pointMapped[1];
-						phyPoint2[2] = pointMapped[2];
-						phyPoint2[3] = slice;
-						pcmriImage->TransformPhysicalPointToIndex(phyPoint2, idx2);
-						pointDisplacedIndexMapped[0] = idx2[0];
-						pointDisplacedIndexMapped[1] = idx2[1];
-						coordinatesDisplacedIndexMapped.push_back(pointDisplacedIndexMapped);
 					}
 
 
 					//calculate the scaling factor for velocities in case of different contour vs model areas - to preserve flow volume
 					auto areaContour = ISolidModelKernel::contourArea(figure);
-					double area = mesh->calculateArea(face);
-					auto radius = sqrt(area / 3.14);
 					auto scalingFactor = areaContour / area;
 
 					MITK_INFO << "Planar figure area " << areaContour;
@@ -698,28 +701,11 @@ namespace crimson
 					MITK_INFO << "Area scaling factor " << scalingFactor;
 
 					//interpolate pre-calculated profile points to mesh warped points
-					typedef itk::LinearInterpolateImageFunction<WholeImageTypeFloat, float>	LinearInterpolatorType;
-					auto interpolator = LinearInterpolatorType::New();
-					interpolator->SetInputImage(pcmriImage);
-
 					for (int i = 0; i < coordinatesDisplaced.size(); i++){
-						itk::ContinuousIndex<float, 4> idx;
-						itk::Point<float, 4> phyPoint;
-						double value;
-						mitk::Point2D point2D;
 						mitk::Point3D point3D;
-						point2D[0] = coordinatesDisplaced[i][0];
-						point2D[1] = coordinatesDisplaced[i][1];
-						planePCMRI->Map(point2D, point3D);
-						
-						phyPoint[0] = point3D[0];
-						phyPoint[1] = point3D[1];
-						phyPoint[2] = point3D[2];
-						phyPoint[3] = slice + startIndex;
-
-						pcmriImage->TransformPhysicalPointToContinuousIndex(phyPoint, idx);
+						planePCMRI->Map(coordinatesDisplaced[i], point3D);
 
-						value = interpolator->EvaluateAtContinuousIndex(idx);
+						double value = sampler.sample(point3D, slice + startIndex);
 						
 						if (imageFlipped)
 							value = -value;
@@ -730,7 +716,30 @@ namespace crimson
 					
 					progressMadeSignal(1);
 
-				}
+				};
+
+				// Eigen's own parallelism is limited so that the total number of threads matches the number of cores.
+				// The Eigen setting is global, so it is restored once the slices are mapped
+				struct EigenThreadsScope {
+					int previousThreads = Eigen::nbThreads();
+					~EigenThreadsScope() { Eigen::setNbThreads(previousThreads); }
+				} eigenThreadsScope;
+				Eigen::setNbThreads(std::max(1, coreCount() / nWorkers));
+
+				// A failing slice stops the other workers, forEachBlock rethrows its exception
+				std::atomic<bool> failed(false);
+				forEachBlock(nSlices, nWorkers, [&](int, int firstSlice, int lastSlice) {
+					SliceSolution previousSolution;
+					for (int slice = firstSlice; slice < lastSlice && !failed && !isCancelling(); ++slice) {
+						try {
+							mapSlice(slice, previousSolution);
+						}
+						catch (...) {
+							failed = true;
+							throw;
+						}
+					}
+				});
 
 				if (isCancelling()) {
 					return std::make_tuple(State_Cancelled, std::string("Operation cancelled."));
@@ -745,9 +754,6 @@ namespace crimson
 				}
 
 
-				double area = mesh->calculateArea(face);
-				auto radius = sqrt(area / 3.14);
-	
 				//setting the surface representation for the PCMRIData to a scaled profile timepoint with maximum flow
 				double max = *std::max_element(flowWaveformAbs.begin(), flowWaveformAbs.end());
 				int maxIndex = std::distance(flowWaveformAbs.begin(), std::max_element(flowWaveformAbs.begin(), flowWaveformAbs.end()));
@@ -812,6 +818,8 @@ namespace crimson
 		const std::string meshNodeUID;
 		const int cardiacFrequency;
 		const int startIndex;
+		const echo::solvers::PreconditionerType preconditioner;
+		const bool warmStart;
 	};
 
 
@@ -819,10 +827,12 @@ namespace crimson
 		IPCMRIKernel::createMapTask(const ContourSet& contoursPCMRI, const mitk::PlanarFigure::Pointer& contourModel,
 		MeshData::Pointer mesh, FaceIdentifier face, mitk::Point2D pcmriLandmark,
 		mitk::Point2D mraLandmark, WholeImageTypeFloat::Pointer pcmriImage, 
-		bool imageFlipped, std::string meshNodeUID, int cardiacFrequency, int startIndex)
+		bool imageFlipped, std::string meshNodeUID, int cardiacFrequency, int startIndex,
+		echo::solvers::PreconditionerType preconditioner, bool warmStart)
 	{
 		return std::static_pointer_cast<crimson::async::TaskWithResult<mitk::BaseData::Pointer>>(std::make_shared<MappingTask>(
-			contoursPCMRI, contourModel, mesh, face, pcmriLandmark, mraLandmark, pcmriImage, imageFlipped, meshNodeUID, cardiacFrequency, startIndex));
+			contoursPCMRI, contourModel, mesh, face, pcmriLandmark, mraLandmark, pcmriImage, imageFlipped, meshNodeUID, cardiacFrequency, startIndex,
+			preconditioner, warmStart));
 	}
 
 	mitk::Surface::Pointer IPCMRIKernel::generateSurfaceRepresentation(std::vector<mitk::Vector3D> timePointPCMRIVectorsInterpolated, mitk::Surface::Pointer meshSurfaceRepresentation)
@@ -4,6 +4,7 @@
 
 #include <vector>
 #include <functional>
+#include <limits>
 #include <mitkBaseData.h>
 #include <mitkPlanarFigure.h>
 
@@ -17,6 +18,7 @@
 /// Internal includes
 #include "BsplineGrid.hxx"
 #include "LinearSolvers.hxx"
+#include "ParallelFor.hxx"
 
 /// Internal includes from namespace echo
 #include "Image_tools.hxx"
@@ -80,6 +82,9 @@ public:
 	* \param   contoursPCMRI              Contours that user marked in the PCMRI image.
 	* \param   contourModel				  Contour of the selected face of the model.
 	* \param   coordinatesOut			  Coordinates of the mesh elements on the selected model face.
+	* \param   preconditioner			  Preconditioner of the GMRES solves of the B-spline coefficients.
+	* \param   warmStart				  Start every solve from the coefficients of the previous cardiac phase
+	*									  mapped by the same worker, when the same grid nodes were kept.
 
 	*/
 	/*static std::shared_ptr<async::TaskWithResult<mitk::BaseData::Pointer>>
@@ -91,7 +96,8 @@ public:
 		createMapTask(const ContourSet& contoursPCMRI, const mitk::PlanarFigure::Pointer& contourModel,
 		const MeshData::Pointer mesh, FaceIdentifier face, mitk::Point2D pcmriLandmark,
 		mitk::Point2D mraLandmark, WholeImageTypeFloat::Pointer pcmriImage,
-		bool imageFlipped, std::string meshNodeUID, int cardiacFrequency, int startIndex);
+		bool imageFlipped, std::string meshNodeUID, int cardiacFrequency, int startIndex,
+		echo::solvers::PreconditionerType preconditioner = echo::solvers::PRECONDITIONER_DEFAULT, bool warmStart = true);
 
 	static std::vector<double> calculateFlowWaveform(boost::multi_array<double, 2> mappedPCMRIvalues,
 		const MeshData::Pointer mesh, const FaceIdentifier face);
@@ -99,6 +105,17 @@ public:
 	static mitk::Surface::Pointer generateSurfaceRepresentation(std::vector<mitk::Vector3D> timePointPCMRIVectorsInterpolated,
 		mitk::Surface::Pointer meshSurfaceRepresentation);
 
+	/*!
+	* \brief   Compute the offset of the phase values of a PAR/REC image: half of the smallest power of two
+	*  above the maximum phase value in the frames from startIndex on.
+	*/
+	static double calculateParRecScaling(WholeImageTypeFloat::Pointer phaseImage, int startIndex);
+
+	/*!
+	* \brief   Rescale the image in place to slope * value + intercept. The frames and slices are processed in parallel.
+	*/
+	static void applyLinearScaling(WholeImageTypeFloat::Pointer image, double slope, double intercept);
+
 };
 
 template <typename TBsplineGridType>
@@ -109,12 +126,7 @@ void fit_cyclicBspline1D(const std::vector<typename TBsplineGridType::PointType
 	bool parallel_on = false;
 	int threads_to_use = 2;
 
-	/****************************************************************************
-	*                               CALCULATE EXTENT                            *
-	****************************************************************************/
-
-	Eigen::setNbThreads(threads_to_use);
-	Eigen::initParallel();
+	/// The number of Eigen threads is set up by the caller, which may be running several fits concurrently
 
 
 
@@ -147,7 +159,6 @@ void fit_cyclicBspline1D(const std::vector<typename TBsplineGridType::PointType
 	typename TBsplineGridType::SparseMatrixType B = control_points->createSamplingMatrix(t, 0.0, kept_nodes, corresponding_nodes);
 
 	{ /// Keep scope to save memory
-		Eigen::setNbThreads(8);
 		A = B.transpose() *B;
 		b = B.transpose()*values_vector;
 	}
@@ -186,10 +197,101 @@ void fit_cyclicBspline1D(const std::vector<typename TBsplineGridType::PointType
 	control_points->setAll(x, kept_nodes);
 }
 
+/*!
+* \brief   Fit a cyclic 1D B-spline to several scalar signals sampled at the same positions and evaluate the fits.
+*
+*  The normal equations only depend on the sample positions, so they are assembled and factorized once and
+*  every signal is solved as an additional right-hand side. If the system is not positive definite (e.g. a
+*  control point has too few samples around it) every signal is solved with GMRES as in fit_cyclicBspline1D.
+*  The signals are processed in blocks in parallel if the control point grid is set to parallel.
+*
+* \param   t                 Sample positions shared by all the signals.
+* \param   values            Sample values, one row per signal and one column per sample position.
+* \param   lambda            Regularisation weight (0 - no regularisation).
+* \param   control_points    Control point grid defining the B-spline basis. The coefficients are not modified.
+* \param   t_eval            Positions to evaluate the fitted B-splines at.
+*
+* \return  The evaluated values, one row per signal and one column per evaluation position.
+*/
+template <typename TBsplineGridType>
+typename TBsplineGridType::DenseMatrixType fitAndEvaluateCyclicBspline1D(const std::vector<typename TBsplineGridType::PointType > &t,
+	const typename TBsplineGridType::DenseMatrixType &values, double lambda, typename TBsplineGridType::Pointer control_points,
+	const std::vector<typename TBsplineGridType::PointType > &t_eval){
+
+	static_assert(TBsplineGridType::ODims == 1, "Only scalar signals are supported");
+
+	typedef typename TBsplineGridType::DenseMatrixType DenseMatrixType;
+	typedef typename TBsplineGridType::DenseVectorType DenseVectorType;
+	typedef typename TBsplineGridType::SparseMatrixType SparseMatrixType;
+
+	std::vector<unsigned int> kept_nodes;
+	std::vector<unsigned int> corresponding_nodes;
+
+	SparseMatrixType B = control_points->createSamplingMatrix(t, 0.0, kept_nodes, corresponding_nodes);
+	/// Sampling at the evaluation positions with the same column layout as B
+	SparseMatrixType E = control_points->createSamplingMatrix(t_eval, -1, kept_nodes, corresponding_nodes);
+
+	SparseMatrixType A = B.transpose() * B;
+	if (lambda)
+	{
+		SparseMatrixType Adiv = control_points->createContinuousDivergenceSamplingMatrix(kept_nodes, corresponding_nodes);
+		A = A + lambda / (1 - lambda)*Adiv;
+	}
+
+	/// The system is as small as the number of control points - factorize it once
+	DenseMatrixType denseA(A);
+	Eigen::LDLT<DenseMatrixType> factorization(denseA);
+	bool factorized = factorization.info() == Eigen::Success && factorization.isPositive();
+	if (factorized)
+	{
+		/// LDLT does not fail on singular matrices, the zero pivots have to be detected separately
+		auto pivots = factorization.vectorD();
+		factorized = pivots.size() > 0 &&
+			pivots.minCoeff() > pivots.maxCoeff() * pivots.size() * std::numeric_limits<typename TBsplineGridType::MatrixElementType>::epsilon();
+	}
+	SparseMatrixType Bt = B.transpose();
+
+	DenseMatrixType result(values.rows(), t_eval.size());
+
+	auto solveBlock = [&](int, int firstRow, int lastRow) {
+		int nRows = lastRow - firstRow;
+		DenseMatrixType rhs = Bt * values.middleRows(firstRow, nRows).transpose();
+		DenseMatrixType coefficients(rhs.rows(), rhs.cols());
+		if (factorized)
+		{
+			coefficients = factorization.solve(rhs);
+		}
+		else
+		{
+			/// Same solver settings as fit_cyclicBspline1D
+			echo::solvers::ConfigurationParameter config;
+			config.max_iterations = 1000;
+			config.tol = 1E-06;
+			config.verbose = true;
+			for (int i = 0; i < nRows; i++)
+			{
+				DenseVectorType b = rhs.col(i);
+				DenseVectorType x;
+				echo::solvers::solveWithGMRES<SparseMatrixType, DenseVectorType>(A, b, x, config);
+				coefficients.col(i) = x;
+			}
+		}
+		DenseMatrixType evaluated = E * coefficients;
+		result.middleRows(firstRow, nRows) = evaluated.transpose();
+	};
+
+	const int nRowsTotal = static_cast<int>(values.rows());
+	const int minRowsPerBlock = factorized ? 1024 : 16;
+	int maxThreads = control_points->GetParallel() ? control_points->GetThreadsToUse() : 1;
+	forEachBlock(nRowsTotal, threadCount(nRowsTotal, minRowsPerBlock, maxThreads), solveBlock);
+
+	return result;
+}
+
 
 template <typename TBsplineGrid1DType, typename TBsplineGrid2DType>
 void interpolateClosedContour(const std::vector< typename TBsplineGrid2DType::PointType> &coordinates, const std::vector< typename TBsplineGrid1DType::PointType> &interpolated_contour_angle,
-	std::vector< typename TBsplineGrid2DType::PointType> &interpolated_contour){
+	std::vector< typename TBsplineGrid2DType::PointType> &interpolated_contour, bool parallel){
 
 	/// parameters: these normally do not need changing
 	double grid_spacing1D = M_PI / 2;
@@ -240,7 +342,7 @@ void interpolateClosedContour(const std::vector< typename TBsplineGrid2DType::Po
 	control_points->SetCyclicDimensions(cyclicDimensions);
 	control_points->SetCyclicBounds(0, -M_PI, M_PI);
 
-	control_points->SetParallel(parallel_on, threads_to_use);
+	control_points->SetParallel(parallel, threads_to_use);
 	control_points->UpdateCyclicBehaviour();
 
 	fit_cyclicBspline1D<TBsplineGrid1DType>(coordinates1D, values, lambda, control_points);
@@ -29,6 +29,7 @@
 #include "String_tools.hxx"
 #include "BSplines.hxx"
 #include "myTimer.hxx"
+#include "ParallelFor.hxx"
 
 /// Matrix
 #include <Eigen/Sparse>
@@ -151,6 +152,10 @@ public:
     {
         return m_is_parallel;
     };
+    int GetThreadsToUse()
+    {
+        return this->m_threads_to_use;
+    };
     void SetParallelOn(int n)
     {
         m_is_parallel=true;
@@ -350,6 +355,7 @@ public:
 
     /**
      * Calculate the underlying function using bspline interpolation at the given points
+     * The points are evaluated in blocks, in parallel if SetParallel is on.
      */
 
     DenseVectorType GetCoefficientVector(std::vector<unsigned int> & nonzero_coefficients, std::vector<unsigned int> & corresponding_nonzero_coefficients, bool getall=false);
@@ -412,6 +418,21 @@ private:
                                  std::vector<TripletType> &triplet_list,DenseVectorType &column_summation,
                                  int derivative_order);
 
+    /**
+     * Fills columns and weights with the nodes whose B-spline is non-zero at the position, and the B-spline values.
+     * If corresponding_columns is not empty, the nodes are mapped through it and the removed ones are skipped.
+     * cyclic_dimension is -1 if no dimension is cyclic.
+     */
+    void m_pointSupport(const PointType &position, const std::vector<IndexType> &gridpos,
+                        const std::vector<unsigned int> &corresponding_columns, int cyclic_dimension,
+                        std::vector<unsigned int> &columns, std::vector<MatrixElementType> &weights);
+
+    /// Number of blocks the n points are split into by crimson::forEachBlock
+    int m_numberOfBlocks(unsigned int n)
+    {
+        return crimson::threadCount(n, 1, m_is_parallel ? this->m_threads_to_use : 1);
+    };
+
 
 
 
@@ -1793,23 +1814,9 @@ void BsplineGrid<VALUETYPE,InputDimension,OutputDimension>::m_fill_BMatrix_tripl
             //                m_coutmutex.unlock();
             //            }
             if (kept_nodes.size()){
-                /// If the current column is in the kept_nodes array I continue, otherwise I ignore it.
-                bool ignore_column=true;
-                //for( int idx=0; idx<kept_nodes.size(); idx+=OutputDimension) {
-                for( int idx=0; idx<kept_nodes.size(); idx++) {
-                    if (current_column==kept_nodes[idx] ){
-                        ignore_column = false;
-                        current_column = corresponding_columns[current_column];
-                        if (current_column == OUT_OF_PATCH){
-                            m_coutmutex.lock();
-                            std::cout << "BsplineGrid::m_fill_BMatrix_triplets - Something went wrong. There were removed nodes, and when trying to calculate the corresponding node, the result was -1."<<std::endl;
-                            m_coutmutex.unlock();
-                            exit(-1);
-                        }
-                        break;
-                    }
-                }
-                if (ignore_column){
+                /// corresponding_columns holds the column of every kept node, and OUT_OF_PATCH for the removed ones
+                current_column = corresponding_columns[current_column];
+                if (current_column == OUT_OF_PATCH){
                     continue;
                 }
             }
@@ -1902,22 +1909,9 @@ void BsplineGrid<VALUETYPE,InputDimension,OutputDimension>::m_fill_BMatrix_tripl
             }
 
             if (kept_nodes.size()){
-                /// If the current column is in the kept_nodes array I continue, otherwise I ignore it.
-                bool ignore_column=true;
-                for( int idx=0; idx<kept_nodes.size(); idx++) {
-                    if (current_column==kept_nodes[idx] ){
-                        ignore_column = false;
-                        current_column = corresponding_columns[current_column];
-                        if (current_column == OUT_OF_PATCH){
-                            m_coutmutex.lock();
-                            std::cout << "BsplineGrid::m_fill_BMatrix_triplets_cycliT - Something went wrong. There were removed nodes, and when trying to calculate the corresponding node, the result was -1."<<std::endl;
-                            m_coutmutex.unlock();
-                            exit(-1);
-                        }
-                        break;
-                    }
-                }
-                if (ignore_column){
+                /// corresponding_columns holds the column of every kept node, and OUT_OF_PATCH for the removed ones
+                current_column = corresponding_columns[current_column];
+                if (current_column == OUT_OF_PATCH){
                     continue;
                 }
             }
@@ -1960,6 +1954,66 @@ void BsplineGrid<VALUETYPE,InputDimension,OutputDimension>::m_fill_BMatrix_tripl
 
 
 
+template <class VALUETYPE, unsigned int InputDimension, unsigned int OutputDimension>
+void BsplineGrid<VALUETYPE,InputDimension,OutputDimension>::m_pointSupport(const PointType &position, const std::vector<IndexType> &gridpos,
+                                                                           const std::vector<unsigned int> &corresponding_columns, int cyclic_dimension,
+                                                                           std::vector<unsigned int> &columns, std::vector<MatrixElementType> &weights){
+
+    int m= 0-std::ceil((double) this->m_bsd / 2);
+    int n_options = std::floor( (double) this->m_bsd / 2)-m+1;
+
+    columns.clear();
+    weights.clear();
+
+    ContinuousIndexType p = this->GetContinuousIndex(position);
+    if (cyclic_dimension>=0){
+        p[cyclic_dimension] = std::fmod(std::fmod(p[cyclic_dimension],this->m_size_parent[cyclic_dimension])+this->m_size_parent[cyclic_dimension],this->m_size_parent[cyclic_dimension]);
+    }
+    IndexType p_floor = p.floor();
+
+    /// The B-spline is a tensor product, so each of its 1D factors is computed once per dimension and offset
+    std::vector<MatrixElementType> weights_1D(InputDimension*n_options);
+    for (int i=0; i<InputDimension; i++)
+    {
+        for (int j=0; j<n_options; j++)
+        {
+            weights_1D[i*n_options+j] = echo::Bspline(this->m_bsd, p[i]-(p_floor[i]-(m+j)));
+        }
+    }
+
+    IndexType associated_grid_node;
+    for (int node=0; node<gridpos.size(); node++)
+    {
+        MatrixElementType current_value = 1;
+        for (int i=0; i<InputDimension; i++)
+        {
+            associated_grid_node[i] = p_floor[i]-gridpos[node][i];
+            current_value *= weights_1D[i*n_options+gridpos[node][i]-m];
+        }
+        if (current_value<=0)
+            continue;
+
+        if (cyclic_dimension>=0){
+            /// True modulus, not the remainder, as the index can be negative
+            associated_grid_node[cyclic_dimension] = ((associated_grid_node[cyclic_dimension]%this->m_size_parent[cyclic_dimension])+this->m_size_parent[cyclic_dimension]) % this->m_size_parent[cyclic_dimension];
+        }
+
+        unsigned int current_column = this->nd_to_oned_index(associated_grid_node);
+        if (current_column==OUT_OF_PATCH)
+            continue;
+
+        if (corresponding_columns.size()){
+            current_column = corresponding_columns[current_column];
+            if (current_column==OUT_OF_PATCH)
+                continue;
+        }
+
+        columns.push_back(current_column);
+        weights.push_back(current_value);
+    }
+}
+
+
 template <class VALUETYPE, unsigned int InputDimension, unsigned int OutputDimension>
 void  BsplineGrid<VALUETYPE,InputDimension,OutputDimension>::GetBorderBounds(double *bounds)
 {
@@ -2396,17 +2450,10 @@ BsplineGrid<VALUETYPE,InputDimension,OutputDimension>::GetCoefficientVector(std:
 template <class VALUETYPE, unsigned int InputDimension, unsigned int OutputDimension>
 std::vector<typename BsplineGrid<VALUETYPE,InputDimension,OutputDimension>::CoefficientType> BsplineGrid<VALUETYPE,InputDimension,OutputDimension>::evaluate(const std::vector<PointType> &pointList)
 {
-    /// Build the sampling  matrix
-    double NZ_COEFFICIENTS =-1; /// Use only the coefficients given by kept_nodes or all coefficients if kept_nodes is empty
-
-    /// Build the coefficient vector
     myTimer t;
 
     std::vector<CoefficientType> data_list(pointList.size());
 
-    //std::string filename("/media/AGOMEZ_KCL_2/data/patients/patient-CAS_17_07Jan2013_DICOM/tmp/B_calculate.txt");
-    //echo::Eigen::writeMatrixToFile<SparseMatrixType>(B, filename);
-
     /// Calculate the coefficient vector
 
     std::vector<unsigned int> nonzero_coefficients(0);
@@ -2418,81 +2465,39 @@ std::vector<typename BsplineGrid<VALUETYPE,InputDimension,OutputDimension>::Coef
         return data_list;
     }
 
-    /// Split into blocks to preserve memory
-
-    double B_TO_MB = 1.0/1024.0/1024.0;
-    double GB_TO_MB = 1024.0;
-    double navailable_bytes;
-    if (this->m_max_memory<0){
-        unsigned long int navailable_bytes_ = echo::getAvailableSystemMemory();
-        navailable_bytes = navailable_bytes_*B_TO_MB;
-    } else{
-        navailable_bytes = this->m_max_memory*GB_TO_MB;
-    }
-
-    /// Calculate approximately how much memory will our problem require.
-    double bytes_required_B = 1.0*sizeof(MatrixElementType)* pointList.size()*std::pow(this->m_bsd+1,InputDimension)*OutputDimension*B_TO_MB;
-    if (this->m_debug) std::cout << "\t\t\tAvailable memory: "<< navailable_bytes<<" MB, required memory: "<< bytes_required_B<< " MB"<<std::endl;std::cout.flush ();
-    unsigned int  number_of_blocks = std::ceil((double) bytes_required_B/ (double) navailable_bytes)*this->m_threads_to_use;/// +1 to leave some memory just in case
-    unsigned int block_length = std::ceil( (double) pointList.size() / (double) number_of_blocks);
-
-    if (m_debug) std::cout << "\t\t\t\tCreate the sampling matrix in "<< number_of_blocks<< " blocks"<<std::endl;
-    if (m_debug) std::cout.flush ();
     if (m_debug) t.start();
 
+    std::vector<IndexType > gridpos;
+    this->createNeighbourhoodPointers(gridpos); /// This has all the permutations  of the bspline neighborhood
+    int cyclic_dimension = this->m_cyclic_dimensions[InputDimension-1] ? InputDimension-1 : -1;
 
-    /// These are the iterators for the whole list
-    typename std::vector<CoefficientType>::iterator iter2;
-    iter2 = data_list.begin();
-    typename std::vector<PointType>::const_iterator const_iter2;
-    const_iter2 = pointList.begin();
-    for (int bl=0; bl<number_of_blocks; bl++)
-    {
-        unsigned int first = bl*block_length;
-        unsigned int last = std::min((bl+1)*block_length-1, (unsigned int) pointList.size()-1);
-
-        if (last < first){
-            number_of_blocks = bl;
-            break;
-        }
-
-        if (m_debug) std::cout << "\t\t\t\t\tBlock "<< bl+1 <<" of "<< number_of_blocks<< ", the first point is "<<first  <<" and the second is "<<last <<std::endl;
-        if (m_debug) std::cout.flush ();
-
-        std::vector<PointType> current_pointList(last-first+1);
-        typename std::vector<PointType>::iterator iter;
-
-        if (m_debug) std::cout << "\t\t\t\t\t\tThe point list has then "<< current_pointList.size() <<" points"<<std::endl;
-        if (m_debug) std::cout.flush ();
-
-        for (iter = current_pointList.begin(); iter!=current_pointList.end();  ++iter, ++const_iter2){
-            *iter = *const_iter2;
-        }
-
-        SparseMatrixType B = this->createSamplingMatrix(current_pointList, NZ_COEFFICIENTS, nonzero_coefficients,corresponding_nonzero_coefficients);/// Reorder is assumed!
-
-        if (m_debug) std::cout << "\t\t\t\t\t\tThe B matrix has been created of size "<< B.rows()<<" x "<< B.cols()<<std::endl;
-        if (m_debug) std::cout.flush ();
-
-        /// Calculate the values
-        DenseVectorType values = B*coefficients;
+    /// Each point is evaluated straight from the coefficients of the nodes around it, which is the same as B*coefficients
+    /// but without storing the sampling matrix B. The points of a block are consecutive, so are the values written.
+    int nblocks = this->m_numberOfBlocks(pointList.size());
 
-        /// Put them into the result vector
+    crimson::forEachBlock(pointList.size(), nblocks, [&](int, int first, int last){
+        std::vector<unsigned int> columns;
+        std::vector<MatrixElementType> weights;
+        columns.reserve(gridpos.size());
+        weights.reserve(gridpos.size());
 
-        MatrixElementType *eigen_iter2;
-        for (eigen_iter2= values.data();  eigen_iter2<values.data()+values.size();  ++iter2, ++eigen_iter2)
+        for (int i=first; i<last; i++)
         {
-            for (int k=0; k<OutputDimension; ++k, ++eigen_iter2)
+            this->m_pointSupport(pointList[i], gridpos, corresponding_nonzero_coefficients, cyclic_dimension, columns, weights);
+
+            CoefficientType &value = data_list[i];
+            for (unsigned int node=0; node<columns.size(); node++)
             {
-                (*(iter2))[k] = *eigen_iter2;
+                const MatrixElementType *coefficient = coefficients.data()+columns[node]*OutputDimension;
+                for (int k=0; k<OutputDimension; k++)
+                {
+                    value[k] += weights[node]*coefficient[k];
+                }
             }
-            --eigen_iter2;
         }
+    });
 
-        if (m_debug) std::cout << "\t\t\t\t\t\tBlock "<< bl <<" of "<< number_of_blocks<< ", with npoints="<<values.size() <<" done"<<std::endl;
-        if (m_debug) std::cout.flush ();
-    }
-    if (m_debug) std::cout << "\t\t\t\tCreate the sampling matrix in "<< number_of_blocks<< " blocks took " << t.GetSeconds()<<" seconds"<<std::endl;
+    if (m_debug) std::cout << "\t\t\t\tEvaluating "<< pointList.size()<< " points in "<< nblocks<< " blocks took " << t.GetSeconds()<<" seconds"<<std::endl;
     return data_list;
 
 }
@@ -0,0 +1,82 @@
+#ifndef LINEARIMAGESAMPLER_H_
+#define LINEARIMAGESAMPLER_H_
+
+#include <algorithm>
+#include <cmath>
+
+namespace crimson
+{
+
+/**
+* Linear interpolation of a 4D (space + time) itk::Image at physical points of a given frame.
+* The physical-to-index transform and the buffer layout are looked up once per image geometry, and the buffer is
+* read directly for every sample. As in itk::LinearInterpolateImageFunction, the neighbours outside the buffered
+* region are clamped to its border. The image must outlive the sampler and keep its buffer; sample() may be called
+* from several threads at once.
+*/
+template <class ImageType>
+class LinearImageSampler
+{
+public:
+    static const unsigned int Dimension = ImageType::ImageDimension;
+    static_assert(Dimension == 4, "The sampler takes a 3D point and a frame");
+
+    explicit LinearImageSampler(const ImageType* image)
+        : _buffer(image->GetBufferPointer())
+        , _origin(image->GetOrigin())
+        , _physicalPointToIndex(image->GetPhysicalPointToIndex())
+    {
+        const typename ImageType::RegionType& region = image->GetBufferedRegion();
+        for (unsigned int d = 0; d < Dimension; ++d) {
+            _startIndex[d] = region.GetIndex()[d];
+            _endIndex[d] = region.GetIndex()[d] + static_cast<long>(region.GetSize()[d]) - 1;
+            _offsetTable[d] = image->GetOffsetTable()[d];
+        }
+    }
+
+    /// point is any 3D point type with operator[], frame the physical coordinate along the fourth dimension
+    template <class PointType>
+    double sample(const PointType& point, double frame) const
+    {
+        double physicalPoint[Dimension] = { point[0], point[1], point[2], frame };
+
+        long baseIndex[Dimension];
+        double distance[Dimension];
+        for (unsigned int r = 0; r < Dimension; ++r) {
+            double continuousIndex = 0;
+            for (unsigned int c = 0; c < Dimension; ++c) {
+                continuousIndex += _physicalPointToIndex(r, c) * (physicalPoint[c] - _origin[c]);
+            }
+            baseIndex[r] = static_cast<long>(std::floor(continuousIndex));
+            distance[r] = continuousIndex - baseIndex[r];
+        }
+
+        double value = 0;
+        for (unsigned int corner = 0; corner < (1u << Dimension); ++corner) {
+            double weight = 1;
+            long offset = 0;
+            for (unsigned int d = 0; d < Dimension; ++d) {
+                bool upper = (corner >> d) & 1;
+                weight *= upper ? distance[d] : 1 - distance[d];
+                long index = std::min(std::max(baseIndex[d] + (upper ? 1 : 0), _startIndex[d]), _endIndex[d]);
+                offset += (index - _startIndex[d]) * _offsetTable[d];
+            }
+            if (weight != 0) {
+                value += weight * _buffer[offset];
+            }
+        }
+        return value;
+    }
+
+private:
+    const typename ImageType::PixelType* _buffer;
+    typename ImageType::PointType _origin;
+    typename ImageType::DirectionType _physicalPointToIndex;
+    long _startIndex[Dimension];
+    long _endIndex[Dimension];
+    long _offsetTable[Dimension];
+};
+
+}
+
+#endif /* LINEARIMAGESAMPLER_H_ */
@@ -9,6 +9,10 @@
 #include <unsupported/Eigen/IterativeSolvers>
 //#include <Eigen/PaStiXSupport>
 
+#include <algorithm>
+#include <string>
+#include <vector>
+
 using namespace Eigen;
 
 namespace echo
@@ -18,6 +22,18 @@ namespace solvers
 {
 
 
+/**
+* Preconditioners available for the iterative solvers.
+* PRECONDITIONER_DEFAULT keeps the one each solver has always used: diagonal for CG, incomplete LU for BiCGSTAB and GMRES.
+* CG needs a symmetric preconditioner and uses the diagonal one when PRECONDITIONER_ILUT is requested.
+*/
+enum PreconditionerType {
+    PRECONDITIONER_DEFAULT,
+    PRECONDITIONER_DIAGONAL,
+    PRECONDITIONER_BLOCK_JACOBI,
+    PRECONDITIONER_ILUT
+};
+
 class ConfigurationParameter{
 
 public:
@@ -25,11 +41,133 @@ public:
         max_iterations=100;
         tol=1E-06;
         verbose=true;
+        preconditioner=PRECONDITIONER_DEFAULT;
+        block_size=1;
+        use_guess=false;
     }
     ~ConfigurationParameter(){}
     unsigned int max_iterations;
     double tol;
     bool verbose;
+    PreconditionerType preconditioner;
+    unsigned int block_size; /// Size of the diagonal blocks of PRECONDITIONER_BLOCK_JACOBI
+    std::vector<unsigned int> block_starts; /// First row of each diagonal block of PRECONDITIONER_BLOCK_JACOBI, overrides block_size if not empty
+    bool use_guess; /// Start from the value of x if it has the size of b, e.g. the solution of a similar system
+};
+
+/**
+* Block-Jacobi preconditioner for the Eigen iterative solvers.
+* The matrix is split into diagonal blocks of consecutive rows and columns and each block is inverted.
+* The blocks either have a fixed size, the last one possibly smaller, or start at the given rows; a block size of 1
+* is the usual Jacobi (diagonal) preconditioner.
+* The blocks must be set through the solver's preconditioner() before calling compute().
+*/
+template <typename _Scalar>
+class BlockJacobiPreconditioner
+{
+    typedef Matrix<_Scalar, Dynamic, Dynamic> BlockType;
+    typedef Matrix<_Scalar, Dynamic, 1> VectorType;
+
+public:
+    enum {
+        ColsAtCompileTime = Dynamic,
+        MaxColsAtCompileTime = Dynamic
+    };
+
+    BlockJacobiPreconditioner() : m_block_size(1), m_size(0) {}
+
+    template <typename MatType>
+    explicit BlockJacobiPreconditioner(const MatType &mat) : m_block_size(1), m_size(0)
+    {
+        compute(mat);
+    }
+
+    void setBlockSize(unsigned int block_size) { m_block_size = std::max(1, (int) block_size); m_block_starts.clear(); }
+
+    /// block_starts holds the first row of every block in increasing order, the first block always starts at row 0
+    void setBlockStarts(const std::vector<unsigned int> &block_starts) { m_block_starts = block_starts; }
+
+    int rows() const { return m_size; }
+    int cols() const { return m_size; }
+
+    template <typename MatType>
+    BlockJacobiPreconditioner &analyzePattern(const MatType &) { return *this; }
+
+    template <typename MatType>
+    BlockJacobiPreconditioner &factorize(const MatType &mat)
+    {
+        m_size = mat.cols();
+        m_first.assign(1, 0);
+        if (m_block_starts.size()){
+            for (int i=0; i<(int) m_block_starts.size(); i++)
+            {
+                if ((int) m_block_starts[i]>m_first.back() && (int) m_block_starts[i]<m_size)
+                    m_first.push_back(m_block_starts[i]);
+            }
+        } else {
+            for (int first=m_block_size; first<m_size; first+=m_block_size)
+                m_first.push_back(first);
+        }
+        if (m_size==0)
+            m_first.clear();
+        int nblocks = m_first.size();
+        m_inverses.resize(nblocks);
+
+        for (int bl=0; bl<nblocks; bl++)
+        {
+            int first = m_first[bl];
+            int n = (bl+1<nblocks ? m_first[bl+1] : m_size)-first;
+
+            BlockType block = BlockType::Zero(n, n);
+            for (int j=first; j<first+n; j++)
+            {
+                for (typename MatType::InnerIterator it(mat, j); it; ++it)
+                {
+                    if (it.index()>=first && it.index()<first+n)
+                        block(it.index()-first, j-first) = it.value();
+                }
+            }
+
+            FullPivLU<BlockType> lu(block);
+            if (lu.isInvertible()){
+                m_inverses[bl] = lu.inverse();
+            } else {
+                /// Fall back to Jacobi for this block, leaving the empty rows alone
+                m_inverses[bl] = BlockType::Identity(n, n);
+                for (int i=0; i<n; i++)
+                {
+                    if (block(i, i)!=_Scalar(0))
+                        m_inverses[bl](i, i) = _Scalar(1)/block(i, i);
+                }
+            }
+        }
+        return *this;
+    }
+
+    template <typename MatType>
+    BlockJacobiPreconditioner &compute(const MatType &mat) { return factorize(mat); }
+
+    template <typename Rhs>
+    VectorType solve(const Rhs &b) const
+    {
+        VectorType x(b.size());
+        for (int bl=0; bl<(int) m_inverses.size(); bl++)
+        {
+            int first = m_first[bl];
+            int n = m_inverses[bl].rows();
+            x.segment(first, n) = m_inverses[bl]*b.segment(first, n);
+        }
+        return x;
+    }
+
+    ComputationInfo info() { return Success; }
+
+private:
+    int m_block_size;
+    std::vector<unsigned int> m_block_starts;
+    int m_size;
+    std::vector<int> m_first;
+    std::vector<BlockType> m_inverses;
 };
 
 /**
@@ -39,6 +177,12 @@ public:
 *   unsigned int max_iterations [100]
 *   double tol [1E-06]
 *   bool [true]
+*   PreconditionerType preconditioner [PRECONDITIONER_DEFAULT]
+*   unsigned int block_size [1]
+*   std::vector<unsigned int> block_starts [empty]
+*   bool use_guess [false]
+* b and x may also be matrices, in which case each column is solved for with the same preconditioner.
+* PRECONDITIONER_ILUT falls back to the diagonal preconditioner, as CG needs a symmetric one.
 */
 template <class SparseMatrixType, class DenseVectorType>
 void solveWithConjugateGradient(const SparseMatrixType &A, const DenseVectorType &b, DenseVectorType &x, ConfigurationParameter &config);
@@ -72,6 +216,11 @@ void solveWithConjugateGradient(const SparseMatrixType &A, const DenseVectorType
 *   unsigned int max_iterations [100]
 *   double tol [1E-06]
 *   bool [true]
+*   PreconditionerType preconditioner [PRECONDITIONER_DEFAULT]
+*   unsigned int block_size [1]
+*   std::vector<unsigned int> block_starts [empty]
+*   bool use_guess [false]
+* b and x may also be matrices, in which case each column is solved for with the same preconditioner.
 */
 template <class SparseMatrixType, class DenseVectorType>
 void solveWithBiCGSTAB(const SparseMatrixType &A, const DenseVectorType &b, DenseVectorType &x, ConfigurationParameter &config);
@@ -79,10 +228,19 @@ void solveWithBiCGSTAB(const SparseMatrixType &A, const DenseVectorType &b, Dens
 /**
  * This implementation of GMRES is provided *as is* by Eigen, with no support planned.
  * Documentation here http://eigen.tuxfamily.org/dox/unsupported/classEigen_1_1GMRES.html
+ * The configuration is as for solveWithBiCGSTAB.
  */
 template <class SparseMatrixType, class DenseVectorType>
 void solveWithGMRES(const SparseMatrixType &A, const DenseVectorType &b, DenseVectorType &x, ConfigurationParameter &config);
 
+namespace internal
+{
+template <class SolverType, class SparseMatrixType, class DenseVectorType>
+void solveWith(SolverType &solver, const std::string &name, const SparseMatrixType &A, const DenseVectorType &b, DenseVectorType &x, ConfigurationParameter &config);
+template <typename Scalar>
+void setBlocks(BlockJacobiPreconditioner<Scalar> &preconditioner, const ConfigurationParameter &config);
+}
+
 }
 
 
@@ -94,27 +252,64 @@ void solveWithGMRES(const SparseMatrixType &A, const DenseVectorType &b, DenseVe
 /// 				         IMPLEMENTATION          				    ///
 /// --------------------------------------------------------------------///
 
-template <class SparseMatrixType, class DenseVectorType>
-void echo::solvers::solveWithConjugateGradient(const SparseMatrixType &A, const DenseVectorType &b, DenseVectorType &x, ConfigurationParameter &config)
+template <class SolverType, class SparseMatrixType, class DenseVectorType>
+void echo::solvers::internal::solveWith(SolverType &solver, const std::string &name, const SparseMatrixType &A, const DenseVectorType &b, DenseVectorType &x, ConfigurationParameter &config)
 {
-
-    ConjugateGradient<SparseMatrixType > solver;
     solver.setMaxIterations(config.max_iterations);
     solver.setTolerance(config.tol);
     solver.compute(A);
     if(solver.info()!=Success)
     {
         /// decomposition failed
-        if (config.verbose)          std::cerr << "\t\tERROR: CG decomposition failed with a matrix of size "<< A.rows() <<"x"<<A.cols()<<std::endl;
+        if (config.verbose)          std::cerr << "\t\tERROR: "<< name <<" decomposition failed with a matrix of size "<< A.rows() <<"x"<<A.cols()<<std::endl;
+    }
+    if (config.use_guess && x.rows()==b.rows() && x.cols()==b.cols())
+    {
+        DenseVectorType guess = x;
+        x = solver.solveWithGuess(b, guess);
+    } else {
+        x = solver.solve(b);
     }
-    x = solver.solve(b);
     if(solver.info()!=Success)
     {
         /// solving failed
-        if (config.verbose) std::cerr << "\t\tERROR: CG solver failed with a matrix of size "<< A.rows() <<"x"<<A.cols()<<std::endl;
+        if (config.verbose) std::cerr << "\t\tERROR: "<< name <<" solver failed with a matrix of size "<< A.rows() <<"x"<<A.cols()<<std::endl;
     }
     if (config.verbose) std::cout << "\t\t#iterations:     " << solver.iterations() << std::endl;
     if (config.verbose) std::cout << "\t\testimated error: " << solver.error()      << std::endl;
+}
+
+template <typename Scalar>
+void echo::solvers::internal::setBlocks(BlockJacobiPreconditioner<Scalar> &preconditioner, const ConfigurationParameter &config)
+{
+    preconditioner.setBlockSize(config.block_size);
+    if (config.block_starts.size())
+        preconditioner.setBlockStarts(config.block_starts);
+}
+
+template <class SparseMatrixType, class DenseVectorType>
+void echo::solvers::solveWithConjugateGradient(const SparseMatrixType &A, const DenseVectorType &b, DenseVectorType &x, ConfigurationParameter &config)
+{
+    typedef typename SparseMatrixType::Scalar Scalar;
+
+    switch (config.preconditioner){
+    case PRECONDITIONER_BLOCK_JACOBI:
+    {
+        ConjugateGradient<SparseMatrixType, Lower, BlockJacobiPreconditioner<Scalar> > solver;
+        internal::setBlocks(solver.preconditioner(), config);
+        internal::solveWith(solver, "CG", A, b, x, config);
+        break;
+    }
+    default:
+    {
+        /// The incomplete LU factors are not symmetric, which CG requires, so the diagonal preconditioner is used instead
+        if (config.preconditioner==PRECONDITIONER_ILUT && config.verbose)
+            std::cerr << "\t\tWARNING: CG cannot use the incomplete LU preconditioner, using the diagonal one"<<std::endl;
+        ConjugateGradient<SparseMatrixType > solver;
+        internal::solveWith(solver, "CG", A, b, x, config);
+        break;
+    }
+    }
 
     /// For using solve with guess refer to documentation here: http://eigen.tuxfamily.org/dox-devel/classEigen_1_1ConjugateGradient.html
 }
@@ -174,46 +369,58 @@ void echo::solvers::solveWithSPQR(const SparseMatrixType &A, const DenseVectorTy
 template <class SparseMatrixType, class DenseVectorType>
 void echo::solvers::solveWithBiCGSTAB(const SparseMatrixType &A, const DenseVectorType &b, DenseVectorType &x, ConfigurationParameter &config){
 
-    BiCGSTAB<SparseMatrixType, IncompleteLUT<double> > solver;
-    solver.setMaxIterations(config.max_iterations);
-    solver.setTolerance(config.tol);
-    solver.compute(A);
-    if(solver.info()!=Success)
+    typedef typename SparseMatrixType::Scalar Scalar;
+
+    switch (config.preconditioner){
+    case PRECONDITIONER_DIAGONAL:
     {
-        /// decomposition failed
-        if (config.verbose)          std::cerr << "\t\tERROR: BiCGSTAB decomposition failed with a matrix of size "<< A.rows() <<"x"<<A.cols()<<std::endl;
+        BiCGSTAB<SparseMatrixType, DiagonalPreconditioner<Scalar> > solver;
+        internal::solveWith(solver, "BiCGSTAB", A, b, x, config);
+        break;
     }
-    x = solver.solve(b);
-    if(solver.info()!=Success)
+    case PRECONDITIONER_BLOCK_JACOBI:
     {
-        /// solving failed
-        if (config.verbose) std::cerr << "\t\tERROR: BiCGSTAB solver failed with a matrix of size "<< A.rows() <<"x"<<A.cols() <<std::endl;
+        BiCGSTAB<SparseMatrixType, BlockJacobiPreconditioner<Scalar> > solver;
+        internal::setBlocks(solver.preconditioner(), config);
+        internal::solveWith(solver, "BiCGSTAB", A, b, x, config);
+        break;
+    }
+    default:
+    {
+        BiCGSTAB<SparseMatrixType, IncompleteLUT<double> > solver;
+        internal::solveWith(solver, "BiCGSTAB", A, b, x, config);
+        break;
+    }
     }
-    if (config.verbose) std::cout << "\t\t#iterations:     " << solver.iterations() << std::endl;
-    if (config.verbose) std::cout << "\t\testimated error: " << solver.error()      << std::endl;
 
 }
 
 template <class SparseMatrixType, class DenseVectorType>
 void echo::solvers::solveWithGMRES(const SparseMatrixType &A, const DenseVectorType &b, DenseVectorType &x, ConfigurationParameter &config){
 
-    GMRES<SparseMatrixType, IncompleteLUT<double> > solver;
-    solver.setMaxIterations(config.max_iterations);
-    solver.setTolerance(config.tol);
-    solver.compute(A);
-    if(solver.info()!=Success)
+    typedef typename SparseMatrixType::Scalar Scalar;
+
+    switch (config.preconditioner){
+    case PRECONDITIONER_DIAGONAL:
     {
-        /// decomposition failed
-        if (config.verbose)          std::cerr << "\t\tERROR: GMRES decomposition failed with a matrix of size "<< A.rows() <<"x"<<A.cols()<<std::endl;
+        GMRES<SparseMatrixType, DiagonalPreconditioner<Scalar> > solver;
+        internal::solveWith(solver, "GMRES", A, b, x, config);
+        break;
     }
-    x = solver.solve(b);
-    if(solver.info()!=Success)
+    case PRECONDITIONER_BLOCK_JACOBI:
     {
-        /// solving failed
-        if (config.verbose) std::cerr << "\t\tERROR: GMRES solver failed with a matrix of size "<< A.rows() <<"x"<<A.cols()<<std::endl;
+        GMRES<SparseMatrixType, BlockJacobiPreconditioner<Scalar> > solver;
+        internal::setBlocks(solver.preconditioner(), config);
+        internal::solveWith(solver, "GMRES", A, b, x, config);
+        break;
+    }
+    default:
+    {
+        GMRES<SparseMatrixType, IncompleteLUT<double> > solver;
+        internal::solveWith(solver, "GMRES", A, b, x, config);
+        break;
+    }
     }
-    if (config.verbose) std::cout << "\t\t#iterations:     " << solver.iterations() << std::endl;
-    if (config.verbose) std::cout << "\t\testimated error: " << solver.error()      << std::endl;
 
 }
 #endif /* LINEARSOLVERS_H_*/
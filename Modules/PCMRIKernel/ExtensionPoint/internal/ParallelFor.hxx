@@ -0,0 +1,73 @@
+#ifndef PARALLELFOR_H_
+#define PARALLELFOR_H_
+
+#include <algorithm>
+#include <exception>
+#include <vector>
+
+#include <boost/thread.hpp>
+
+namespace crimson
+{
+
+/**
+* Number of cores available to the process, at least 1.
+*/
+inline int coreCount()
+{
+    return std::max(1, static_cast<int>(boost::thread::hardware_concurrency()));
+}
+
+/**
+* Thread count policy of the PC-MRI kernel: the number of threads to process nUnits independent units of work with.
+* Every thread gets at least minUnitsPerThread units, and there are never more threads than maxThreads or than cores.
+* maxThreads <= 0 means one thread per core, 1 disables the parallelism.
+*/
+inline int threadCount(int nUnits, int minUnitsPerThread = 1, int maxThreads = 0)
+{
+    int limit = maxThreads > 0 ? std::min(maxThreads, coreCount()) : coreCount();
+    return std::max(1, std::min(limit, nUnits / std::max(1, minUnitsPerThread)));
+}
+
+/**
+* Calls func(block, first, last) for nBlocks contiguous blocks [first, last) of [0, n) of nearly equal length, each
+* on its own thread. Block 0 runs on the calling thread. Once all the blocks have finished, the first exception
+* thrown by any of them is rethrown.
+*/
+template <class Func>
+void forEachBlock(int n, int nBlocks, Func func)
+{
+    nBlocks = std::max(1, std::min(nBlocks, n));
+    if (nBlocks == 1) {
+        func(0, 0, n);
+        return;
+    }
+
+    std::vector<std::exception_ptr> exceptions(nBlocks);
+    auto runBlock = [&](int block) {
+        try {
+            func(block, static_cast<int>(static_cast<long long>(block) * n / nBlocks),
+                static_cast<int>(static_cast<long long>(block + 1) * n / nBlocks));
+        }
+        catch (...) {
+            exceptions[block] = std::current_exception();
+        }
+    };
+
+    boost::thread_group threads;
+    for (int block = 1; block < nBlocks; ++block) {
+        threads.create_thread([&runBlock, block]() { runBlock(block); });
+    }
+    runBlock(0);
+    threads.join_all();
+
+    for (const std::exception_ptr& exception : exceptions) {
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+    }
+}
+
+}
+
+#endif
@@ -28,9 +28,15 @@ namespace crimson {
     }
 
     template<class Archive>
-    void serialize(Archive & ar, crimson::PCMRIData& pcmriData, const unsigned int /*version*/)
+    void serialize(Archive & ar, crimson::PCMRIData& pcmriData, const unsigned int version)
     {
-        ar & BOOST_SERIALIZATION_NVP(pcmriData._mappedPCMRIvalues);
+        if (Archive::is_loading::value) {
+            pcmriData._archiveVersion = version;
+        }
+        if (version == 0) {
+            // Since version 1 the mapped values are stored in a binary file next to the archive, see PCMRIDataIO
+            ar & BOOST_SERIALIZATION_NVP(pcmriData._mappedPCMRIvalues);
+        }
         ar & BOOST_SERIALIZATION_NVP(pcmriData._meshNodeUID);
         ar & BOOST_SERIALIZATION_NVP(pcmriData._faceIdentifierIndex);
         ar & BOOST_SERIALIZATION_NVP(pcmriData._parameters);
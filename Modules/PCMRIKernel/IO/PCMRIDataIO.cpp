@@ -9,6 +9,7 @@
 #include <boost/serialization/array.hpp>
 
 #include "PCMRIDataIO.h"
+#include "PCMRIMappedValuesIO.h"
 #include <PCMRIDataBoostIO.h>
 
 #include <PCMRIData.h>
@@ -19,7 +20,8 @@
 
 REGISTER_IOUTILDATA_SERIALIZER(PCMRIData,
 	crimson::PCMRIKernelIOMimeTypes::PCMRIDATA_DEFAULT_EXTENSION(),
-	crimson::PCMRIKernelIOMimeTypes::PCMRIDATA_DEFAULT_EXTENSION() + ".vtp"
+	crimson::PCMRIKernelIOMimeTypes::PCMRIDATA_DEFAULT_EXTENSION() + ".vtp",
+	crimson::PCMRIKernelIOMimeTypes::PCMRIDATA_DEFAULT_EXTENSION() + ".values"
     )
 
 namespace crimson {
@@ -53,6 +55,11 @@ std::vector< itk::SmartPointer<mitk::BaseData> > PCMRIDataIO::Read()
     auto& dataRef = *brep;
     inArchive >> BOOST_SERIALIZATION_NVP(dataRef);
 
+    // Version 0 archives hold the mapped values themselves, later ones store them next to the archive
+    if (brep->_archiveVersion >= 1) {
+        readMappedValues(GetLocalFileName() + ".values", brep->_mappedPCMRIvalues);
+    }
+
     // Read polygonal representation
     vtkSmartPointer<vtkXMLPolyDataReader> pdReader = vtkSmartPointer<vtkXMLPolyDataReader>::New();
     pdReader->SetFileName((GetLocalFileName() + ".vtp").c_str());
@@ -86,6 +93,9 @@ void PCMRIDataIO::Write()
     auto& dataRef = *pcmriData;
     outArchive << BOOST_SERIALIZATION_NVP(dataRef);
 
+    //Save mapped values
+    writeMappedValues(GetOutputLocation() + ".values", pcmriData->_mappedPCMRIvalues);
+
     //Save mesh surface polydata
     vtkNew<vtkXMLPolyDataWriter> pdWriter;
     pdWriter->SetDataModeToBinary();
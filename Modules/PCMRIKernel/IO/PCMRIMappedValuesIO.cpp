@@ -0,0 +1,119 @@
+#include "PCMRIMappedValuesIO.h"
+
+#include <mitkExceptionMacro.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+
+namespace crimson {
+
+namespace {
+
+const char mappedValuesMagic[8] = { 'P', 'C', 'M', 'R', 'I', 'V', 'A', 'L' };
+const std::uint32_t mappedValuesVersion = 1;
+const std::uint64_t headerSize = 32;
+
+template <class T>
+void writeBinary(std::ostream& os, const T& value)
+{
+    os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <class T>
+T readBinary(std::istream& is)
+{
+    T value = T();
+    is.read(reinterpret_cast<char*>(&value), sizeof(T));
+    return value;
+}
+
+// Opens the file and checks its header against its length, returning the shape of the values
+void openMappedValues(const std::string& fileName, std::ifstream& is, std::uint64_t& nNodes, std::uint64_t& nTimeSteps)
+{
+    is.open(fileName, std::ios::binary);
+    if (!is) {
+        mitkThrow() << "Cannot open the mapped PC-MRI values file " << fileName;
+    }
+
+    is.seekg(0, std::ios::end);
+    std::uint64_t length = static_cast<std::uint64_t>(is.tellg());
+    is.seekg(0, std::ios::beg);
+
+    char magic[sizeof(mappedValuesMagic)];
+    is.read(magic, sizeof(magic));
+    if (!is || !std::equal(magic, magic + sizeof(magic), mappedValuesMagic)) {
+        mitkThrow() << fileName << " is not a PC-MRI values file";
+    }
+
+    auto version = readBinary<std::uint32_t>(is);
+    if (version > mappedValuesVersion) {
+        mitkThrow() << fileName << " was written by a newer version (" << version << ")";
+    }
+    readBinary<std::uint32_t>(is);
+    nNodes = readBinary<std::uint64_t>(is);
+    nTimeSteps = readBinary<std::uint64_t>(is);
+
+    // Check the size before allocating anything, a corrupt header must not trigger a huge allocation
+    const std::uint64_t maxValues = (std::numeric_limits<std::uint64_t>::max() - headerSize) / sizeof(double);
+    if (!is || (nTimeSteps != 0 && nNodes > maxValues / nTimeSteps) ||
+        headerSize + nNodes * nTimeSteps * sizeof(double) != length) {
+        mitkThrow() << fileName << " is truncated or corrupt";
+    }
+}
+
+}
+
+void writeMappedValues(const std::string& fileName, const boost::multi_array<double, 2>& values)
+{
+    std::ofstream os(fileName, std::ios::binary);
+
+    os.write(mappedValuesMagic, sizeof(mappedValuesMagic));
+    writeBinary<std::uint32_t>(os, mappedValuesVersion);
+    writeBinary<std::uint32_t>(os, 0);
+    writeBinary<std::uint64_t>(os, values.shape()[0]);
+    writeBinary<std::uint64_t>(os, values.shape()[1]);
+    os.write(reinterpret_cast<const char*>(values.data()), values.num_elements() * sizeof(double));
+
+    if (!os) {
+        mitkThrow() << "Failed to write the mapped PC-MRI values to " << fileName;
+    }
+}
+
+void readMappedValues(const std::string& fileName, boost::multi_array<double, 2>& values)
+{
+    std::ifstream is;
+    std::uint64_t nNodes, nTimeSteps;
+    openMappedValues(fileName, is, nNodes, nTimeSteps);
+
+    values.resize(boost::extents[nNodes][nTimeSteps]);
+    is.read(reinterpret_cast<char*>(values.data()), values.num_elements() * sizeof(double));
+
+    if (!is) {
+        mitkThrow() << "Failed to read the mapped PC-MRI values from " << fileName;
+    }
+}
+
+void readMappedValues(const std::string& fileName, std::size_t firstNode, std::size_t nNodes,
+                      boost::multi_array<double, 2>& values)
+{
+    std::ifstream is;
+    std::uint64_t nFileNodes, nTimeSteps;
+    openMappedValues(fileName, is, nFileNodes, nTimeSteps);
+
+    if (firstNode > nFileNodes || nNodes > nFileNodes - firstNode) {
+        mitkThrow() << "Nodes " << firstNode << " to " << firstNode + nNodes << " are out of the " << nFileNodes
+                    << " nodes of " << fileName;
+    }
+
+    is.seekg(headerSize + firstNode * nTimeSteps * sizeof(double), std::ios::beg);
+    values.resize(boost::extents[nNodes][nTimeSteps]);
+    is.read(reinterpret_cast<char*>(values.data()), values.num_elements() * sizeof(double));
+
+    if (!is) {
+        mitkThrow() << "Failed to read the mapped PC-MRI values from " << fileName;
+    }
+}
+
+} // namespace crimson
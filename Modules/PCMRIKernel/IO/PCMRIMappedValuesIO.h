@@ -0,0 +1,35 @@
+#pragma once
+
+#include <boost/multi_array.hpp>
+
+#include <cstddef>
+#include <string>
+
+#include "PCMRIKernelExports.h"
+
+namespace crimson {
+
+/*
+ * Since version 1 of the PCMRIData archive, the mapped values are written next to the archive as a dense binary block:
+ *
+ *   "PCMRIVAL", uint32 version, uint32 reserved, uint64 nodes, uint64 time steps,
+ *   then nodes x time steps doubles, node after node.
+ *
+ * The header is 32 bytes long, so the values are 8-byte aligned and the block can be memory-mapped.
+ * Integers and doubles are stored in the native byte order.
+ */
+
+/*! \brief   Writes the nodes x time steps mapped values to fileName. */
+PCMRIKernel_EXPORT void writeMappedValues(const std::string& fileName, const boost::multi_array<double, 2>& values);
+
+/*! \brief   Reads all the mapped values from fileName. Throws if the file is missing, truncated or not a values file. */
+PCMRIKernel_EXPORT void readMappedValues(const std::string& fileName, boost::multi_array<double, 2>& values);
+
+/*!
+* \brief   Reads the mapped values of the nodes [firstNode, firstNode + nNodes) only, seeking past the others.
+*  values is resized to nNodes x time steps.
+*/
+PCMRIKernel_EXPORT void readMappedValues(const std::string& fileName, std::size_t firstNode, std::size_t nNodes,
+                                         boost::multi_array<double, 2>& values);
+
+} // namespace crimson
@@ -0,0 +1,114 @@
+#include <mitkTestingMacros.h>
+#include <mitkTestFixture.h>
+
+#include <IPCMRIKernel.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+/// Compares fitAndEvaluateCyclicBspline1D with fitting every signal separately with fit_cyclicBspline1D,
+/// which is how PCMRIData::timeInterpolate() used to interpolate the mapped values
+class CyclicBsplineFitTestSuite : public mitk::TestFixture
+{
+    CPPUNIT_TEST_SUITE(CyclicBsplineFitTestSuite);
+
+    MITK_TEST(testMatchesPerSignalFit);
+    MITK_TEST(testMatchesPerSignalFitInParallel);
+    MITK_TEST(testFallsBackOnSingularSystem);
+
+    CPPUNIT_TEST_SUITE_END();
+
+    typedef crimson::IPCMRIKernel::BsplineGrid1DType GridType;
+
+public:
+    void setUp() {}
+
+    void tearDown() {}
+
+    void testMatchesPerSignalFit()
+    {
+        // 15 control points and 25 frames, as in PCMRIData::timeInterpolate()
+        checkAgainstPerSignalFit(50, 25, 15, false, 1e-3);
+    }
+
+    void testMatchesPerSignalFitInParallel()
+    {
+        // Enough signals to be split into several blocks
+        checkAgainstPerSignalFit(2500, 25, 15, true, 1e-3);
+    }
+
+    void testFallsBackOnSingularSystem()
+    {
+        // Fewer frames than control points: the normal equations are singular and both paths use GMRES
+        checkAgainstPerSignalFit(50, 10, 15, true, 1e-4);
+    }
+
+private:
+    GridType::Pointer createGrid(const std::vector<double>& t, double cycleDuration, double nControlPoints, bool parallel)
+    {
+        double bounds[2] = { t.front(), t.back() };
+        GridType::PointType gridSpacing;
+        gridSpacing[0] = (bounds[1] - bounds[0]) / (nControlPoints - 1);
+
+        GridType::Pointer controlPoints(new GridType(bounds, 3, gridSpacing, 0));
+        GridType::IndexType cyclicDimensions;
+        cyclicDimensions[0] = 1;
+        controlPoints->SetCyclicDimensions(cyclicDimensions);
+        controlPoints->SetCyclicBounds(0, t.front(), cycleDuration);
+        controlPoints->SetParallel(parallel, 4);
+        controlPoints->UpdateCyclicBehaviour();
+        return controlPoints;
+    }
+
+    void checkAgainstPerSignalFit(int nSignals, int nFrames, double nControlPoints, bool parallel, double tolerance)
+    {
+        const double cycleDuration = 0.8;
+
+        std::vector<double> t(nFrames);
+        std::vector<GridType::PointType> coordinates(nFrames);
+        for (int j = 0; j < nFrames; j++) {
+            t[j] = j * cycleDuration / nFrames;
+            coordinates[j] = t[j];
+        }
+
+        std::vector<GridType::PointType> interpolatedT;
+        for (double time = 0; time <= cycleDuration; time += 0.01) {
+            interpolatedT.push_back(time);
+        }
+
+        std::mt19937 engine(7);
+        std::uniform_real_distribution<double> amplitude(-1, 1);
+        GridType::DenseMatrixType values(nSignals, nFrames);
+        for (int i = 0; i < nSignals; i++) {
+            double a = amplitude(engine), b = amplitude(engine), c = amplitude(engine);
+            for (int j = 0; j < nFrames; j++) {
+                double phase = 2 * M_PI * t[j] / cycleDuration;
+                values(i, j) = a + b * std::sin(phase) + c * std::cos(2 * phase);
+            }
+        }
+
+        GridType::DenseMatrixType result = crimson::fitAndEvaluateCyclicBspline1D<GridType>(
+            coordinates, values, 0, createGrid(t, cycleDuration, nControlPoints, parallel), interpolatedT);
+
+        CPPUNIT_ASSERT_EQUAL(static_cast<long>(nSignals), static_cast<long>(result.rows()));
+        CPPUNIT_ASSERT_EQUAL(static_cast<long>(interpolatedT.size()), static_cast<long>(result.cols()));
+
+        for (int i = 0; i < nSignals; i++) {
+            std::vector<GridType::CoefficientType> signal(nFrames);
+            for (int j = 0; j < nFrames; j++) {
+                signal[j] = values(i, j);
+            }
+
+            GridType::Pointer controlPoints = createGrid(t, cycleDuration, nControlPoints, false);
+            crimson::fit_cyclicBspline1D<GridType>(coordinates, signal, 0, controlPoints);
+            std::vector<GridType::CoefficientType> expected = controlPoints->evaluate(interpolatedT);
+
+            for (size_t j = 0; j < interpolatedT.size(); j++) {
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(expected[j][0], result(i, j), tolerance);
+            }
+        }
+    }
+};
+
+MITK_TEST_SUITE_REGISTRATION(CyclicBsplineFit)
@@ -0,0 +1,109 @@
+#include <mitkTestingMacros.h>
+#include <mitkTestFixture.h>
+
+#include <LinearImageSampler.hxx>
+
+#include <itkImage.h>
+#include <itkImageRegionIteratorWithIndex.h>
+#include <itkLinearInterpolateImageFunction.h>
+
+#include <cmath>
+#include <random>
+
+class LinearImageSamplerTestSuite : public mitk::TestFixture
+{
+    CPPUNIT_TEST_SUITE(LinearImageSamplerTestSuite);
+
+    MITK_TEST(testMatchesItkInterpolator);
+    MITK_TEST(testClampsAtTheBorder);
+
+    CPPUNIT_TEST_SUITE_END();
+
+    typedef itk::Image<float, 4> ImageType;
+    typedef itk::LinearInterpolateImageFunction<ImageType, double> InterpolatorType;
+
+public:
+    void setUp()
+    {
+        // An oblique image whose buffered region does not start at the origin, so that the direction, spacing,
+        // origin and start index all take part in the sampling
+        ImageType::IndexType start = {{ 2, -1, 3, 0 }};
+        ImageType::SizeType size = {{ 7, 6, 4, 5 }};
+        ImageType::RegionType region(start, size);
+
+        ImageType::SpacingType spacing;
+        spacing[0] = 0.7; spacing[1] = 1.3; spacing[2] = 2.0; spacing[3] = 1.0;
+
+        ImageType::PointType origin;
+        origin[0] = -3; origin[1] = 5; origin[2] = 1.5; origin[3] = 0;
+
+        ImageType::DirectionType direction;
+        direction.SetIdentity();
+        const double angle = 0.4;
+        direction(0, 0) = std::cos(angle); direction(0, 1) = -std::sin(angle);
+        direction(1, 0) = std::sin(angle); direction(1, 1) = std::cos(angle);
+
+        image = ImageType::New();
+        image->SetRegions(region);
+        image->SetSpacing(spacing);
+        image->SetOrigin(origin);
+        image->SetDirection(direction);
+        image->Allocate();
+
+        std::mt19937 engine(7);
+        std::uniform_real_distribution<float> values(-100, 100);
+        for (itk::ImageRegionIteratorWithIndex<ImageType> it(image, region); !it.IsAtEnd(); ++it) {
+            it.Set(values(engine));
+        }
+
+        interpolator = InterpolatorType::New();
+        interpolator->SetInputImage(image);
+    }
+
+    void tearDown()
+    {
+        interpolator = nullptr;
+        image = nullptr;
+    }
+
+    void testMatchesItkInterpolator()
+    {
+        checkRandomPoints(0);
+    }
+
+    void testClampsAtTheBorder()
+    {
+        // Up to half a voxel outside the buffered region, where the neighbours are clamped
+        checkRandomPoints(0.5);
+    }
+
+private:
+    void checkRandomPoints(double margin)
+    {
+        crimson::LinearImageSampler<ImageType> sampler(image);
+
+        const ImageType::RegionType& region = image->GetBufferedRegion();
+        std::mt19937 engine(11);
+
+        for (int n = 0; n < 1000; ++n) {
+            itk::ContinuousIndex<double, 4> index;
+            for (unsigned int d = 0; d < 4; ++d) {
+                std::uniform_real_distribution<double> coordinate(region.GetIndex()[d] - margin,
+                    region.GetIndex()[d] + region.GetSize()[d] - 1 + margin);
+                index[d] = coordinate(engine);
+            }
+
+            itk::Point<double, 4> physicalPoint;
+            image->TransformContinuousIndexToPhysicalPoint(index, physicalPoint);
+
+            double point[3] = { physicalPoint[0], physicalPoint[1], physicalPoint[2] };
+            double expected = interpolator->EvaluateAtContinuousIndex(index);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(expected, sampler.sample(point, physicalPoint[3]), 1e-6);
+        }
+    }
+
+    ImageType::Pointer image;
+    InterpolatorType::Pointer interpolator;
+};
+
+MITK_TEST_SUITE_REGISTRATION(LinearImageSampler)
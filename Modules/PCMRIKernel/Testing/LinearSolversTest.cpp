@@ -0,0 +1,171 @@
+#include <mitkTestingMacros.h>
+#include <mitkTestFixture.h>
+
+#include <LinearSolvers.hxx>
+
+#include <cmath>
+#include <vector>
+
+class LinearSolversTestSuite : public mitk::TestFixture
+{
+    CPPUNIT_TEST_SUITE(LinearSolversTestSuite);
+
+    MITK_TEST(testBlockJacobiInvertsBlockDiagonalMatrices);
+    MITK_TEST(testConjugateGradient);
+    MITK_TEST(testBiCGSTAB);
+    MITK_TEST(testGMRES);
+    MITK_TEST(testWarmStart);
+
+    CPPUNIT_TEST_SUITE_END();
+
+    typedef Eigen::SparseMatrix<double> SparseMatrixType;
+    typedef Eigen::VectorXd DenseVectorType;
+    typedef Eigen::MatrixXd DenseMatrixType;
+
+public:
+    void setUp()
+    {
+        // Shifted 5-point Laplacian on an n x n grid, symmetric positive definite, ordered row by row
+        // like the B-spline control points
+        const int n = 12;
+        std::vector<Eigen::Triplet<double> > triplets;
+        for (int j = 0; j < n; ++j) {
+            for (int i = 0; i < n; ++i) {
+                int row = j * n + i;
+                triplets.push_back(Eigen::Triplet<double>(row, row, 4.5));
+                if (i > 0) triplets.push_back(Eigen::Triplet<double>(row, row - 1, -1));
+                if (i < n - 1) triplets.push_back(Eigen::Triplet<double>(row, row + 1, -1));
+                if (j > 0) triplets.push_back(Eigen::Triplet<double>(row, row - n, -1));
+                if (j < n - 1) triplets.push_back(Eigen::Triplet<double>(row, row + n, -1));
+            }
+        }
+        A.resize(n * n, n * n);
+        A.setFromTriplets(triplets.begin(), triplets.end());
+        rowLength = n;
+
+        expected.resize(n * n, 2);
+        for (int k = 0; k < n * n; ++k) {
+            expected(k, 0) = std::sin(0.1 * k);
+            expected(k, 1) = 1.0 - 0.01 * k;
+        }
+        b = A * expected;
+    }
+
+    void tearDown() {}
+
+    void testBlockJacobiInvertsBlockDiagonalMatrices()
+    {
+        // Blocks of 2, 3 and 1 rows; the preconditioner of a block diagonal matrix is its exact inverse
+        DenseMatrixType dense = DenseMatrixType::Zero(6, 6);
+        dense.block(0, 0, 2, 2) << 4, 1, 1, 3;
+        dense.block(2, 2, 3, 3) << 5, 2, 0, 2, 6, 1, 0, 1, 7;
+        dense(5, 5) = 2;
+        SparseMatrixType M = dense.sparseView();
+
+        echo::solvers::BlockJacobiPreconditioner<double> preconditioner;
+        preconditioner.setBlockStarts(std::vector<unsigned int>{0, 2, 5});
+        preconditioner.compute(M);
+
+        DenseVectorType x = DenseVectorType::LinSpaced(6, 1, 6);
+        DenseVectorType y = preconditioner.solve(dense * x);
+        CPPUNIT_ASSERT((y - x).norm() < 1e-12);
+
+        // With a fixed block size the 2x2 block above is split and only its diagonal remains
+        preconditioner.setBlockSize(1);
+        preconditioner.compute(M);
+        y = preconditioner.solve(x);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(x[0] / 4, y[0], 1e-12);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(x[1] / 3, y[1], 1e-12);
+    }
+
+    void testConjugateGradient()
+    {
+        for (auto preconditioner : preconditioners()) {
+            for (bool irregularBlocks : {false, true}) {
+                echo::solvers::ConfigurationParameter config = configuration(preconditioner, irregularBlocks);
+                DenseMatrixType x;
+                echo::solvers::solveWithConjugateGradient<SparseMatrixType, DenseMatrixType>(A, b, x, config);
+                checkSolution(x);
+            }
+        }
+    }
+
+    void testBiCGSTAB()
+    {
+        for (auto preconditioner : preconditioners()) {
+            for (bool irregularBlocks : {false, true}) {
+                echo::solvers::ConfigurationParameter config = configuration(preconditioner, irregularBlocks);
+                DenseMatrixType x;
+                echo::solvers::solveWithBiCGSTAB<SparseMatrixType, DenseMatrixType>(A, b, x, config);
+                checkSolution(x);
+            }
+        }
+    }
+
+    void testGMRES()
+    {
+        for (auto preconditioner : preconditioners()) {
+            for (bool irregularBlocks : {false, true}) {
+                echo::solvers::ConfigurationParameter config = configuration(preconditioner, irregularBlocks);
+                DenseMatrixType x;
+                echo::solvers::solveWithGMRES<SparseMatrixType, DenseMatrixType>(A, b, x, config);
+                checkSolution(x);
+            }
+        }
+    }
+
+    void testWarmStart()
+    {
+        // Starting from the solution, a single iteration keeps it; a guess of the wrong size is ignored
+        echo::solvers::ConfigurationParameter config = configuration(echo::solvers::PRECONDITIONER_DIAGONAL, false);
+        config.use_guess = true;
+        config.max_iterations = 1;
+
+        DenseMatrixType x = expected;
+        echo::solvers::solveWithGMRES<SparseMatrixType, DenseMatrixType>(A, b, x, config);
+        CPPUNIT_ASSERT((x - expected).norm() < 1e-10 * expected.norm());
+
+        config.max_iterations = 1000;
+        x = DenseMatrixType::Ones(3, 2);
+        echo::solvers::solveWithGMRES<SparseMatrixType, DenseMatrixType>(A, b, x, config);
+        checkSolution(x);
+    }
+
+private:
+    static std::vector<echo::solvers::PreconditionerType> preconditioners()
+    {
+        return { echo::solvers::PRECONDITIONER_DEFAULT, echo::solvers::PRECONDITIONER_DIAGONAL,
+                 echo::solvers::PRECONDITIONER_BLOCK_JACOBI, echo::solvers::PRECONDITIONER_ILUT };
+    }
+
+    echo::solvers::ConfigurationParameter configuration(echo::solvers::PreconditionerType preconditioner, bool irregularBlocks)
+    {
+        echo::solvers::ConfigurationParameter config;
+        config.max_iterations = 1000;
+        config.tol = 1e-10;
+        config.verbose = false;
+        config.preconditioner = preconditioner;
+        config.block_size = rowLength;
+        if (irregularBlocks) {
+            // Rows of the grid with some of their nodes removed, as when nodes are dropped from the B-spline grid
+            for (unsigned int start = 0; start < A.rows(); start += rowLength - 3) {
+                config.block_starts.push_back(start);
+            }
+        }
+        return config;
+    }
+
+    void checkSolution(const DenseMatrixType& x)
+    {
+        CPPUNIT_ASSERT_EQUAL(expected.rows(), x.rows());
+        CPPUNIT_ASSERT_EQUAL(expected.cols(), x.cols());
+        CPPUNIT_ASSERT((A * x - b).norm() < 1e-8 * b.norm());
+    }
+
+    SparseMatrixType A;
+    DenseMatrixType expected;
+    DenseMatrixType b;
+    unsigned int rowLength;
+};
+
+MITK_TEST_SUITE_REGISTRATION(LinearSolvers)
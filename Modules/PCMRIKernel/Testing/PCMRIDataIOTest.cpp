@@ -0,0 +1,175 @@
+#include "PCMRIKernelTestingConfig.h"
+
+#include <mitkTestingMacros.h>
+#include <mitkTestFixture.h>
+#include <mitkIOUtil.h>
+
+#include <boost/archive/xml_oarchive.hpp>
+
+#include <PCMRIData.h>
+#include <PCMRIDataBoostIO.h>
+#include <PCMRIMappedValuesIO.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+class PCMRIDataIOTestSuite : public mitk::TestFixture
+{
+    CPPUNIT_TEST_SUITE(PCMRIDataIOTestSuite);
+
+    MITK_TEST(testMappedValuesRoundTrip);
+    MITK_TEST(testRangedRead);
+    MITK_TEST(testCorruptMappedValues);
+    MITK_TEST(testVersion0Archive);
+    MITK_TEST(testVersion1Archive);
+
+    CPPUNIT_TEST_SUITE_END();
+
+    typedef boost::multi_array<double, 2> ValuesType;
+
+public:
+    void setUp()
+    {
+        directory = mitk::IOUtil::CreateTemporaryDirectory("PCMRIDataIOTest-XXXXXX");
+        archiveFileName = directory + "/data.pcmri";
+        valuesFileName = archiveFileName + ".values";
+
+        values.resize(boost::extents[5][3]);
+        for (int i = 0; i < 5; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                values[i][j] = 0.25 * i - j;
+            }
+        }
+    }
+
+    void tearDown()
+    {
+        std::remove(valuesFileName.c_str());
+        std::remove(archiveFileName.c_str());
+        std::remove(directory.c_str());
+    }
+
+    void testMappedValuesRoundTrip()
+    {
+        crimson::writeMappedValues(valuesFileName, values);
+
+        ValuesType readValues;
+        crimson::readMappedValues(valuesFileName, readValues);
+        CPPUNIT_ASSERT(readValues == values);
+
+        // Header and one dense block of doubles
+        std::ifstream is(valuesFileName, std::ios::binary | std::ios::ate);
+        CPPUNIT_ASSERT_EQUAL(static_cast<std::streamoff>(32 + 5 * 3 * sizeof(double)), static_cast<std::streamoff>(is.tellg()));
+    }
+
+    void testRangedRead()
+    {
+        crimson::writeMappedValues(valuesFileName, values);
+
+        ValuesType readValues;
+        crimson::readMappedValues(valuesFileName, 2, 2, readValues);
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), readValues.shape()[0]);
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(3), readValues.shape()[1]);
+        for (int i = 0; i < 2; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                CPPUNIT_ASSERT_EQUAL(values[2 + i][j], readValues[i][j]);
+            }
+        }
+
+        CPPUNIT_ASSERT_THROW(crimson::readMappedValues(valuesFileName, 4, 2, readValues), std::exception);
+    }
+
+    void testCorruptMappedValues()
+    {
+        crimson::writeMappedValues(valuesFileName, values);
+        std::string contents = readFile(valuesFileName);
+
+        ValuesType readValues;
+
+        // Truncated block
+        writeFile(valuesFileName, contents.substr(0, contents.size() - sizeof(double)));
+        CPPUNIT_ASSERT_THROW(crimson::readMappedValues(valuesFileName, readValues), std::exception);
+
+        // Node count that does not match the file, large enough to overflow the size computation
+        std::string header = contents;
+        std::uint64_t nNodes = ~std::uint64_t(0) / 3;
+        header.replace(16, sizeof(nNodes), reinterpret_cast<const char*>(&nNodes), sizeof(nNodes));
+        writeFile(valuesFileName, header);
+        CPPUNIT_ASSERT_THROW(crimson::readMappedValues(valuesFileName, readValues), std::exception);
+
+        // Not a values file at all
+        writeFile(valuesFileName, "not a values file, but long enough to hold a header");
+        CPPUNIT_ASSERT_THROW(crimson::readMappedValues(valuesFileName, readValues), std::exception);
+    }
+
+    void testVersion0Archive()
+    {
+        // An archive written by the code before the values moved out of it. A values file left next to it is ignored.
+        writeFile(archiveFileName, readFile(std::string(PCMRIKERNEL_TEST_DATA_PATH) + "/version0.pcmri"));
+        crimson::writeMappedValues(valuesFileName, values);
+
+        ValuesType readValues = load()->getMappedPCMRIvalues();
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), readValues.shape()[0]);
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(3), readValues.shape()[1]);
+        for (int i = 0; i < 2; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                CPPUNIT_ASSERT_EQUAL(10.0 * i + j + 0.5, readValues[i][j]);
+            }
+        }
+    }
+
+    void testVersion1Archive()
+    {
+        auto data = crimson::PCMRIData::New();
+        data->setMappedPCMRIvalues(values);
+        data->setMeshNodeUID("mesh");
+
+        {
+            std::ofstream os(archiveFileName);
+            boost::archive::xml_oarchive outArchive(os);
+            const crimson::PCMRIData& dataRef = *data;
+            outArchive << BOOST_SERIALIZATION_NVP(dataRef);
+        }
+        CPPUNIT_ASSERT(readFile(archiveFileName).find("_mappedPCMRIvalues") == std::string::npos);
+        crimson::writeMappedValues(valuesFileName, values);
+
+        auto loaded = load();
+        CPPUNIT_ASSERT(loaded->getMappedPCMRIvalues() == values);
+        CPPUNIT_ASSERT_EQUAL(std::string("mesh"), loaded->getMeshNodeUID());
+
+        // The values file is required from version 1 on
+        std::remove(valuesFileName.c_str());
+        CPPUNIT_ASSERT_THROW(load(), std::exception);
+    }
+
+private:
+    crimson::PCMRIData::Pointer load()
+    {
+        std::vector<mitk::BaseData::Pointer> loaded = mitk::IOUtil::Load(archiveFileName);
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), loaded.size());
+        crimson::PCMRIData::Pointer data = dynamic_cast<crimson::PCMRIData*>(loaded[0].GetPointer());
+        CPPUNIT_ASSERT(data.IsNotNull());
+        return data;
+    }
+
+    static std::string readFile(const std::string& fileName)
+    {
+        std::ifstream is(fileName, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+    }
+
+    static void writeFile(const std::string& fileName, const std::string& contents)
+    {
+        std::ofstream os(fileName, std::ios::binary | std::ios::trunc);
+        os.write(contents.data(), contents.size());
+    }
+
+    std::string directory;
+    std::string archiveFileName;
+    std::string valuesFileName;
+    ValuesType values;
+};
+
+MITK_TEST_SUITE_REGISTRATION(PCMRIDataIO)
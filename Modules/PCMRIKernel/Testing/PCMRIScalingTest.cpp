@@ -0,0 +1,169 @@
+#include <mitkTestingMacros.h>
+#include <mitkTestFixture.h>
+
+#include <IPCMRIKernel.h>
+
+#include <itkDivideImageFilter.h>
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIterator.h>
+#include <itkMultiplyImageFilter.h>
+#include <itkSubtractImageFilter.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+/// Compares IPCMRIKernel::calculateParRecScaling() and applyLinearScaling() with the pixel loop and the ITK filter
+/// chains the velocity conversions in MapAction used before
+class PCMRIScalingTestSuite : public mitk::TestFixture
+{
+    CPPUNIT_TEST_SUITE(PCMRIScalingTestSuite);
+
+    MITK_TEST(testParRecScaling);
+    MITK_TEST(testPhilips);
+    MITK_TEST(testGE);
+    MITK_TEST(testSiemens);
+    MITK_TEST(testLinear);
+
+    CPPUNIT_TEST_SUITE_END();
+
+    typedef WholeImageTypeFloat ImageType;
+    typedef itk::DivideImageFilter<ImageType, ImageType, ImageType> DivideFilterType;
+    typedef itk::MultiplyImageFilter<ImageType, ImageType> MultiplyFilterType;
+    typedef itk::SubtractImageFilter<ImageType, ImageType, ImageType> SubtractFilterType;
+
+public:
+    void setUp()
+    {
+        // 6 x 5 x 3 voxels and 8 frames of 12-bit phase values
+        ImageType::SizeType size = { { 6, 5, 3, 8 } };
+        image = ImageType::New();
+        image->SetRegions(ImageType::RegionType(size));
+        image->Allocate();
+
+        itk::ImageRegionIterator<ImageType> it(image, image->GetBufferedRegion());
+        for (unsigned int n = 0; !it.IsAtEnd(); ++it, ++n) {
+            it.Set(static_cast<float>((n * 37) % 4096));
+        }
+    }
+
+    void tearDown()
+    {
+        image = nullptr;
+    }
+
+    void testParRecScaling()
+    {
+        for (int startIndex : { 0, 3, 7 }) {
+            // The maximum is only taken from the first slice of the frames from startIndex on
+            double max_ph = 0;
+            const ImageType::SizeType& size = image->GetBufferedRegion().GetSize();
+            for (int i = startIndex; i < static_cast<int>(size[3]); i++) {
+                for (unsigned int j = 0; j < size[0]; j++) {
+                    for (unsigned int z = 0; z < size[1]; z++) {
+                        ImageType::IndexType idx;
+                        idx[0] = j;
+                        idx[1] = z;
+                        idx[2] = 0;
+                        idx[3] = i;
+                        max_ph = std::max(max_ph, static_cast<double>(image->GetPixel(idx)));
+                    }
+                }
+            }
+            double expected = std::pow(2, static_cast<int>(std::ceil(std::log2(max_ph)))) / 2;
+
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(expected, crimson::IPCMRIKernel::calculateParRecScaling(image, startIndex), 0);
+        }
+    }
+
+    void testPhilips()
+    {
+        int venc = 150;
+        double scale = crimson::IPCMRIKernel::calculateParRecScaling(image, 2);
+
+        SubtractFilterType::Pointer subtract = SubtractFilterType::New();
+        subtract->SetInput1(image);
+        subtract->SetConstant2(scale);
+        MultiplyFilterType::Pointer multiply = MultiplyFilterType::New();
+        multiply->SetInput(subtract->GetOutput());
+        multiply->SetConstant(venc * 10 / scale);
+        multiply->Update();
+
+        double slope = venc * 10 / scale;
+        checkScaling(multiply->GetOutput(), slope, -scale * slope);
+    }
+
+    void testGE()
+    {
+        int venc = 150;
+        double venscale = 0.25;
+        double scale = (venscale * M_PI) / (double)venc;
+
+        DivideFilterType::Pointer divide = DivideFilterType::New();
+        divide->SetInput(image);
+        divide->SetConstant(scale / 10);
+        divide->Update();
+
+        checkScaling(divide->GetOutput(), 10 / scale, 0);
+    }
+
+    void testSiemens()
+    {
+        int venc = 150;
+        double rescaleSlope = 2;
+        int rescaleIntercept = -4096;
+        int quantization = 12;
+        double scale = venc * 10 / (pow(2, quantization));
+
+        MultiplyFilterType::Pointer multiply = MultiplyFilterType::New();
+        multiply->SetInput(image);
+        multiply->SetConstant(scale * rescaleSlope);
+        SubtractFilterType::Pointer subtract = SubtractFilterType::New();
+        subtract->SetInput1(multiply->GetOutput());
+        subtract->SetInput2((double)rescaleIntercept * scale * -1);
+        subtract->Update();
+
+        checkScaling(subtract->GetOutput(), scale * rescaleSlope, (double)rescaleIntercept * scale);
+    }
+
+    void testLinear()
+    {
+        double rescaleSlope = 0.1;
+        int rescaleIntercept = 200;
+
+        MultiplyFilterType::Pointer multiply = MultiplyFilterType::New();
+        multiply->SetInput(image);
+        multiply->SetConstant(rescaleSlope);
+        SubtractFilterType::Pointer subtract = SubtractFilterType::New();
+        subtract->SetInput1(multiply->GetOutput());
+        subtract->SetConstant2((double)rescaleIntercept);
+        MultiplyFilterType::Pointer multiply2 = MultiplyFilterType::New();
+        multiply2->SetInput(subtract->GetOutput());
+        multiply2->SetConstant(10);
+        multiply2->Update();
+
+        checkScaling(multiply2->GetOutput(), rescaleSlope * 10, (double)rescaleIntercept * -10);
+    }
+
+private:
+    /// Applies the slope and intercept to the test image in place and compares it with the filter chain result
+    void checkScaling(ImageType* expected, double slope, double intercept)
+    {
+        std::vector<float> original(image->GetBufferPointer(),
+            image->GetBufferPointer() + image->GetBufferedRegion().GetNumberOfPixels());
+
+        crimson::IPCMRIKernel::applyLinearScaling(image, slope, intercept);
+
+        itk::ImageRegionConstIterator<ImageType> expectedIt(expected, expected->GetBufferedRegion());
+        itk::ImageRegionConstIterator<ImageType> it(image, image->GetBufferedRegion());
+        for (size_t n = 0; !it.IsAtEnd(); ++it, ++expectedIt, ++n) {
+            // The filter chains round to float after every step, which matters when the terms cancel out
+            double tolerance = 1e-5 * std::max(1.0, std::abs(slope * original[n]) + std::abs(intercept));
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(expectedIt.Get(), it.Get(), tolerance);
+        }
+    }
+
+    ImageType::Pointer image;
+};
+
+MITK_TEST_SUITE_REGISTRATION(PCMRIScaling)
@@ -0,0 +1,7 @@
+set(MODULE_TESTS
+  CyclicBsplineFitTest.cpp
+  LinearSolversTest.cpp
+  LinearImageSamplerTest.cpp
+  PCMRIDataIOTest.cpp
+  PCMRIScalingTest.cpp
+)
@@ -3,6 +3,7 @@ set(CPP_FILES
     Rendering/PCMRIDataMapper.cpp    
     Initialization/PCMRIKernelModuleActivator.cpp
     IO/PCMRIDataIO.cpp
+    IO/PCMRIMappedValuesIO.cpp
     IO/PCMRIKernelIOMimeTypes.cpp  
     IO/PCMRIDataCoreObjectFactory.cpp 
     ExtensionPoint/IPCMRIKernel.cpp
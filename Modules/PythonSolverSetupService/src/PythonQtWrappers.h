@@ -3,7 +3,11 @@
 #include <gsl.h>
 #include <boost/optional.hpp>
 
+#include <algorithm>
+#include <limits>
+
 #include <mitkPythonService.h>
+#include <mitkLogMacros.h>
 
 #include <QObject>
 #include <QSet>
@@ -19,7 +23,14 @@
 #include <VesselForestData.h>
 #include <PCMRIData.h>
 
+#include <vtkDoubleArray.h>
+#include <vtkIdList.h>
+#include <vtkNew.h>
+#include <vtkPoints.h>
+#include <vtkUnstructuredGrid.h>
+
 #include "PythonSolverSetupServiceActivator.h"
+#include "SolverSetupPythonUtils.h"
 #include <PythonSolverSetupManager.h>
 #include "PythonSolverSetupServiceExports.h"
 
@@ -314,6 +325,82 @@ public slots:
         return out;
     }
 
+    // Bulk accessors returning numpy arrays. These avoid a Python -> C++ call per node or element.
+
+    PythonQtObjectPtr getAllNodeCoordinates() const // numpy.array of shape (nNodes, 3)
+    {
+        Expects(_mesh != nullptr);
+        vtkPoints* points = _mesh->getUnstructuredGridRepresentation()->GetVtkUnstructuredGrid()->GetPoints();
+        auto shape = std::vector<Py_ssize_t>{static_cast<Py_ssize_t>(points->GetNumberOfPoints()), 3};
+
+        if (points->GetDataType() == VTK_DOUBLE) {
+            auto coordinates = static_cast<vtkDoubleArray*>(points->GetData());
+            return createNumpyArrayView(shareVtkObject(coordinates), coordinates->GetPointer(0), shape);
+        }
+
+        auto coordinates = std::vector<double>(3 * points->GetNumberOfPoints());
+        for (vtkIdType i = 0; i < points->GetNumberOfPoints(); ++i) {
+            points->GetPoint(i, &coordinates[3 * i]);
+        }
+        return createNumpyArray(std::move(coordinates), shape);
+    }
+
+    PythonQtObjectPtr getAllElementNodeIds() const // numpy.array of shape (nElements, 4)
+    {
+        Expects(_mesh != nullptr);
+        vtkUnstructuredGridBase* ug = _mesh->getUnstructuredGridRepresentation()->GetVtkUnstructuredGrid();
+        const int nNodesPerElement = 4;
+
+        auto nodeIds = std::vector<int32_t>(nNodesPerElement * _mesh->getNElements());
+        vtkNew<vtkIdList> pointIds;
+        for (int elementId = 0; elementId < _mesh->getNElements(); ++elementId) {
+            ug->GetCellPoints(elementId, pointIds.GetPointer());
+            Expects(pointIds->GetNumberOfIds() == nNodesPerElement);
+            std::copy(pointIds->GetPointer(0), pointIds->GetPointer(nNodesPerElement), nodeIds.begin() + nNodesPerElement * elementId);
+        }
+        return createNumpyArray(std::move(nodeIds), {_mesh->getNElements(), nNodesPerElement});
+    }
+
+    QVariantList getElementAdjacencyCSR() const // [offsets, adjacentElements] numpy.arrays
+    {
+        Expects(_mesh != nullptr);
+        auto offsets = std::vector<int>{};
+        auto adjacentElements = std::vector<int>{};
+        _mesh->getElementAdjacency(offsets, adjacentElements);
+
+        auto offsetsShape = std::vector<Py_ssize_t>{static_cast<Py_ssize_t>(offsets.size())};
+        auto adjacentElementsShape = std::vector<Py_ssize_t>{static_cast<Py_ssize_t>(adjacentElements.size())};
+        return QVariantList{QVariant::fromValue(createNumpyArray(std::move(offsets), offsetsShape)),
+                            QVariant::fromValue(createNumpyArray(std::move(adjacentElements), adjacentElementsShape))};
+    }
+
+    PythonQtObjectPtr getNodeIdsForFaceArray(PythonQtObjectPtr pyFaceIdentifier) const // numpy.array of shape (nFaceNodes,)
+    {
+        Expects(_mesh != nullptr);
+        auto cppFaceIdOptional = PyFaceIdentifier::pyToCpp(pyFaceIdentifier);
+
+        auto nodeIds = cppFaceIdOptional ? _mesh->getNodeIdsForFace(cppFaceIdOptional.get()) : std::vector<int>{};
+        auto shape = std::vector<Py_ssize_t>{static_cast<Py_ssize_t>(nodeIds.size())};
+        return createNumpyArray(std::move(nodeIds), shape);
+    }
+
+    // numpy.array of shape (nMeshFaces, 5) with rows [elementId, globalFaceId, nodeId0, nodeId1, nodeId2]
+    PythonQtObjectPtr getMeshFaceInfoForFaceArray(PythonQtObjectPtr pyFaceIdentifier) const
+    {
+        Expects(_mesh != nullptr);
+        auto cppFaceIdOptional = PyFaceIdentifier::pyToCpp(pyFaceIdentifier);
+
+        auto faceInfos = cppFaceIdOptional ? _mesh->getMeshFaceInfoForFace(cppFaceIdOptional.get())
+                                           : std::vector<crimson::MeshData::MeshFaceInfo>{};
+
+        auto out = std::vector<int>{};
+        out.reserve(5 * faceInfos.size());
+        for (const auto& info : faceInfos) {
+            out.insert(out.end(), {info.elementId, info.globalFaceId, info.nodeIds[0], info.nodeIds[1], info.nodeIds[2]});
+        }
+        return createNumpyArray(std::move(out), {static_cast<Py_ssize_t>(faceInfos.size()), 5});
+    }
+
 private:
     const MeshData* _mesh;
 };
@@ -382,6 +469,33 @@ public slots:
         return QVector<double>{pt[0], pt[1], pt[2], tangent[0], tangent[1], tangent[2], normal[0], normal[1], normal[2]};
     }
 
+    // Vectorized versions of getClosestPoint() and getVesselPathCoordinateFrame().
+    // points is an array-like of shape (nPoints, 3). The rows for which no vessel path was found are filled with NaN.
+
+    PythonQtObjectPtr getClosestPoints(PythonQtObjectPtr pyFaceIdentifier, PythonQtObjectPtr points) const // (nPoints, 2)
+    {
+        Expects(_vesselForest != nullptr);
+        return _evaluateForPoints(pyFaceIdentifier, points, 2, [](const ClosestVesselPathInfo& info, double* out) {
+            out[0] = info.distance;
+            out[1] = info.t;
+        });
+    }
+
+    PythonQtObjectPtr getVesselPathCoordinateFrames(PythonQtObjectPtr pyFaceIdentifier, PythonQtObjectPtr points) const // (nPoints, 9)
+    {
+        Expects(_vesselForest != nullptr);
+        return _evaluateForPoints(pyFaceIdentifier, points, 9, [](const ClosestVesselPathInfo& info, double* out) {
+            auto pt = info.vesselPath->getPosition(info.t);
+            auto tangent = info.vesselPath->getTangentVector(info.t);
+            auto normal = info.vesselPath->getNormalVector(info.t);
+            for (int i = 0; i < 3; ++i) {
+                out[i] = pt[i];
+                out[3 + i] = tangent[i];
+                out[6 + i] = normal[i];
+            }
+        });
+    }
+
 private:
     struct ClosestVesselPathInfo {
         const VesselPathAbstractData* vesselPath = nullptr;
@@ -389,7 +503,7 @@ private:
         double t = 0;
     };
 
-    ClosestVesselPathInfo _getClosestVesselPath(PythonQtObjectPtr pyFaceIdentifier, double x, double y, double z) const
+    std::vector<const VesselPathAbstractData*> _getParentVesselPaths(PythonQtObjectPtr pyFaceIdentifier) const
     {
         auto cppFaceIdOptional = PyFaceIdentifier::pyToCpp(pyFaceIdentifier);
 
@@ -397,18 +511,24 @@ private:
             return {};
         }
 
-        auto&& parentSolidIndices = cppFaceIdOptional->parentSolidIndices;
+        auto vesselPaths = std::vector<const VesselPathAbstractData*>{};
+        for (const auto& vesselUID : cppFaceIdOptional->parentSolidIndices) {
+            vesselPaths.push_back(_uidToVesselPathDataMap.at(vesselUID));
+        }
+        return vesselPaths;
+    }
 
+    static ClosestVesselPathInfo _getClosestVesselPath(const std::vector<const VesselPathAbstractData*>& vesselPaths,
+                                                       const mitk::Point3D& pos)
+    {
         auto result = ClosestVesselPathInfo{};
 
-        auto pos = mitk::Point3D{};
-        mitk::FillVector3D(pos, x, y, z);
-        for (const auto& vesselUID : parentSolidIndices) {
-            auto closestPointRequestResult = _uidToVesselPathDataMap.at(vesselUID)->getClosestPoint(pos);
+        for (const VesselPathAbstractData* vesselPath : vesselPaths) {
+            auto closestPointRequestResult = vesselPath->getClosestPoint(pos);
 
             auto d = closestPointRequestResult.closestPoint.EuclideanDistanceTo(pos);
             if (result.vesselPath == nullptr || d < result.distance) {
-                result.vesselPath = _uidToVesselPathDataMap.at(vesselUID);
+                result.vesselPath = vesselPath;
                 result.t = closestPointRequestResult.t;
                 result.distance = d;
             }
@@ -417,6 +537,42 @@ private:
         return result;
     }
 
+    ClosestVesselPathInfo _getClosestVesselPath(PythonQtObjectPtr pyFaceIdentifier, double x, double y, double z) const
+    {
+        auto pos = mitk::Point3D{};
+        mitk::FillVector3D(pos, x, y, z);
+        return _getClosestVesselPath(_getParentVesselPaths(pyFaceIdentifier), pos);
+    }
+
+    template <typename EvaluateFunc>
+    PythonQtObjectPtr _evaluateForPoints(PythonQtObjectPtr pyFaceIdentifier, PythonQtObjectPtr points, int nOutputColumns,
+                                         EvaluateFunc evaluate) const
+    {
+        auto coordinates = std::vector<double>{};
+        if (!copyFromNumpyArray(points, coordinates) || coordinates.size() % 3 != 0) {
+            MITK_ERROR << "Expected an array of point coordinates of shape (nPoints, 3)";
+            return {};
+        }
+
+        // The face identifier is resolved once for the whole batch. The vessel path queries lazily update
+        // internal caches and VTK locators which are not thread-safe, so the points are processed sequentially.
+        auto vesselPaths = _getParentVesselPaths(pyFaceIdentifier);
+
+        auto nPoints = coordinates.size() / 3;
+        auto result = std::vector<double>(nPoints * nOutputColumns, std::numeric_limits<double>::quiet_NaN());
+        for (size_t i = 0; i < nPoints; ++i) {
+            auto pos = mitk::Point3D{};
+            mitk::FillVector3D(pos, coordinates[3 * i], coordinates[3 * i + 1], coordinates[3 * i + 2]);
+
+            auto closestPathInfo = _getClosestVesselPath(vesselPaths, pos);
+            if (closestPathInfo.vesselPath) {
+                evaluate(closestPathInfo, &result[i * nOutputColumns]);
+            }
+        }
+
+        return createNumpyArray(std::move(result), {static_cast<Py_ssize_t>(nPoints), nOutputColumns});
+    }
+
 
     const VesselForestData* _vesselForest;
     UIDToVesselPathDataMap _uidToVesselPathDataMap;
@@ -461,6 +617,38 @@ public slots:
 		return QVector<double>{coords[0], coords[1], coords[2]};
 	}
 
+	// Vectorized version of getSingleMappedPCMRIvector(). timepointIndices must either have the same
+	// length as pointIndices or contain a single timepoint index used for all the points.
+	PythonQtObjectPtr getMappedPCMRIvectors(PythonQtObjectPtr pointIndices, PythonQtObjectPtr timepointIndices) const // (nPoints, 3)
+	{
+		Expects(_pcmriData != nullptr);
+
+		auto pointIds = std::vector<int32_t>{};
+		auto timepointIds = std::vector<int32_t>{};
+		if (!copyFromNumpyArray(pointIndices, pointIds) || !copyFromNumpyArray(timepointIndices, timepointIds) ||
+			(timepointIds.size() != 1 && timepointIds.size() != pointIds.size())) {
+			MITK_ERROR << "Expected arrays of point indices and timepoint indices of the same length";
+			return{};
+		}
+
+		auto outOfRange = [](int32_t index, int size) { return index < 0 || index >= size; };
+		int nPoints = _pcmriData->getNumberOfMappedPoints();
+		int nTimepoints = _pcmriData->getNumberOfMappedTimepoints();
+		if (std::any_of(pointIds.begin(), pointIds.end(), [&](int32_t id) { return outOfRange(id, nPoints); }) ||
+			std::any_of(timepointIds.begin(), timepointIds.end(), [&](int32_t id) { return outOfRange(id, nTimepoints); })) {
+			MITK_ERROR << "Point or timepoint index out of range";
+			return{};
+		}
+
+		auto result = std::vector<double>(3 * pointIds.size());
+		for (size_t i = 0; i < pointIds.size(); ++i) {
+			auto coords = _pcmriData->getSingleMappedPCMRIvector(pointIds[i], timepointIds[timepointIds.size() == 1 ? 0 : i]);
+			std::copy(&coords[0], &coords[0] + 3, &result[3 * i]);
+		}
+
+		return createNumpyArray(std::move(result), {static_cast<Py_ssize_t>(pointIds.size()), 3});
+	}
+
 private:
 	const PCMRIData* _pcmriData;
 };
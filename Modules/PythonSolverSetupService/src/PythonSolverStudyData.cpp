@@ -139,32 +139,26 @@ PythonQtObjectPtr PythonSolverStudyData::_createSolutionStorage(gsl::span<const
 
     auto arrayInfoObjectsMap = QVariantMap{};
 
-    // Numpy array creation has to go directly through PythonQt because otherwise
-    // it's impossible to get the PythonQtObjectPtr due to numpy.array being enumerable
-    // (and thus automatically converted to QVariantList)
-    auto numpyModule = PythonQt::self()->importModule("numpy");
-
     for (const auto& solutionPtr : solutions) {
         auto arrayData = solutionPtr->getArrayData();
 
-        auto variantArrayData = QVariantList{};
-        variantArrayData.reserve(arrayData->GetNumberOfTuples());
-
-        // Fill the data
-        for (int i = 0; i < arrayData->GetNumberOfTuples(); ++i) {
-            auto component = QVariantList{};
-            component.reserve(arrayData->GetNumberOfComponents());
-            for (int c = 0; c < arrayData->GetNumberOfComponents(); ++c) {
-                component.push_back(arrayData->GetComponent(i, c));
-            }
-            variantArrayData.push_back(component);
-        }
-
         Expects(arrayData->GetDataType() == VTK_INT || arrayData->GetDataType() == VTK_DOUBLE);
-        QString dtypeName = QString::fromLatin1(arrayData->GetDataType() == VTK_INT ? "i4" : "f8");
 
-        auto numpyArrayPtr = PythonQtObjectPtr{PythonQt::self()->callAndReturnPyObject(PythonQt::self()->lookupCallable(numpyModule, "array"),
-                                                                                       QVariantList{} << QVariant::fromValue(variantArrayData) << dtypeName)};
+        // Copy the array memory in one block instead of converting the values one by one.
+        // The scripts get a writable array of their own, as with the former numpy.array() copy.
+        auto shape = std::vector<Py_ssize_t>{static_cast<Py_ssize_t>(arrayData->GetNumberOfTuples()),
+                                            static_cast<Py_ssize_t>(arrayData->GetNumberOfComponents())};
+        auto nValues = static_cast<size_t>(arrayData->GetNumberOfTuples() * arrayData->GetNumberOfComponents());
+
+        auto numpyArrayPtr = PythonQtObjectPtr{};
+        if (arrayData->GetDataType() == VTK_INT) {
+            const int* values = static_cast<vtkIntArray*>(arrayData)->GetPointer(0);
+            numpyArrayPtr = createNumpyArray(std::vector<int32_t>(values, values + nValues), shape);
+        }
+        else {
+            const double* values = static_cast<vtkDoubleArray*>(arrayData)->GetPointer(0);
+            numpyArrayPtr = createNumpyArray(std::vector<double>(values, values + nValues), shape);
+        }
 
         if (numpyArrayPtr.isNull()) {
             MITK_ERROR << "Failed to create a numpy.array object";
@@ -376,7 +370,7 @@ struct vtkDataArrayTraits<double> {
 
 template <typename T>
 SolutionData::Pointer makeSolutionData(const std::string& name, int nComponents, const QVariantList& componentNames, int nTuples,
-                                       const QByteArray& rawDataByteArray)
+                                       PyObject* rawData)
 {
     auto data = vtkSmartPointer<typename vtkDataArrayTraits<T>::type>::New();
     data->SetName(name.c_str());
@@ -391,16 +385,12 @@ SolutionData::Pointer makeSolutionData(const std::string& name, int nComponents,
         data->SetComponentName(i, componentNames[i].toString().toStdString().c_str());
     }
 
-    if (rawDataByteArray.size() != nTuples * nComponents * sizeof(T)) {
-        MITK_ERROR << "Data size is not equal to nTuples * nComponents for array '" << name << "'. Skipping";
+    // Accepts numpy arrays as well as raw bytes without element-wise conversion
+    if (!copyFromPythonBuffer(rawData, data->GetPointer(0), static_cast<size_t>(nTuples * nComponents))) {
+        MITK_ERROR << "Data type or size (nTuples * nComponents) does not match for array '" << name << "'. Skipping";
         return {};
     }
 
-    auto dataPtr = reinterpret_cast<const T*>(rawDataByteArray.data());
-    for (int i = 0; i < nTuples * nComponents; ++i) {
-        data->SetValue(i, dataPtr[i]);
-    }
-
     return SolutionData::New(data.GetPointer()).GetPointer();
 }
 } // namespace detail
@@ -426,16 +416,24 @@ std::vector<SolutionData::Pointer> PythonSolverStudyData::_loadSolutionStorage(g
             auto nComponents = getReturnValue<int>(solutionStoragePtr, "getArrayNComponents", indexParamList);
             auto componentNames = getReturnValue<QVariantList>(solutionStoragePtr, "getComponentNames", indexParamList);
             auto nTuples = getReturnValue<int>(solutionStoragePtr, "getArrayNTuples", indexParamList);
-            auto rawDataByteArray = getReturnValue<QByteArray>(solutionStoragePtr, "getArrayData", indexParamList);
+
+            // Get the data as a Python object to avoid conversion to QByteArray
+            auto rawData = PythonQtObjectPtr{};
+            rawData.setNewRef(PythonQt::self()->callAndReturnPyObject(
+                PythonQt::self()->lookupCallable(solutionStoragePtr, "getArrayData"), indexParamList));
+            if (rawData.isNull()) {
+                MITK_ERROR << "SolutionStorage.getArrayData failed for array '" << name.toStdString() << "'. Skipping";
+                continue;
+            }
 
            try {
                auto solutionData = SolutionData::Pointer{};
                 switch (static_cast<ArrayDataTypeQtWrapper::ArrayDataType>(dataType)) {
                 case ArrayDataTypeQtWrapper::ArrayDataType::Int:
-                    solutionData = makeSolutionData<int32_t>(name.toStdString(), nComponents, componentNames, nTuples, rawDataByteArray);
+                    solutionData = makeSolutionData<int32_t>(name.toStdString(), nComponents, componentNames, nTuples, rawData);
                     break;
                 case ArrayDataTypeQtWrapper::ArrayDataType::Double:
-                    solutionData = makeSolutionData<double>(name.toStdString(), nComponents, componentNames, nTuples, rawDataByteArray);
+                    solutionData = makeSolutionData<double>(name.toStdString(), nComponents, componentNames, nTuples, rawData);
                     break;
                 default:
                     MITK_ERROR << "Unknown data type " << dataType << " received for array '" << name.toStdString() << "'. Skipping";
@@ -2,6 +2,15 @@
 
 #include <gsl.h>
 
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <QSysInfo>
+
+#include <mitkLogMacros.h>
 #include <mitkPythonService.h>
 #include "PythonSolverSetupServiceActivator.h"
 
@@ -26,4 +35,240 @@ inline PythonQtObjectPtr clonePythonObject(PythonQtObjectPtr object)
     Ensures(!result.isNull());
     return result;
 }
+
+namespace detail
+{
+template <typename T>
+struct NumpyTypeTraits {
+};
+
+template <>
+struct NumpyTypeTraits<int32_t> {
+    static char kind() { return 'i'; }
+};
+
+template <>
+struct NumpyTypeTraits<int64_t> {
+    static char kind() { return 'i'; }
+};
+
+template <>
+struct NumpyTypeTraits<double> {
+    static char kind() { return 'f'; }
+};
+
+template <typename T>
+std::string numpyTypeString()
+{
+    return QString("%1%2%3")
+        .arg(QSysInfo::ByteOrder == QSysInfo::LittleEndian ? '<' : '>')
+        .arg(NumpyTypeTraits<T>::kind())
+        .arg(sizeof(T))
+        .toStdString();
+}
+
+inline PyObject* getNumpyArrayMemoryHolderClass()
+{
+    // Objects of this class expose a block of memory through the numpy array interface and keep its
+    // owner alive. numpy.asarray() stores the holder as the base of the array it creates.
+    static PyObject* holderClass = nullptr;
+    if (!holderClass) {
+        const char* code = "class ArrayMemoryHolder(object):\n"
+                           "    def __init__(self, owner, address, shape, typestr, readonly):\n"
+                           "        self.owner = owner\n"
+                           "        self.__array_interface__ = {'version': 3, 'shape': tuple(shape), 'typestr': typestr,\n"
+                           "                                    'data': (address, readonly)}\n";
+
+        PyObject* globals = PyDict_New();
+        if (!globals) {
+            PyErr_Print();
+            return nullptr;
+        }
+        PyDict_SetItemString(globals, "__builtins__", PyEval_GetBuiltins());
+
+        PyObject* runResult = PyRun_String(code, Py_file_input, globals, globals);
+        if (!runResult) {
+            PyErr_Print();
+            Py_DECREF(globals);
+            return nullptr;
+        }
+        Py_DECREF(runResult);
+
+        holderClass = PyDict_GetItemString(globals, "ArrayMemoryHolder");
+        if (!holderClass) {
+            MITK_ERROR << "Failed to define the ArrayMemoryHolder class";
+        }
+        Py_XINCREF(holderClass);
+        Py_DECREF(globals);
+    }
+    return holderClass;
+}
+
+/*!
+ * \brief   Checks whether the buffer elements can be copied to T without conversion.
+ *
+ *  Raw byte buffers (bytes, bytearray) are accepted as well, their contents are assumed to be in
+ *  the native layout of T.
+ */
+template <typename T>
+bool bufferFormatMatches(const Py_buffer& view)
+{
+    std::string format = view.format ? view.format : "B";
+    bool nativeByteOrder = true;
+    if (!format.empty() && std::strchr("@=<>!", format[0])) {
+        nativeByteOrder = format[0] == '@' || format[0] == '=' ||
+                          (format[0] == '<') == (QSysInfo::ByteOrder == QSysInfo::LittleEndian);
+        format.erase(0, 1);
+    }
+
+    if (format.size() != 1 || !nativeByteOrder) {
+        return false;
+    }
+
+    if (view.itemsize == 1 && std::strchr("Bbc", format[0])) {
+        return true;
+    }
+
+    const char* matchingFormats = NumpyTypeTraits<T>::kind() == 'f' ? "efd" : "bhilqn";
+    return view.itemsize == static_cast<Py_ssize_t>(sizeof(T)) && std::strchr(matchingFormats, format[0]);
+}
+} // namespace detail
+
+/*!
+ * \brief   Creates a numpy array which uses the memory owned by a C++ object without copying it.
+ *
+ *  The numpy array keeps a reference to the owner, so the memory stays valid as long as the array
+ *  (or any view of it) is alive in Python.
+ *
+ * \param   owner       The object owning the memory.
+ * \param   data        Pointer to the first element. Must stay valid for the lifetime of the owner.
+ * \param   shape       Dimensions of the C-contiguous array.
+ * \param   readOnly    Whether the Python code is allowed to modify the data.
+ */
+template <typename T, typename OwnerT>
+PythonQtObjectPtr createNumpyArrayView(std::shared_ptr<OwnerT> owner, const T* data, const std::vector<Py_ssize_t>& shape,
+                                       bool readOnly = true)
+{
+    static const char* capsuleName = "crimson.NumpyArrayOwner";
+
+    auto ownerCapsule =
+        PyCapsule_New(new std::shared_ptr<OwnerT>(std::move(owner)), capsuleName, [](PyObject* capsule) {
+            delete static_cast<std::shared_ptr<OwnerT>*>(PyCapsule_GetPointer(capsule, capsuleName));
+        });
+
+    auto holderClass = detail::getNumpyArrayMemoryHolderClass();
+    if (!holderClass) {
+        Py_DECREF(ownerCapsule);
+        return PythonQtObjectPtr{};
+    }
+
+    auto typeString = detail::numpyTypeString<T>();
+
+    auto shapeTuple = PyTuple_New(static_cast<Py_ssize_t>(shape.size()));
+    for (size_t i = 0; i < shape.size(); ++i) {
+        PyTuple_SET_ITEM(shapeTuple, static_cast<Py_ssize_t>(i), PyLong_FromSsize_t(shape[i]));
+    }
+
+    auto holder = PyObject_CallFunction(holderClass, const_cast<char*>("OKOsO"), ownerCapsule,
+                                        static_cast<unsigned long long>(reinterpret_cast<uintptr_t>(data)), shapeTuple,
+                                        typeString.c_str(), readOnly ? Py_True : Py_False);
+    Py_DECREF(ownerCapsule);
+    Py_DECREF(shapeTuple);
+
+    auto result = PythonQtObjectPtr{};
+    if (!holder) {
+        PyErr_Print();
+        return result;
+    }
+
+    auto numpyModule = PythonQt::self()->importModule("numpy");
+    result.setNewRef(PyObject_CallFunctionObjArgs(PythonQt::self()->lookupCallable(numpyModule, "asarray"), holder, nullptr));
+    Py_DECREF(holder);
+
+    if (result.isNull()) {
+        PyErr_Print();
+    }
+    return result;
+}
+
+/*!
+ * \brief   Creates a writable numpy array which takes ownership of the data vector without copying it.
+ */
+template <typename T>
+PythonQtObjectPtr createNumpyArray(std::vector<T> data, const std::vector<Py_ssize_t>& shape)
+{
+    auto owner = std::make_shared<std::vector<T>>(std::move(data));
+    const T* dataPtr = owner->data();
+    return createNumpyArrayView(std::move(owner), dataPtr, shape, false);
+}
+
+/*!
+ * \brief   Creates a shared pointer holding a reference to a VTK object, suitable as an owner for createNumpyArrayView().
+ */
+template <typename VtkT>
+std::shared_ptr<VtkT> shareVtkObject(VtkT* object)
+{
+    object->Register(nullptr);
+    return std::shared_ptr<VtkT>(object, [](VtkT* o) { o->UnRegister(nullptr); });
+}
+
+/*!
+ * \brief   Copies the contents of any Python object supporting the buffer protocol (numpy arrays, bytes, etc.)
+ *  into a contiguous block of memory without element-wise conversion.
+ *
+ * \return  false if the object does not expose a buffer, its element type is not compatible with T
+ *  (see detail::bufferFormatMatches()) or its size is not equal to count elements.
+ */
+template <typename T>
+bool copyFromPythonBuffer(PyObject* object, T* destination, size_t count)
+{
+    Py_buffer view;
+    if (!object || PyObject_GetBuffer(object, &view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0) {
+        PyErr_Clear();
+        return false;
+    }
+
+    bool matches = detail::bufferFormatMatches<T>(view) && static_cast<size_t>(view.len) == count * sizeof(T);
+    if (matches) {
+        std::memcpy(destination, view.buf, count * sizeof(T));
+    }
+    PyBuffer_Release(&view);
+    return matches;
+}
+
+/*!
+ * \brief   Reads any array-like Python object (numpy array, list of numbers, etc.) into a flat vector,
+ *  converting the elements to T on the Python side if necessary.
+ *
+ * \return  false if the object cannot be converted to a numeric array.
+ */
+template <typename T>
+bool copyFromNumpyArray(PythonQtObjectPtr object, std::vector<T>& out)
+{
+    auto numpyModule = PythonQt::self()->importModule("numpy");
+    auto typeString = detail::numpyTypeString<T>();
+
+    auto contiguousArray = PythonQtObjectPtr{};
+    contiguousArray.setNewRef(PyObject_CallFunction(PythonQt::self()->lookupCallable(numpyModule, "ascontiguousarray"),
+                                                    const_cast<char*>("Os"), object.object(), typeString.c_str()));
+    if (contiguousArray.isNull()) {
+        PyErr_Print();
+        return false;
+    }
+
+    Py_buffer view;
+    if (PyObject_GetBuffer(contiguousArray.object(), &view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0) {
+        PyErr_Clear();
+        return false;
+    }
+
+    // ascontiguousarray() has been asked for T, but never reinterpret the memory of anything else
+    bool matches = detail::bufferFormatMatches<T>(view) && view.itemsize == static_cast<Py_ssize_t>(sizeof(T));
+    if (matches) {
+        out.resize(static_cast<size_t>(view.len) / sizeof(T));
+        std::memcpy(out.data(), view.buf, out.size() * sizeof(T));
+    }
+    PyBuffer_Release(&view);
+    return matches;
+}
 } // namespace crimson
\ No newline at end of file
@@ -17,8 +17,12 @@
 
 #include <vtkDistancePolyDataFilter.h>
 #include <vtkPointData.h>
+#include <vtkCellArray.h>
+#include <vtkIdTypeArray.h>
 #include <vtkNew.h>
 
+#include <TaskInputHash.h>
+
 // OpenCASCADE
 #include <OSD.hxx>
 #include <Standard_ErrorHandler.hxx>
@@ -99,6 +103,7 @@
 #include <BSplCLib.hxx>
 #include <chrono>
 #include <numeric>
+#include <atomic>
 
 namespace crimson
 {
@@ -112,6 +117,17 @@ static void setupCatchSystemSignals()
     }
 }
 
+// The property storing the input hash of the task which created the solid
+static const char* solidInputHashPropertyKey = "solidKernel.inputHash";
+
+static mitk::BaseData::Pointer cloneBaseData(const mitk::BaseData::Pointer& data)
+{
+    if (data.IsNull()) {
+        return data;
+    }
+    return dynamic_cast<mitk::BaseData*>(data->Clone().GetPointer());
+}
+
 //=======================================================================
 // function :  PerformPlan
 // purpose  : Construct a plane of filling if exists
@@ -307,6 +323,23 @@ Handle(Geom2d_BSplineCurve) convertAnyPlanarFigureToCurve(mitk::PlanarFigure* fi
 
 #undef tryDynamicConversionFrom
 
+/*!
+ * \brief   Progress indicator used to interrupt long-running OpenCASCADE algorithms when the owning task is cancelled.
+ */
+class OCCProgressIndicator : public Message_ProgressIndicator
+{
+public:
+    Standard_Boolean Show(const Standard_Boolean force = Standard_True) override { return Standard_True; }
+
+    //! Redefines method UserBreak of Progress Indicator
+    virtual Standard_Boolean UserBreak() override { return _userBreak; }
+
+    void setUserBreak(bool userBreak) { _userBreak = userBreak; }
+
+private:
+    std::atomic<bool> _userBreak{false};
+};
+
 //////////////////////////////////////////////////////////////////////////
 // Lofted solid creation
 //////////////////////////////////////////////////////////////////////////
@@ -325,7 +358,14 @@ public:
         , seamEdgeRotation(seamEdgeRotation)
         , preview(preview)
         , interContourDistance(interContourDistance)
+        , progressIndicator(new OCCProgressIndicator)
+    {
+    }
+
+    void cancel() override
     {
+        static_cast<OCCProgressIndicator*>(progressIndicator.Access())->setUserBreak(true);
+        crimson::async::TaskWithResult<mitk::BaseData::Pointer>::cancel();
     }
 
     std::tuple<State, std::string> runTask() override
@@ -378,6 +418,10 @@ public:
             OCC_CATCH_SIGNALS;
 
             for (size_t i = 0; i < contours.size(); ++i) {
+                if (isCancelling()) {
+                    return std::make_tuple(State_Cancelled, std::string("Operation cancelled."));
+                }
+
                 const mitk::PlanarFigure::Pointer& figure = contours[i];
 
                 // Get the point of intersection of vessel path and contour-defined geometry
@@ -507,6 +551,10 @@ public:
                 anAlgo.SetContinuity(GeomAbs_C1);
                 anAlgo.Perform(aLine, aSecGenerator, Standard_True);
 
+                if (isCancelling()) {
+                    return std::make_tuple(State_Cancelled, std::string("Operation cancelled."));
+                }
+
                 if (!anAlgo.IsDone()) {
                     return std::make_tuple(State_Failed, std::string("Lofting algorithm has failed."));
                 }
@@ -605,6 +653,10 @@ public:
 
                 std::vector<double> placementParams;
                 for (size_t i = 0; i < contourEdges.size(); ++i) {
+                    if (isCancelling()) {
+                        return std::make_tuple(State_Cancelled, std::string("Operation cancelled."));
+                    }
+
                     TopoDS_Vertex v;
                     v.Nullify();
                     BRepFill_Section section(BRepBuilderAPI_MakeWire(contourEdges[i]), v, Standard_False, Standard_False);
@@ -659,11 +711,19 @@ public:
 
                     result = previewWire;
                 } else {
+                    if (isCancelling()) {
+                        return std::make_tuple(State_Cancelled, std::string("Operation cancelled."));
+                    }
+
                     shellBuilder2.Build();
                     result = TopoDS::Face(TopExp_Explorer(shellBuilder2.Shape(), TopAbs_FACE).Current());
                 }
             }
 
+            if (isCancelling()) {
+                return std::make_tuple(State_Cancelled, std::string("Operation cancelled."));
+            }
+
             progressMadeSignal(progressLoft);
 
             // Finally, create the output MITK object
@@ -679,7 +739,10 @@ public:
                     sewing.Add(TopoDS::Face(result));
                     sewing.Add(capFaces[0]);
                     sewing.Add(capFaces[1]);
-                    sewing.Perform();
+                    sewing.Perform(progressIndicator);
+                    if (isCancelling()) {
+                        return std::make_tuple(State_Cancelled, std::string("Operation cancelled."));
+                    }
                     result = BRepBuilderAPI_MakeSolid(TopoDS::Shell(sewing.SewedShape()));
                 } else {
                     MITK_ERROR << "Failed to create the cap faces";
@@ -706,6 +769,7 @@ public:
                 }
 
                 data->getSurfaceRepresentation(); // Force meshing - for execution in different thread
+                data->GetPropertyList()->SetStringProperty(solidInputHashPropertyKey, inputHash().c_str());
                 output = data.GetPointer();
             } else {
                 // Create contour model set for preview
@@ -751,6 +815,11 @@ public:
         } catch (...) {
             progressMadeSignal(progressLeft);
 
+            // The OCC algorithms raise an exception when interrupted through the progress indicator
+            if (isCancelling()) {
+                return std::make_tuple(State_Cancelled, std::string("Operation cancelled."));
+            }
+
             std::string errorMessage = "Exception caught during lofting\n";
             Handle(Standard_Failure) Fail = Standard_Failure::Caught();
             std::string occErrorMessage(Fail->GetMessageString());
@@ -762,6 +831,47 @@ public:
         }
     }
 
+    std::string inputHash() const override
+    {
+        // Preview results are cheap to compute and are not memoized
+        if (preview) {
+            return std::string();
+        }
+
+        async::TaskInputHash hash;
+        hash.add(vesselPath->getVesselUID());
+        hash.add(static_cast<int64_t>(vesselPath->controlPointsCount()));
+        for (VesselPathAbstractData::IdType i = 0; i < vesselPath->controlPointsCount(); ++i) {
+            VesselPathAbstractData::PointType p = vesselPath->getControlPoint(i);
+            hash.add(p[0]).add(p[1]).add(p[2]);
+        }
+
+        hash.add(static_cast<uint64_t>(contours.size()));
+        for (const mitk::PlanarFigure::Pointer& figure : contours) {
+            hash.add(figure->GetNameOfClass());
+
+            float contourParameterValue = 0;
+            figure->GetPropertyList()->GetFloatProperty("lofting.parameterValue", contourParameterValue);
+            hash.add(contourParameterValue);
+
+            const mitk::PlaneGeometry* figureGeometry = figure->GetPlaneGeometry();
+            for (int i = 0; i < 3; ++i) {
+                hash.add(figureGeometry->GetOrigin()[i]);
+                hash.add(figureGeometry->GetAxisVector(0)[i]);
+                hash.add(figureGeometry->GetAxisVector(1)[i]);
+            }
+
+            hash.add(figure->GetNumberOfControlPoints());
+            for (unsigned int i = 0; i < figure->GetNumberOfControlPoints(); ++i) {
+                hash.add(figure->GetControlPoint(i)[0]).add(figure->GetControlPoint(i)[1]);
+            }
+        }
+
+        hash.add(useInflowAsWall).add(useOutflowAsWall).add(loftingAlgorithm).add(seamEdgeRotation);
+
+        return hash.hexDigest();
+    }
+
     double getHighestRisk(const crimson::VesselPathAbstractData* vesselPath, mitk::PlanarFigure* figure,
                           mitk::Point2D& maxRiskPoint)
     {
@@ -832,6 +942,9 @@ public:
         return maxRisk;
     }
 
+protected:
+    mitk::BaseData::Pointer copyResult(const mitk::BaseData::Pointer& result) const override { return cloneBaseData(result); }
+
 private:
     const crimson::VesselPathAbstractData* vesselPath;
     const crimson::ISolidModelKernel::ContourSet contours;
@@ -841,6 +954,7 @@ private:
     double seamEdgeRotation;
     bool preview;
     double interContourDistance;
+    Handle_Message_ProgressIndicator progressIndicator;
 };
 
 std::shared_ptr<async::TaskWithResult<mitk::BaseData::Pointer>>
@@ -894,40 +1008,6 @@ bool isIntersecting(OCCBRepData* shape1, OCCBRepData* shape2, double /*tolerance
     return (scalars->GetRange()[0] * scalars->GetRange()[1] <= 0) && (scalars2->GetRange()[0] * scalars2->GetRange()[1] <= 0);
 }
 
-class OCCProgressIndicator : public Message_ProgressIndicator
-{
-public:
-    void Reset() override { MITK_INFO << "Reset"; }
-
-    //! Defines method Show of Progress Indicator
-    Standard_Boolean Show(const Standard_Boolean force = Standard_True) override
-    {
-        MITK_INFO << "Show: ";
-
-        Standard_Real min, max, step;
-        Standard_Boolean isInf;
-        GetScale(min, max, step, isInf);
-        MITK_INFO << "  Scale: "
-                  << "max = " << max << " min = " << min << " step = " << step << " isInf = " << isInf;
-
-        MITK_INFO << "  NbScopes = " << GetNbScopes();
-
-        MITK_INFO << "  Position = " << GetPosition();
-
-        MITK_INFO << "  Value = " << GetValue();
-
-        return Standard_True;
-    }
-
-    //! Redefines method UserBreak of Progress Indicator
-    virtual Standard_Boolean UserBreak() override { return _userBreak; }
-
-    void setUserBreak(bool userBreak) { _userBreak = userBreak; }
-
-private:
-    bool _userBreak = false;
-};
-
 class BlendingTask : public crimson::async::TaskWithResult<mitk::BaseData::Pointer>
 {
 public:
@@ -940,6 +1020,7 @@ public:
         , filletingInfo(filletingInfo.begin(), filletingInfo.end())
         , useParallelBlending(useParallelBlending)
         , progressIndicator(new OCCProgressIndicator)
+        , blendInputHash(computeInputHash()) // before runTask() reorders booleanOperations
     {
         Expects(solidDatas.size() > 0);
 
@@ -1221,6 +1302,7 @@ public:
                     toolsList.Append(shapes[1]);
                     bop->SetTools(toolsList);
 
+                    bop->SetProgressIndicator(progressIndicator);
                     bop->Build();
 
                     _updateAttachedInformationAfterBooleanOperation<TopAbs_FACE>(*bop, faceToIdMap);
@@ -1260,6 +1342,10 @@ public:
 
                     MITK_INFO << "Adding disconnected component " << std::get<1>(shapeAndName) << " to the result.";
 
+                    if (isCancelling()) {
+                        return std::make_tuple(State_Cancelled, std::string("Operation cancelled."));
+                    }
+
                     if (fuseShape.IsNull()) {
                         fuseShape = std::get<0>(shapeAndName);
                     } else {
@@ -1273,6 +1359,7 @@ public:
                         toolsList.Append(std::get<0>(shapeAndName));
                         bop.SetTools(toolsList);
 
+                        bop.SetProgressIndicator(progressIndicator);
                         bop.Build();
 
                         _updateAttachedInformationAfterBooleanOperation<TopAbs_FACE>(bop, faceToIdMap);
@@ -1410,11 +1497,20 @@ public:
                 return std::make_tuple(State_Cancelled, std::string("Operation cancelled."));
             }
 
+            if (!blendInputHash.empty()) {
+                data->GetPropertyList()->SetStringProperty(solidInputHashPropertyKey, blendInputHash.c_str());
+            }
+
             setResult(data.GetPointer());
             return std::make_tuple(State_Finished, std::string("Blending finished successfully."));
         } catch (...) {
             progressMadeSignal(progressLeft);
 
+            // The OCC algorithms raise an exception when interrupted through the progress indicator
+            if (isCancelling()) {
+                return std::make_tuple(State_Cancelled, std::string("Operation cancelled."));
+            }
+
             std::string errorMessage = "Exception caught during blending\n";
             Handle(Standard_Failure) Fail = Standard_Failure::Caught();
             std::string occErrorMessage(Fail->GetMessageString());
@@ -1556,13 +1652,60 @@ public:
         }
     }
 
+public:
+    std::string inputHash() const override { return blendInputHash; }
+
+protected:
+    mitk::BaseData::Pointer copyResult(const mitk::BaseData::Pointer& result) const override { return cloneBaseData(result); }
+
 private:
+    // Hashes the inputs as given to the constructor; runTask() reorders the boolean operations, so this must not be
+    // called afterwards
+    std::string computeInputHash() const
+    {
+        async::TaskInputHash hash;
+
+        hash.add(static_cast<uint64_t>(solidDatas.size()));
+        for (const auto& uidSolidPair : solidDatas) {
+            std::string solidHash = ISolidModelKernel::solidContentHash(uidSolidPair.second);
+            if (solidHash.empty()) {
+                return std::string();
+            }
+            hash.add(uidSolidPair.first).add(solidHash);
+        }
+
+        hash.add(static_cast<uint64_t>(booleanOperations.size()));
+        for (const VesselForestData::BooleanOperationInfo& bopInfo : booleanOperations) {
+            hash.add(bopInfo.vessels.first).add(bopInfo.vessels.second).add(bopInfo.bop);
+            hash.add(bopInfo.removesFace).add(bopInfo.removedFaceOwnerUID);
+        }
+
+        // The fillet information is stored in an unordered map - sort it to make the hash deterministic
+        std::vector<std::tuple<std::string, std::string, double>> sortedFilletingInfo;
+        for (const auto& filletInfoPair : filletingInfo) {
+            sortedFilletingInfo.emplace_back(std::min(filletInfoPair.first.first, filletInfoPair.first.second),
+                                             std::max(filletInfoPair.first.first, filletInfoPair.first.second),
+                                             filletInfoPair.second);
+        }
+        std::sort(sortedFilletingInfo.begin(), sortedFilletingInfo.end());
+
+        hash.add(static_cast<uint64_t>(sortedFilletingInfo.size()));
+        for (const auto& filletInfo : sortedFilletingInfo) {
+            hash.add(std::get<0>(filletInfo)).add(std::get<1>(filletInfo)).add(std::get<2>(filletInfo));
+        }
+
+        hash.add(useParallelBlending);
+
+        return hash.hexDigest();
+    }
+
     const std::map<VesselPathAbstractData::VesselPathUIDType, mitk::BaseData::Pointer> solidDatas;
     std::vector<VesselForestData::BooleanOperationInfo> booleanOperations; // non-const - order may be changed
     const VesselForestData::OrderIndependentVesselPathMap<double> filletingInfo;
     bool useParallelBlending;
 
     Handle_Message_ProgressIndicator progressIndicator;
+    const std::string blendInputHash;
 };
 
 std::shared_ptr<async::TaskWithResult<mitk::BaseData::Pointer>> ISolidModelKernel::createBlendTask(
@@ -1654,6 +1797,54 @@ std::tuple<double, bool, int> ISolidModelKernel::intersectionEdgeLength(mitk::Ba
     }
 }
 
+std::string ISolidModelKernel::solidContentHash(mitk::BaseData::Pointer solid)
+{
+    auto solidData = dynamic_cast<SolidData*>(solid.GetPointer());
+    if (!solidData) {
+        return std::string();
+    }
+
+    // Solids created by memoizable tasks store the hash of their inputs
+    std::string storedHash;
+    if (solidData->GetPropertyList()->GetStringProperty(solidInputHashPropertyKey, storedHash) && !storedHash.empty()) {
+        return storedHash;
+    }
+
+    async::TaskInputHash hash;
+
+    vtkPolyData* pd = solidData->getSurfaceRepresentation()->GetVtkPolyData();
+    if (pd && pd->GetPoints()) {
+        vtkDataArray* points = pd->GetPoints()->GetData();
+        hash.add(static_cast<int64_t>(points->GetNumberOfTuples()));
+        hash.addBytes(points->GetVoidPointer(0),
+                      points->GetNumberOfTuples() * points->GetNumberOfComponents() * points->GetDataTypeSize());
+    }
+    if (pd && pd->GetPolys()) {
+        vtkIdTypeArray* connectivity = pd->GetPolys()->GetData();
+        hash.add(static_cast<int64_t>(connectivity->GetNumberOfTuples()));
+        hash.addBytes(connectivity->GetVoidPointer(0), connectivity->GetNumberOfTuples() * sizeof(vtkIdType));
+    }
+
+    const FaceIdentifierMap& faceIdentifierMap = solidData->getFaceIdentifierMap();
+    hash.add(faceIdentifierMap.getNumberOfModelFaces());
+    for (int i = 0; i < faceIdentifierMap.getNumberOfModelFaces(); ++i) {
+        auto faceIdentifier = faceIdentifierMap.getFaceIdentifierForModelFace(i);
+        if (!faceIdentifier) {
+            hash.add(-1);
+            continue;
+        }
+        hash.add(faceIdentifier->get().faceType);
+        hash.add(static_cast<uint64_t>(faceIdentifier->get().parentSolidIndices.size()));
+        for (const std::string& parentIndex : faceIdentifier->get().parentSolidIndices) {
+            hash.add(parentIndex);
+        }
+    }
+
+    hash.add(solidData->inflowFaceId()).add(solidData->outflowFaceId());
+
+    return hash.hexDigest();
+}
+
 mitk::ScalarType ISolidModelKernel::solidVolume(mitk::BaseData::Pointer solid)
 {
     setupCatchSystemSignals();
@@ -78,6 +78,14 @@ public:
     static mitk::ScalarType solidVolume(mitk::BaseData::Pointer solid);
 
     static mitk::ScalarType contourArea(mitk::PlanarFigure::Pointer figure);
+
+    /*!
+     * \brief   Computes the content hash of a solid model to be used as a part of the input hash of
+     *  the tasks operating on solid models (see async::TaskWithResult::inputHash()).
+     *
+     * \return  The hash or an empty string if the data is not a solid model.
+     */
+    static std::string solidContentHash(mitk::BaseData::Pointer solid);
 };
 
 } // namespace crimson
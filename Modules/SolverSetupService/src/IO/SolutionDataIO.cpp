@@ -10,6 +10,10 @@
 
 #include <QDataStream>
 #include <QFile>
+#include <QSysInfo>
+
+#include <algorithm>
+#include <cstring>
 
 REGISTER_IOUTILDATA_SERIALIZER(SolutionData, crimson::SolverSetupServiceIOMimeTypes::SOLUTIONDATA_DEFAULT_EXTENSION())
 
@@ -33,13 +37,13 @@ vtkSmartPointer<vtkDataArray> make_vtk_array();
 template <>
 vtkSmartPointer<vtkDataArray> make_vtk_array<int>()
 {
-    return vtkIntArray::New();
+    return vtkSmartPointer<vtkIntArray>::New();
 }
 
 template <>
 vtkSmartPointer<vtkDataArray> make_vtk_array<double>()
 {
-    return vtkDoubleArray::New();
+    return vtkSmartPointer<vtkDoubleArray>::New();
 }
 
 template <typename ArrayT, typename StreamT = ArrayT>
@@ -62,42 +66,53 @@ vtkSmartPointer<vtkDataArray> readDataArrayFromStream(QDataStream& stream, const
     return dataArray;
 }
 
-template <typename ArrayT>
-ArrayT get(vtkVariant variant);
-
-template <>
-int get<int>(vtkVariant variant)
-{
-    return variant.ToInt();
-}
+// Marks the files storing the array data as a single raw block. Files written by the earlier versions
+// start with the data type instead, which is always a small positive number.
+const qint64 binaryFormatMagic = Q_INT64_C(0x43534F4C42494E31); // "CSOLBIN1"
 
-template <>
-double get<double>(vtkVariant variant)
+vtkSmartPointer<vtkDataArray> makeDataArray(qint64 dataType)
 {
-    return variant.ToDouble();
+    switch (dataType) {
+    case VTK_DOUBLE:
+        return make_vtk_array<double>();
+    case VTK_INT:
+        return make_vtk_array<int>();
+    default:
+        return nullptr;
+    }
 }
 
-template <typename ArrayT, typename StreamT = ArrayT>
-void writeDataArrayToStream(QDataStream& stream, vtkDataArray* dataArray)
+void swapByteOrder(char* data, qint64 nValues, int valueSize)
 {
-    for (int i = 0; i < dataArray->GetNumberOfComponents() * dataArray->GetNumberOfTuples(); ++i) {
-        stream << static_cast<StreamT>(get<ArrayT>(dataArray->GetVariantValue(i)));
+    for (qint64 i = 0; i < nValues; ++i) {
+        std::reverse(data + i * valueSize, data + (i + 1) * valueSize);
     }
 }
+
 }
 
 std::vector<itk::SmartPointer<mitk::BaseData>> SolutionDataIO::Read()
 {
     QFile file{QString::fromStdString(GetLocalFileName())};
-    file.open(QIODevice::ReadOnly);
+    if (!file.open(QIODevice::ReadOnly)) {
+        mitkThrow() << "Failed to open file " << GetLocalFileName();
+    }
     QDataStream inStream{&file};
 
-    auto dataType = qint64{0};
+    auto magic = qint64{0};
+    inStream >> magic;
+
+    if (magic == detail::binaryFormatMagic) {
+        return {itk::SmartPointer<mitk::BaseData>{SolutionData::New(_readBinaryDataArray(file, inStream)).GetPointer()}};
+    }
+
+    // Legacy format - every value is stored separately
+    auto dataType = magic;
     auto arrayName = QString{};
     auto nComponents = qint64{0};
     auto nTuples = qint64{0};
 
-    inStream >> dataType >> arrayName >> nComponents >> nTuples;
+    inStream >> arrayName >> nComponents >> nTuples;
 
     if (inStream.status() != QDataStream::Ok) {
         mitkThrow() << "Failed to read header data from file " << GetLocalFileName();
@@ -123,6 +138,59 @@ std::vector<itk::SmartPointer<mitk::BaseData>> SolutionDataIO::Read()
     return {itk::SmartPointer<mitk::BaseData>{SolutionData::New(data).GetPointer()}};
 }
 
+vtkSmartPointer<vtkDataArray> SolutionDataIO::_readBinaryDataArray(QFile& file, QDataStream& inStream)
+{
+    auto dataType = qint64{0};
+    auto arrayName = QString{};
+    auto nComponents = qint64{0};
+    auto nTuples = qint64{0};
+    auto littleEndian = false;
+    auto dataOffset = qint64{0};
+
+    inStream >> dataType >> arrayName >> nComponents >> nTuples >> littleEndian >> dataOffset;
+
+    if (inStream.status() != QDataStream::Ok) {
+        mitkThrow() << "Failed to read header data from file " << GetLocalFileName();
+    }
+
+    auto data = detail::makeDataArray(dataType);
+    if (!data) {
+        mitkThrow() << "Unknown data type " << dataType << " read from file " << GetLocalFileName();
+    }
+
+    data->SetNumberOfComponents(gsl::narrow_cast<int>(nComponents));
+    data->SetNumberOfTuples(gsl::narrow_cast<vtkIdType>(nTuples));
+    data->SetName(arrayName.toStdString().c_str());
+
+    auto nValues = nComponents * nTuples;
+    auto valueSize = data->GetDataTypeSize();
+    auto nBytes = nValues * valueSize;
+
+    if (dataOffset + nBytes > file.size()) {
+        mitkThrow() << "Failed to read array data from file " << GetLocalFileName() << ": file is truncated";
+    }
+
+    if (nBytes > 0) {
+        auto destination = static_cast<char*>(data->GetVoidPointer(0));
+
+        // Map the data block instead of reading it through the stream to avoid an intermediate copy
+        uchar* mappedData = file.map(dataOffset, nBytes);
+        if (mappedData) {
+            std::memcpy(destination, mappedData, nBytes);
+            file.unmap(mappedData);
+        }
+        else if (!file.seek(dataOffset) || file.read(destination, nBytes) != nBytes) {
+            mitkThrow() << "Failed to read array data from file " << GetLocalFileName();
+        }
+
+        if (littleEndian != (QSysInfo::ByteOrder == QSysInfo::LittleEndian)) {
+            detail::swapByteOrder(destination, nValues, valueSize);
+        }
+    }
+
+    return data;
+}
+
 void SolutionDataIO::Write()
 {
     auto solutionData = static_cast<const SolutionData*>(this->GetInput());
@@ -131,26 +199,37 @@ void SolutionDataIO::Write()
         mitkThrow() << "Input solution data has not been set!";
     }
 
+    auto dataArray = solutionData->getArrayData();
+
+    if (dataArray->GetDataType() != VTK_DOUBLE && dataArray->GetDataType() != VTK_INT) {
+        mitkThrow() << "Unsupported solution data type";
+    }
+
     QFile file{QString::fromStdString(GetOutputLocation())};
-    file.open(QIODevice::WriteOnly);
+    if (!file.open(QIODevice::WriteOnly)) {
+        mitkThrow() << "Failed to open file " << GetOutputLocation() << " for writing";
+    }
     QDataStream outStream{&file};
 
-    auto dataArray = solutionData->getArrayData();
-
+    // The header is written through QDataStream, the values are written as a single raw block in native byte order
+    outStream << detail::binaryFormatMagic;
     outStream << qint64{dataArray->GetDataType()};
     outStream << QString::fromLatin1(dataArray->GetName());
     outStream << qint64{dataArray->GetNumberOfComponents()};
     outStream << qint64{dataArray->GetNumberOfTuples()};
+    outStream << (QSysInfo::ByteOrder == QSysInfo::LittleEndian);
 
-    switch (dataArray->GetDataType()) {
-    case VTK_DOUBLE:
-        detail::writeDataArrayToStream<double>(outStream, dataArray);
-        break;
-    case VTK_INT:
-        detail::writeDataArrayToStream<int, qint64>(outStream, dataArray);
-        break;
-    default:
-        mitkThrow() << "Unsupported solution data type";
+    // The data offset includes the size of the offset value itself
+    auto dataOffset = file.pos() + static_cast<qint64>(sizeof(qint64));
+    outStream << dataOffset;
+
+    auto nBytes = qint64{dataArray->GetNumberOfComponents()} * dataArray->GetNumberOfTuples() * dataArray->GetDataTypeSize();
+    if (nBytes > 0 && file.write(static_cast<const char*>(dataArray->GetVoidPointer(0)), nBytes) != nBytes) {
+        mitkThrow() << "Failed to write array data to file " << GetOutputLocation();
+    }
+
+    if (outStream.status() != QDataStream::Ok) {
+        mitkThrow() << "Failed to write solution data to file " << GetOutputLocation();
     }
 }
 }
\ No newline at end of file
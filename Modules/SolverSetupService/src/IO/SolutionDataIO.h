@@ -2,6 +2,12 @@
 
 #include <mitkAbstractFileIO.h>
 
+#include <vtkDataArray.h>
+#include <vtkSmartPointer.h>
+
+class QDataStream;
+class QFile;
+
 namespace crimson {
 
 /*! \brief    A class handling IO of SolutionData. */
@@ -16,6 +22,9 @@ public:
 protected:
     SolutionDataIO(const SolutionDataIO&) = default;
     AbstractFileIO* IOClone() const override { return new SolutionDataIO(*this); }
+
+private:
+    vtkSmartPointer<vtkDataArray> _readBinaryDataArray(QFile& file, QDataStream& inStream);
 };
 
 
@@ -3,6 +3,7 @@ set(SRC_CPP_FILES
   QAsyncTaskAdapter.cpp
   CreateDataNodeAsyncTask.cpp
   CompositeTask.cpp
+  BaseDataTaskResultDiskStore.cpp
 )
 
 set(INTERNAL_CPP_FILES
@@ -2,6 +2,6 @@ set(Plugin-Name "AsyncTaskyManager")
 set(Plugin-Version "0.1")
 set(Plugin-Vendor "KCL")
 set(Plugin-ContactAddress "")
-set(Require-Plugin org.mitk.core.services uk.ac.kcl.HierarchyManager)
+set(Require-Plugin org.blueberry.core.runtime org.mitk.core.services uk.ac.kcl.HierarchyManager)
 set(Plugin-ActivationPolicy eager)
 
@@ -2,6 +2,10 @@
 #include <set>
 
 #include "AsyncTaskManager.h"
+#include "BaseDataTaskResultDiskStore.h"
+
+#include <TaskResultCache.h>
+#include <TaskProfiler.h>
 
 #include <mitkLogMacros.h>
 #include <mitkProgressBar.h>
@@ -73,6 +77,8 @@ bool AsyncTaskManager::addTask(const std::shared_ptr<QAsyncTaskAdapter>& task, c
     connect(task.get(), &QAsyncTaskAdapter::progressMade, this, &AsyncTaskManager::globalProgressMade);
 
     _tasks[taskUid] = task;
+    task->getTask()->setProfileName(task->getDescription());
+    task->getTask()->markQueued();
 
     emit taskAdded(taskUid);
 
@@ -134,8 +140,6 @@ void AsyncTaskManager::handleTaskStateChange(async::Task::State state, QString m
     if (_findTaskUIDBySignalSender(sender(), uid)) {
         emit taskStateChanged(uid, state, message);
         if (async::Task::isStateTerminal(state)) {
-            auto taskFinishedTime = std::chrono::high_resolution_clock::now();
-
             // If the task requires sequential executation - try start the next task in queue
             std::shared_ptr<QAsyncTaskAdapter> taskPtr = _tasks[uid];
             if (taskPtr->getSequentialExecutionTag() != -1) {
@@ -149,22 +153,26 @@ void AsyncTaskManager::handleTaskStateChange(async::Task::State state, QString m
             }
 
             if (state == crimson::async::Task::State::State_Finished) {
-                MITK_INFO << taskPtr->getDescription() << " successfully finished in " 
-                    << std::chrono::duration_cast<std::chrono::milliseconds>(taskFinishedTime - _taskStartTimes[taskPtr.get()]).count() / 1000.0 << " seconds";
+                async::TaskProfileRecord profile = taskPtr->getTask()->getProfile();
+                MITK_INFO << taskPtr->getDescription() << " successfully finished in " << profile.runSeconds() 
+                    << " seconds (waited in queue for " << profile.queueWaitSeconds() << " seconds)";
+            }
+
+            if (state == crimson::async::Task::State::State_Cancelled) {
+                async::TaskProfileRecord profile = taskPtr->getTask()->getProfile();
+                MITK_INFO << taskPtr->getDescription() << " cancelled " << profile.cancellationLatencySeconds()
+                    << " seconds after the cancellation request";
             }
 
             globalProgressMade(taskPtr->stepsTotal() - taskPtr->stepsMade());
 
             emit taskCompleted(uid, state, message);
 
-            _taskStartTimes.erase(taskPtr.get());
             _tasks.erase(uid);
 
             disconnect(taskPtr.get(), &QAsyncTaskAdapter::taskStateChanged, this, &AsyncTaskManager::handleTaskStateChange);
             disconnect(taskPtr.get(), &QAsyncTaskAdapter::progressStepsAdded, this, &AsyncTaskManager::globalProgressAddSteps);
             disconnect(taskPtr.get(), &QAsyncTaskAdapter::progressMade, this, &AsyncTaskManager::globalProgressMade);
-        } else if (state == async::Task::State_Running) {
-            _taskStartTimes[_tasks[uid].get()] = std::chrono::high_resolution_clock::now();
         }
     }
 }
@@ -197,6 +205,50 @@ std::shared_ptr<QAsyncTaskAdapter> AsyncTaskManager::findTask(const TaskUID& id)
     return iter->second;
 }
 
+void AsyncTaskManager::setResultCacheCapacity(size_t capacity)
+{
+    async::TaskResultCache::getInstance().setCapacity(capacity);
+}
+
+void AsyncTaskManager::setResultCacheDirectory(const QString& directory)
+{
+    if (directory.isEmpty()) {
+        async::TaskResultCache::getInstance().setDiskStore(nullptr);
+    }
+    else {
+        async::TaskResultCache::getInstance().setDiskStore(std::make_shared<BaseDataTaskResultDiskStore>(directory));
+    }
+}
+
+void AsyncTaskManager::clearResultCache()
+{
+    async::TaskResultCache::getInstance().clear();
+}
+
+void AsyncTaskManager::setProfilingEnabled(bool enabled)
+{
+    async::TaskProfiler::getInstance().setEnabled(enabled);
+}
+
+bool AsyncTaskManager::isProfilingEnabled() const
+{
+    return async::TaskProfiler::getInstance().isEnabled();
+}
+
+bool AsyncTaskManager::exportTaskTrace(const QString& fileName) const
+{
+    if (!async::TaskProfiler::getInstance().exportChromeTrace(fileName.toStdString())) {
+        MITK_ERROR << "Failed to write task trace to " << fileName.toStdString();
+        return false;
+    }
+    return true;
+}
+
+QString AsyncTaskManager::getTaskProfileSummary() const
+{
+    return QString::fromStdString(async::TaskProfiler::getInstance().summary());
+}
+
 bool AsyncTaskManager::_findTaskUIDBySignalSender(QObject* sender, TaskUID& uid)
 {
     for (const std::pair<TaskUID, std::shared_ptr<QAsyncTaskAdapter>>& uidTaskPtrPair : _tasks) {
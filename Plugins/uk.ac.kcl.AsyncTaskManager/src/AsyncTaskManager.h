@@ -2,7 +2,6 @@
 
 #include <map>
 #include <queue>
-#include <chrono>
 
 #include "QAsyncTaskAdapter.h"
 
@@ -54,6 +53,46 @@ public:
      */
     std::shared_ptr<QAsyncTaskAdapter> findTask(const TaskUID& id);
 
+    /*! \name Task result memoization */
+    ///@{ 
+    /*!
+     * \brief   Sets the maximum number of task results kept in memory. 0 disables the memoization.
+     *  Set at plugin start-up from the "result cache capacity" preference.
+     */
+    void setResultCacheCapacity(size_t capacity);
+
+    /*!
+     * \brief   Sets the directory for the on-disk result cache. An empty string (the default) disables the on-disk cache.
+     *  Set at plugin start-up from the "result cache directory" preference.
+     */
+    void setResultCacheDirectory(const QString& directory);
+
+    /*!
+     * \brief   Removes all the memoized task results from memory.
+     */
+    void clearResultCache();
+    ///@} 
+
+    /*! \name Task profiling */
+    ///@{ 
+    /*!
+     * \brief   Enables or disables the collection of task timing records (queue wait, run time,
+     *  progress and cancellation latency).
+     */
+    void setProfilingEnabled(bool enabled);
+    bool isProfilingEnabled() const;
+
+    /*!
+     * \brief   Exports the collected task timing records as Chrome trace-event JSON.
+     */
+    bool exportTaskTrace(const QString& fileName) const;
+
+    /*!
+     * \brief   Gets the aggregate summary of the collected task timing records.
+     */
+    QString getTaskProfileSummary() const;
+    ///@} 
+
 signals:
     void taskAdded(const crimson::AsyncTaskManager::TaskUID& taskUid);
     void taskStateChanged(const crimson::AsyncTaskManager::TaskUID& taskUid, crimson::async::Task::State newState, QString message);
@@ -80,7 +119,6 @@ private:
     static AsyncTaskManager* _instance;
 
     std::map<TaskUID, std::shared_ptr<QAsyncTaskAdapter>> _tasks;
-    std::map<const QAsyncTaskAdapter*, std::chrono::high_resolution_clock::time_point> _taskStartTimes;
     std::map<int, std::queue<std::shared_ptr<QAsyncTaskAdapter>>> _sequentialTasks;
 };
 
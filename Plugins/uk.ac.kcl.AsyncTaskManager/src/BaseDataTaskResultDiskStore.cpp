@@ -0,0 +1,76 @@
+#include "BaseDataTaskResultDiskStore.h"
+
+#include <TaskInputHash.h>
+
+#include <mitkBaseData.h>
+#include <mitkIOUtil.h>
+#include <mitkFileWriterSelector.h>
+#include <mitkLogMacros.h>
+
+#include <QDir>
+#include <QMutexLocker>
+
+namespace crimson {
+
+BaseDataTaskResultDiskStore::BaseDataTaskResultDiskStore(const QString& directory)
+    : _directory(directory)
+{
+    QDir().mkpath(_directory);
+}
+
+QString BaseDataTaskResultDiskStore::_fileNameBase(const std::string& key) const
+{
+    // The cache keys may contain characters which are not allowed in file names
+    return QString::fromStdString(async::TaskInputHash().add(key).hexDigest());
+}
+
+bool BaseDataTaskResultDiskStore::save(const std::string& key, const boost::any& result)
+{
+    const mitk::BaseData::Pointer* data = boost::any_cast<mitk::BaseData::Pointer>(&result);
+    if (!data || data->IsNull()) {
+        return false;
+    }
+
+    try {
+        mitk::FileWriterSelector writerSelector(data->GetPointer());
+        std::vector<std::string> extensions = writerSelector.GetDefault().GetMimeType().GetExtensions();
+        if (extensions.empty()) {
+            return false;
+        }
+
+        QString filePath = QDir(_directory).filePath(_fileNameBase(key) + "." + QString::fromStdString(extensions[0]));
+
+        QMutexLocker lock(&_mutex);
+        mitk::IOUtil::Save(data->GetPointer(), filePath.toStdString());
+    }
+    catch (std::exception& e) {
+        MITK_WARN << "Failed to store task result in cache: " << e.what();
+        return false;
+    }
+
+    return true;
+}
+
+boost::optional<boost::any> BaseDataTaskResultDiskStore::load(const std::string& key)
+{
+    QMutexLocker lock(&_mutex);
+
+    QStringList candidates = QDir(_directory).entryList(QStringList{_fileNameBase(key) + ".*"}, QDir::Files);
+    if (candidates.empty()) {
+        return boost::none;
+    }
+
+    try {
+        std::vector<mitk::BaseData::Pointer> loadedData = mitk::IOUtil::Load(QDir(_directory).filePath(candidates[0]).toStdString());
+        if (loadedData.empty() || loadedData[0].IsNull()) {
+            return boost::none;
+        }
+        return boost::any(loadedData[0]);
+    }
+    catch (std::exception& e) {
+        MITK_WARN << "Failed to load task result from cache: " << e.what();
+        return boost::none;
+    }
+}
+
+}
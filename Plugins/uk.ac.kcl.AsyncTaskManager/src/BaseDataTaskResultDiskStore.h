@@ -0,0 +1,40 @@
+#pragma once
+
+#include "uk_ac_kcl_AsyncTaskManager_Export.h"
+
+#include <TaskResultCache.h>
+
+#include <QString>
+#include <QMutex>
+
+namespace crimson {
+
+/*!
+ * \brief   On-disk store for the memoized task results of type mitk::BaseData::Pointer.
+ *
+ *  The results are written using the MITK IO services, therefore only the data types which have
+ *  a registered writer and reader can be stored.
+ */
+class ASYNCTASKMANAGER_EXPORT BaseDataTaskResultDiskStore : public async::ITaskResultDiskStore {
+public:
+    /*!
+     * \brief   Constructor.
+     *
+     * \param   directory   The directory to store the results in. Created if it does not exist.
+     */
+    BaseDataTaskResultDiskStore(const QString& directory);
+
+    // ITaskResultDiskStore
+    bool save(const std::string& key, const boost::any& result) override;
+    boost::optional<boost::any> load(const std::string& key) override;
+
+    const QString& getDirectory() const { return _directory; }
+
+private:
+    QString _fileNameBase(const std::string& key) const;
+
+    QString _directory;
+    QMutex _mutex;
+};
+
+}
@@ -3,18 +3,73 @@
 #include "AsyncTaskManager.h"
 // #include "AsyncTaskManagerView.h"
 
+#include <algorithm>
+
 ctkPluginContext* uk_ac_kcl_AsyncTaskManager_Activator::PluginContext;
 
+const QString uk_ac_kcl_AsyncTaskManager_Activator::preferenceNodeName = "/uk.ac.kcl.AsyncTaskManager";
+const QString uk_ac_kcl_AsyncTaskManager_Activator::resultCacheCapacityKeyName = "result cache capacity";
+const QString uk_ac_kcl_AsyncTaskManager_Activator::resultCacheDirectoryKeyName = "result cache directory";
+
+namespace {
+// Number of task results (e.g. blended solids or meshes) kept in memory unless overridden in the preferences
+const int defaultResultCacheCapacity = 16;
+}
+
 void uk_ac_kcl_AsyncTaskManager_Activator::start(ctkPluginContext* context)
 {
     PluginContext = context;
     crimson::AsyncTaskManager::init();
 
+    // Setup the task result cache from preferences
+    _prefServiceTracker = std::make_unique<ctkServiceTracker<berry::IPreferencesService*>>(context);
+    _prefServiceTracker->open();
+
+    auto prefs = this->_getPreferences().Cast<berry::IBerryPreferences>();
+    if (prefs.IsNotNull()) {
+        prefs->OnChanged.AddListener(
+            berry::MessageDelegate1<uk_ac_kcl_AsyncTaskManager_Activator, const berry::IBerryPreferences*>(
+                this, &uk_ac_kcl_AsyncTaskManager_Activator::_preferencesChanged));
+
+        _preferencesChanged(prefs.GetPointer());
+    }
+    else {
+        crimson::AsyncTaskManager::getInstance()->setResultCacheCapacity(defaultResultCacheCapacity);
+    }
+
 //    BERRY_REGISTER_EXTENSION_CLASS(AsyncTaskManagerView, context)
 }
 
 void uk_ac_kcl_AsyncTaskManager_Activator::stop(ctkPluginContext* context)
 {
     Q_UNUSED(context)
+
+    auto prefs = this->_getPreferences().Cast<berry::IBerryPreferences>();
+    if (prefs.IsNotNull()) {
+        prefs->OnChanged.RemoveListener(
+            berry::MessageDelegate1<uk_ac_kcl_AsyncTaskManager_Activator, const berry::IBerryPreferences*>(
+                this, &uk_ac_kcl_AsyncTaskManager_Activator::_preferencesChanged));
+    }
+    _prefServiceTracker->close();
+    _prefServiceTracker.reset();
+
     crimson::AsyncTaskManager::term();
 }
+
+berry::IPreferences::Pointer uk_ac_kcl_AsyncTaskManager_Activator::_getPreferences()
+{
+    berry::IPreferencesService* prefService = _prefServiceTracker->getService();
+    return prefService ? prefService->GetSystemPreferences()->Node(preferenceNodeName)
+                       : berry::IPreferences::Pointer(nullptr);
+}
+
+void uk_ac_kcl_AsyncTaskManager_Activator::_preferencesChanged(const berry::IBerryPreferences* prefs)
+{
+    auto manager = crimson::AsyncTaskManager::getInstance();
+
+    int capacity = prefs->GetInt(resultCacheCapacityKeyName, defaultResultCacheCapacity);
+    manager->setResultCacheCapacity(static_cast<size_t>(std::max(capacity, 0)));
+
+    // The on-disk cache is off unless a directory is given explicitly
+    manager->setResultCacheDirectory(prefs->Get(resultCacheDirectoryKeyName, ""));
+}
@@ -1,7 +1,14 @@
 #pragma once
 
+#include <memory>
+
 #include <ctkPluginActivator.h>
 
+#include <berryIPreferencesService.h>
+#include <berryIPreferences.h>
+#include <berryIBerryPreferences.h>
+#include <ctkServiceTracker.h>
+
 class uk_ac_kcl_AsyncTaskManager_Activator : public QObject, public ctkPluginActivator
 {
     Q_OBJECT
@@ -15,8 +22,15 @@ public:
 
     static ctkPluginContext* GetPluginContext() { return PluginContext; }
 
+    static const QString preferenceNodeName;
+    static const QString resultCacheCapacityKeyName;
+    static const QString resultCacheDirectoryKeyName;
+
 private:
+    berry::IPreferences::Pointer _getPreferences();
+    void _preferencesChanged(const berry::IBerryPreferences*);
 
     static ctkPluginContext* PluginContext;
-}; // uk_ac_kcl_AsyncTaskManager_Activator
 
+    std::unique_ptr<ctkServiceTracker<berry::IPreferencesService*>> _prefServiceTracker;
+}; // uk_ac_kcl_AsyncTaskManager_Activator
@@ -1,6 +1,7 @@
 // Qt
 #include <QToolButton>
 #include <QProgressBar>
+#include <QFileDialog>
 
 // Main include
 #include "AsyncTaskManagerView.h"
@@ -8,6 +9,8 @@
 // Module includes
 #include <AsyncTaskManager.h>
 
+#include <mitkLogMacros.h>
+
 const std::string AsyncTaskManagerView::VIEW_ID = "org.mitk.views.AsyncTaskManagerView";
 static const int TaskUidRole = Qt::UserRole + 1;
 
@@ -33,6 +36,10 @@ void AsyncTaskManagerView::CreateQtPartControl(QWidget *parent)
     _UI.taskTableWidget->horizontalHeader()->setSectionResizeMode(ColumnCancelButton, QHeaderView::ResizeToContents);
 
     connect(_UI.cancelAllButton, &QAbstractButton::clicked, this, &AsyncTaskManagerView::cancelAllTasks);
+    connect(_UI.recordTimingsCheckBox, &QAbstractButton::toggled, this, &AsyncTaskManagerView::setRecordTimings);
+    connect(_UI.exportTraceButton, &QAbstractButton::clicked, this, &AsyncTaskManagerView::exportTrace);
+
+    _UI.recordTimingsCheckBox->setChecked(crimson::AsyncTaskManager::getInstance()->isProfilingEnabled());
 
     connect(crimson::AsyncTaskManager::getInstance(), &crimson::AsyncTaskManager::taskStateChanged,
         this, &AsyncTaskManagerView::taskStateChanged);
@@ -126,6 +133,23 @@ void AsyncTaskManagerView::taskCompleted(const crimson::AsyncTaskManager::TaskUI
     _updateUI();
 }
 
+void AsyncTaskManagerView::setRecordTimings(bool record)
+{
+    crimson::AsyncTaskManager::getInstance()->setProfilingEnabled(record);
+}
+
+void AsyncTaskManagerView::exportTrace()
+{
+    QString fileName = QFileDialog::getSaveFileName(nullptr, tr("Export task trace"), QString(), tr("Chrome trace (*.json)"));
+    if (fileName.isEmpty()) {
+        return;
+    }
+
+    if (crimson::AsyncTaskManager::getInstance()->exportTaskTrace(fileName)) {
+        MITK_INFO << "Task timing summary:\n" << crimson::AsyncTaskManager::getInstance()->getTaskProfileSummary().toStdString();
+    }
+}
+
 void AsyncTaskManagerView::cancelTaskByButton()
 {
     for (int row = 0; row < _UI.taskTableWidget->rowCount(); ++row) {
@@ -24,6 +24,8 @@ public:
 private slots:
     void cancelAllTasks();
     void cancelTaskByButton();
+    void setRecordTimings(bool record);
+    void exportTrace();
     void taskStateChanged(const crimson::AsyncTaskManager::TaskUID& uid, crimson::async::Task::State state);
     void taskAdded(const crimson::AsyncTaskManager::TaskUID& taskUid);
     void taskProgressAddSteps(const crimson::AsyncTaskManager::TaskUID& taskUid, unsigned int steps);
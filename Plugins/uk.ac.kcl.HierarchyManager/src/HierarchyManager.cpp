@@ -2,6 +2,9 @@
 
 #include "HierarchyManager.h"
 
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <boost/functional/hash.hpp>
 #include <boost/range/adaptor/map.hpp>
@@ -46,6 +49,132 @@ struct HierarchyManager::HierarchyManagerImpl {
 
     std::map<NodeType, NodeTypeInfo> _nodeTypeInfo;
 
+    // Indices of the nodes in the data storage kept in sync through the data storage events.
+    // They allow the lookups below to avoid scanning the data storage and re-evaluating the node type predicates.
+    struct NodeIndexEntry {
+        std::string uid;
+        std::vector<mitk::DataNode*> parents;
+        std::vector<mitk::DataNode*> children;
+
+        // Lazily evaluated node type information, invalidated whenever the node is modified
+        bool typesValid = false;
+        std::vector<NodeType> matchingTypes; ///< All the node types whose predicates the node satisfies, in ascending order
+        int flags = ntfNone; ///< Union of the flags of matchingTypes
+    };
+
+    std::unordered_map<const mitk::DataNode*, NodeIndexEntry> _nodeIndex;
+    std::unordered_map<std::string, mitk::DataNode*> _uidIndex;
+
+    void indexNode(mitk::DataStorage* dataStorage, const mitk::DataNode* node)
+    {
+        NodeIndexEntry& entry = _nodeIndex[node];
+
+        mitk::DataStorage::SetOfObjects::ConstPointer parents = dataStorage->GetSources(node, nullptr, true);
+        for (const mitk::DataNode::Pointer& parent : *parents) {
+            entry.parents.push_back(parent.GetPointer());
+
+            auto parentIter = _nodeIndex.find(parent.GetPointer());
+            if (parentIter != _nodeIndex.end()) {
+                parentIter->second.children.push_back(const_cast<mitk::DataNode*>(node));
+            }
+        }
+
+        updateNodeUID(node, entry);
+    }
+
+    void unindexNode(const mitk::DataNode* node)
+    {
+        auto iter = _nodeIndex.find(node);
+        if (iter == _nodeIndex.end()) {
+            return;
+        }
+
+        auto eraseNode = [node](std::vector<mitk::DataNode*>& nodes) {
+            nodes.erase(std::remove(nodes.begin(), nodes.end(), node), nodes.end());
+        };
+
+        for (mitk::DataNode* parent : iter->second.parents) {
+            auto parentIter = _nodeIndex.find(parent);
+            if (parentIter != _nodeIndex.end()) {
+                eraseNode(parentIter->second.children);
+            }
+        }
+
+        for (mitk::DataNode* child : iter->second.children) {
+            auto childIter = _nodeIndex.find(child);
+            if (childIter != _nodeIndex.end()) {
+                eraseNode(childIter->second.parents);
+            }
+        }
+
+        auto uidIter = _uidIndex.find(iter->second.uid);
+        if (uidIter != _uidIndex.end() && uidIter->second == node) {
+            _uidIndex.erase(uidIter);
+        }
+
+        _nodeIndex.erase(iter);
+    }
+
+    void updateNodeUID(const mitk::DataNode* node, NodeIndexEntry& entry)
+    {
+        std::string uid;
+        node->GetStringProperty(nodeUIDPropertyName, uid);
+        if (uid == entry.uid) {
+            return;
+        }
+
+        auto uidIter = _uidIndex.find(entry.uid);
+        if (uidIter != _uidIndex.end() && uidIter->second == node) {
+            _uidIndex.erase(uidIter);
+        }
+
+        entry.uid = uid;
+        if (!uid.empty()) {
+            _uidIndex[uid] = const_cast<mitk::DataNode*>(node);
+        }
+    }
+
+    // Returns nullptr if the node is not in the data storage
+    const NodeIndexEntry* getNodeTypes(const mitk::DataNode* node)
+    {
+        auto iter = _nodeIndex.find(node);
+        if (iter == _nodeIndex.end()) {
+            return nullptr;
+        }
+
+        NodeIndexEntry& entry = iter->second;
+        if (!entry.typesValid) {
+            entry.matchingTypes.clear();
+            entry.flags = ntfNone;
+            for (const auto& ntInfoPair : _nodeTypeInfo) {
+                if (ntInfoPair.second.predicate->CheckNode(node)) {
+                    entry.matchingTypes.push_back(ntInfoPair.first);
+                    entry.flags |= ntInfoPair.second.flags;
+                }
+            }
+            entry.typesValid = true;
+        }
+
+        return &entry;
+    }
+
+    bool isNodeOfType(const mitk::DataNode* node, NodeType type)
+    {
+        const NodeIndexEntry* entry = getNodeTypes(node);
+        if (!entry) {
+            auto ntInfoIter = _nodeTypeInfo.find(type);
+            return ntInfoIter != _nodeTypeInfo.end() && ntInfoIter->second.predicate->CheckNode(node);
+        }
+        return std::binary_search(entry->matchingTypes.begin(), entry->matchingTypes.end(), type);
+    }
+
+    void invalidateNodeTypes()
+    {
+        for (auto& nodeEntryPair : _nodeIndex) {
+            nodeEntryPair.second.typesValid = false;
+        }
+    }
+
     bool _startNewUndoGroup = true;
     bool _undoEnabled = true;
 
@@ -93,6 +222,23 @@ HierarchyManager::HierarchyManager()
 {
     _impl->_dataStorageServiceTracker.open();
 
+    // Index the nodes which are already in the data storage. Parents are indexed before their children,
+    // so indexNode() can link them.
+    mitk::DataStorage::SetOfObjects::ConstPointer allNodes = getDataStorage()->GetAll();
+    std::function<void(const mitk::DataNode*)> indexWithParents = [&](const mitk::DataNode* node) {
+        if (_impl->_nodeIndex.find(node) != _impl->_nodeIndex.end()) {
+            return;
+        }
+        mitk::DataStorage::SetOfObjects::ConstPointer parents = getDataStorage()->GetSources(node, nullptr, true);
+        for (const mitk::DataNode::Pointer& parent : *parents) {
+            indexWithParents(parent.GetPointer());
+        }
+        _impl->indexNode(getDataStorage(), node);
+    };
+    for (const mitk::DataNode::Pointer& node : *allNodes) {
+        indexWithParents(node.GetPointer());
+    }
+
     _connectDataStorageEvents();
 }
 
@@ -112,6 +258,7 @@ bool HierarchyManager::addNodeType(const NodeType& type, const mitk::NodePredica
         return false;
     }
     _impl->_nodeTypeInfo[type] = HierarchyManagerImpl::NodeTypeInfo{predicate, flags};
+    _impl->invalidateNodeTypes();
     return true;
 }
 
@@ -133,6 +280,9 @@ void HierarchyManager::_connectDataStorageEvents()
 
     getDataStorage()->RemoveNodeEvent.AddListener(
         mitk::MessageDelegate1<HierarchyManager, const mitk::DataNode*>(this, &HierarchyManager::nodeRemoved));
+
+    getDataStorage()->ChangedNodeEvent.AddListener(
+        mitk::MessageDelegate1<HierarchyManager, const mitk::DataNode*>(this, &HierarchyManager::nodeChanged));
 }
 
 void HierarchyManager::_disconnectDataStorageEvents()
@@ -142,6 +292,9 @@ void HierarchyManager::_disconnectDataStorageEvents()
 
     getDataStorage()->RemoveNodeEvent.RemoveListener(
         mitk::MessageDelegate1<HierarchyManager, const mitk::DataNode*>(this, &HierarchyManager::nodeRemoved));
+
+    getDataStorage()->ChangedNodeEvent.RemoveListener(
+        mitk::MessageDelegate1<HierarchyManager, const mitk::DataNode*>(this, &HierarchyManager::nodeChanged));
 }
 
 mitk::DataStorage::Pointer HierarchyManager::getDataStorage() const
@@ -182,10 +335,26 @@ void HierarchyManager::nodeAdded(const mitk::DataNode* node)
     }
 
     nonConstNode->SetSelected(false);
+
+    _impl->indexNode(getDataStorage(), node);
+}
+
+void HierarchyManager::nodeChanged(const mitk::DataNode* node)
+{
+    // The node type predicates may depend on the node properties and data, and the UID may have been changed
+    auto iter = _impl->_nodeIndex.find(node);
+    if (iter != _impl->_nodeIndex.end()) {
+        iter->second.typesValid = false;
+        _impl->updateNodeUID(node, iter->second);
+    }
 }
 
 bool HierarchyManager::_testFlags(const mitk::DataNode* node, NodeTypeFlags flags) const
 {
+    if (const HierarchyManagerImpl::NodeIndexEntry* entry = _impl->getNodeTypes(node)) {
+        return (entry->flags & flags) != 0;
+    }
+
     for (const auto& ntInfoPair : _impl->_nodeTypeInfo) {
         if ((ntInfoPair.second.flags & flags) && ntInfoPair.second.predicate->CheckNode(node)) {
             return true;
@@ -263,6 +432,8 @@ void HierarchyManager::nodeRemoved(const mitk::DataNode* node)
     if (!_impl->_deletingRecursively && getDataStorage()->GetSubset(notHelper)->size() == 0) {
         _impl->_undoController->Clear();
     }
+
+    _impl->unindexNode(node);
 }
 
 HierarchyManager::RelationType HierarchyManager::getRelation(const NodeType& parentNodeType,
@@ -369,6 +540,13 @@ bool HierarchyManager::addNodeToHierarchy(const mitk::DataNode* parentNode, cons
 
 boost::optional<HierarchyManager::NodeType> HierarchyManager::findFittingNodeType(mitk::DataNode* node) const
 {
+    if (const HierarchyManagerImpl::NodeIndexEntry* entry = _impl->getNodeTypes(node)) {
+        if (entry->matchingTypes.empty()) {
+            return boost::none;
+        }
+        return entry->matchingTypes.front();
+    }
+
     // Find the predicate fitting the node
     for (const auto& ntInfoPair : _impl->_nodeTypeInfo) {
         if (ntInfoPair.second.predicate->CheckNode(node)) {
@@ -383,8 +561,9 @@ std::unordered_set<mitk::DataNode*> HierarchyManager::findPotentialParents(mitk:
 {
     std::unordered_set<mitk::DataNode*> potentialParents;
 
-    mitk::DataStorage::SetOfObjects::ConstPointer ancestors = getDataStorage()->GetSources(node, nullptr, true);
-    mitk::DataNode* currentParentNode = ancestors->size() == 0 ? nullptr : (*ancestors)[0];
+    auto nodeIter = _impl->_nodeIndex.find(node);
+    mitk::DataNode* currentParentNode =
+        nodeIter == _impl->_nodeIndex.end() || nodeIter->second.parents.empty() ? nullptr : nodeIter->second.parents[0];
 
     // Find node types of potential parents
     std::unordered_set<NodeType> parentNodeTypes;
@@ -394,13 +573,16 @@ std::unordered_set<mitk::DataNode*> HierarchyManager::findPotentialParents(mitk:
         }
     }
 
-    for (NodeType parentNodeType : parentNodeTypes) {
-        mitk::DataStorage::SetOfObjects::ConstPointer parents = getDataStorage()->GetSubset(getPredicate(parentNodeType));
-        std::copy_if(parents->begin(), parents->end(), std::inserter(potentialParents, potentialParents.begin()),
-                     [currentParentNode](const mitk::DataNode::Pointer& n) {
-                         return n != currentParentNode && n->GetProperty("helper object") == nullptr &&
-                                n->GetProperty("hidden object") == nullptr;
-                     });
+    for (const auto& nodeEntryPair : _impl->_nodeIndex) {
+        auto n = const_cast<mitk::DataNode*>(nodeEntryPair.first);
+        if (n == currentParentNode || n->GetProperty("helper object") != nullptr || n->GetProperty("hidden object") != nullptr) {
+            continue;
+        }
+
+        if (std::any_of(parentNodeTypes.begin(), parentNodeTypes.end(),
+                        [this, n](NodeType parentNodeType) { return _impl->isNodeOfType(n, parentNodeType); })) {
+            potentialParents.insert(n);
+        }
     }
 
     return potentialParents;
@@ -440,28 +622,66 @@ mitk::NodePredicateBase::Pointer HierarchyManager::getPredicate(const NodeType&
 
 mitk::DataNode::Pointer HierarchyManager::getAncestor(const mitk::DataNode* node, const NodeType& parentType, bool directOnly /*= false*/) const
 {
-    mitk::DataStorage::SetOfObjects::ConstPointer ancestors =
-        getDataStorage()->GetSources(node, getPredicate(parentType), directOnly);
+    auto ancestors = _collectRelatives(node, parentType, directOnly, true, true);
     return ancestors->size() == 0 ? nullptr : (*ancestors)[0];
 }
 
 mitk::DataNode::Pointer HierarchyManager::getFirstDescendant(const mitk::DataNode* node, const NodeType& descendantType,
                                                              bool directOnly /*= false*/) const
 {
-    mitk::DataStorage::SetOfObjects::ConstPointer nodes = getDescendants(node, descendantType, directOnly);
+    auto nodes = _collectRelatives(node, descendantType, directOnly, false, true);
     return nodes->size() > 0 ? (*nodes)[0] : mitk::DataNode::Pointer();
 }
 
 mitk::DataStorage::SetOfObjects::ConstPointer HierarchyManager::getDescendants(const mitk::DataNode* node,
                                                                                const NodeType& descendantsType, bool directOnly /*= false*/) const
 {
-    return getDataStorage()->GetDerivations(node, getPredicate(descendantsType), directOnly);
+    return _collectRelatives(node, descendantsType, directOnly, false, false).GetPointer();
+}
+
+mitk::DataStorage::SetOfObjects::Pointer HierarchyManager::_collectRelatives(const mitk::DataNode* node, const NodeType& type,
+                                                                             bool directOnly, bool ancestors, bool firstOnly) const
+{
+    auto result = mitk::DataStorage::SetOfObjects::New();
+
+    if (_impl->_nodeIndex.find(node) == _impl->_nodeIndex.end()) {
+        // Node is not in the data storage - nothing to search
+        return result;
+    }
+
+    // Breadth-first traversal of the cached adjacency, so that closer relatives come first
+    std::queue<const mitk::DataNode*> nodesToProcess;
+    std::unordered_set<const mitk::DataNode*> visited{node};
+    nodesToProcess.push(node);
+    while (!nodesToProcess.empty()) {
+        const HierarchyManagerImpl::NodeIndexEntry& entry = _impl->_nodeIndex.at(nodesToProcess.front());
+        nodesToProcess.pop();
+
+        for (mitk::DataNode* relative : ancestors ? entry.parents : entry.children) {
+            if (!visited.insert(relative).second) {
+                continue;
+            }
+
+            if (_impl->isNodeOfType(relative, type)) {
+                result->push_back(relative);
+                if (firstOnly) {
+                    return result;
+                }
+            }
+
+            if (!directOnly && _impl->_nodeIndex.find(relative) != _impl->_nodeIndex.end()) {
+                nodesToProcess.push(relative);
+            }
+        }
+    }
+
+    return result;
 }
 
 mitk::DataNode::Pointer HierarchyManager::findNodeByUID(gsl::cstring_span<> nodeUID) const
 {
-    return getDataStorage()->GetNode(
-        mitk::NodePredicateProperty::New(nodeUIDPropertyName, mitk::StringProperty::New(gsl::to_string(nodeUID))));
+    auto iter = _impl->_uidIndex.find(gsl::to_string(nodeUID));
+    return iter == _impl->_uidIndex.end() ? mitk::DataNode::Pointer() : mitk::DataNode::Pointer(iter->second);
 }
 
 void HierarchyManager::ExecuteOperation(mitk::Operation* operation)
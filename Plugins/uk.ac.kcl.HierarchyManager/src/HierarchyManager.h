@@ -254,6 +254,7 @@ private:
 
     void nodeAdded(const mitk::DataNode*);
     void nodeRemoved(const mitk::DataNode*);
+    void nodeChanged(const mitk::DataNode*);
 
 private:
     static HierarchyManager* _instance;
@@ -265,6 +266,8 @@ private:
     int _lastAssignedNodeType = 0;
 
     bool _testFlags(const mitk::DataNode* node, NodeTypeFlags flags) const;
+    mitk::DataStorage::SetOfObjects::Pointer _collectRelatives(const mitk::DataNode* node, const NodeType& type, bool directOnly,
+                                                               bool ancestors, bool firstOnly) const;
     std::vector<std::pair<std::vector<const mitk::DataNode*>, mitk::DataNode::ConstPointer>>
     _getUndoableRemoveNodes(const mitk::DataNode* node) const;
 };
@@ -9,11 +9,11 @@ set(INTERNAL_CPP_FILES
   FaceDataEditorWidget.cpp
   MaterialVisualizationWidget.cpp
   ResliceView.cpp
-  ThumbnailGenerator.cpp #
   ContourTypeConversion.cpp
   PCMRIUtils.cpp
   PCMRIMappingWidget.cpp
   MapAction.cpp
+  InterpolateContourTask.cpp
   TimeInterpolationDialog.cpp
   3rdParty/BestFit/BestFit.cpp #
   3rdParty/BestFit/Double.cpp #
@@ -44,7 +44,6 @@ set(MOC_H_FILES
   src/internal/PCMRIMappingWidget.h
   src/internal/MapAction.h
   src/internal/TimeInterpolationDialog.h
-  src/internal/ThumbnailGenerator.h #
 )
 
 # list of resource files which can be used by the plug-in
@@ -0,0 +1,110 @@
+#include "InterpolateContourTask.h"
+#include "PCMRIUtils.h"
+
+#include <mitkImageWriteAccessor.h>
+#include <mitkImageToContourFilter.h>
+#include <mitkShapeBasedInterpolationAlgorithm.h>
+#include <mitkSlicedGeometry3D.h>
+#include <mitkSurface.h>
+
+#include <vtkCell.h>
+#include <vtkPolyData.h>
+
+#include <cstring>
+
+InterpolateContourTask::InterpolateContourTask(float parameterValue, const mitk::PlanarFigure* figures[2],
+                                               float interpolationFactor, const mitk::PlaneGeometry* sliceGeometry,
+                                               float smoothness)
+    : _parameterValue(parameterValue)
+    , _interpolationFactor(interpolationFactor)
+    , _smoothness(smoothness)
+{
+    // The figures are shared with the data storage - work on copies as their geometries are replaced below
+    for (int i = 0; i < 2; ++i) {
+        _figures[i] = figures[i]->Clone();
+    }
+
+    _dimensions[0] = static_cast<unsigned int>(sliceGeometry->GetBounds()[1]);
+    _dimensions[1] = static_cast<unsigned int>(sliceGeometry->GetBounds()[3]);
+
+    for (int i = 0; i < 3; ++i) {
+        _spacing[i] = sliceGeometry->GetSpacing()[i];
+    }
+}
+
+std::tuple<crimson::async::Task::State, std::string> InterpolateContourTask::runTask()
+{
+    if (isCancelling()) {
+        return std::make_tuple(State_Cancelled, std::string("Operation cancelled."));
+    }
+
+    const int nInterpolationSlices = 100;
+
+    mitk::Point3D origin;
+    origin[0] = -_spacing[0] * _dimensions[0] / 2.0;
+    origin[1] = -_spacing[1] * _dimensions[1] / 2.0;
+    origin[2] = -_spacing[0] / 2.0;
+
+    // Step 1: get the segmentation images for figures
+    mitk::PixelType pixelType(mitk::MakeScalarPixelType<unsigned char>());
+    mitk::Image::Pointer contourSegmentedImages[2];
+
+    for (int i = 0; i < 2; ++i) {
+        contourSegmentedImages[i] = mitk::Image::New();
+        contourSegmentedImages[i]->Initialize(pixelType, 2, _dimensions);
+        contourSegmentedImages[i]->SetSpacing(_spacing);
+        origin[2] = -_spacing[2] / 2.0 + (i == 0 ? 0 : nInterpolationSlices * _spacing[2]);
+        contourSegmentedImages[i]->SetOrigin(origin);
+
+        {
+            mitk::ImageWriteAccessor writeAccess(contourSegmentedImages[i]);
+            memset(writeAccess.GetData(), 0, _dimensions[0] * _dimensions[1] * sizeof(unsigned char));
+        }
+
+        _figures[i]->SetPlaneGeometry(
+            static_cast<mitk::SlicedGeometry3D*>(contourSegmentedImages[i]->GetGeometry())->GetPlaneGeometry(0));
+
+        crimson::PCMRIUtils::fillPlanarFigureInSlice(contourSegmentedImages[i], _figures[i]);
+    }
+
+    if (isCancelling()) {
+        return std::make_tuple(State_Cancelled, std::string("Operation cancelled."));
+    }
+
+    // Step 2: interpolate
+    auto outImg = mitk::Image::New();
+    outImg->Initialize(pixelType, 2, _dimensions);
+    outImg->SetSpacing(_spacing);
+    origin[2] = -_spacing[2] / 2.0 + (nInterpolationSlices / 2) * _spacing[2];
+    outImg->SetOrigin(origin);
+
+    auto interpolationAlgo = mitk::ShapeBasedInterpolationAlgorithm::New();
+    interpolationAlgo->Interpolate(contourSegmentedImages[0].GetPointer(), 0, contourSegmentedImages[1].GetPointer(),
+                                   nInterpolationSlices - 1,
+                                   (int)((nInterpolationSlices - 1) * _interpolationFactor + 0.5), 2, outImg, 0, nullptr);
+
+    // Step 3: retrieve the contour from interpolated slice
+    auto contour = mitk::PlanarPolygon::New();
+    contour->SetClosed(true);
+    contour->PlaceFigure(mitk::Point2D());
+    contour->SetPlaneGeometry(static_cast<mitk::SlicedGeometry3D*>(outImg->GetGeometry())->GetPlaneGeometry(0));
+
+    mitk::ImageToContourFilter::Pointer contourExtractor = mitk::ImageToContourFilter::New();
+    contourExtractor->SetInput(outImg);
+    contourExtractor->Update();
+
+    mitk::Surface::Pointer contourSurf = contourExtractor->GetOutput();
+
+    if (contourSurf->GetVtkPolyData()->GetNumberOfCells() == 0 ||
+        contourSurf->GetVtkPolyData()->GetCell(0)->GetPointIds()->GetNumberOfIds() <
+            contour->GetMinimumNumberOfControlPoints()) {
+        setResult(mitk::PlanarPolygon::Pointer());
+        return std::make_tuple(State_Finished, std::string("Interpolated contour is empty."));
+    }
+
+    crimson::PCMRIUtils::createSmoothedContourFromVtkPolyData(contourSurf->GetVtkPolyData(), contour, _smoothness);
+    contour->SetFinalized(true);
+
+    setResult(contour);
+    return std::make_tuple(State_Finished, std::string());
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <AsyncTaskWithResult.h>
+
+#include <mitkPlanarFigure.h>
+#include <mitkPlanarPolygon.h>
+#include <mitkPlaneGeometry.h>
+
+/*!
+ * \brief   An asynchronous task which interpolates the contour of a single PC-MRI time frame from
+ *  the contours of the two closest frames using shape-based interpolation.
+ *
+ *  The task only works on its own copies of the figures, so the tasks for different frames can run
+ *  in parallel without touching the data storage or the render windows. The result is a
+ *  smoothed polygon whose control points are expressed in the 2D coordinates of the frame's
+ *  slice, or a null pointer if the interpolated shape was empty.
+ */
+class InterpolateContourTask : public crimson::async::TaskWithResult<mitk::PlanarPolygon::Pointer>
+{
+public:
+    /*!
+     * \param   parameterValue      The time frame to interpolate the contour for.
+     * \param   figures             The contours of the neighbouring frames, before and after the interpolated one.
+     * \param   interpolationFactor The relative position of the frame between the two neighbours, in range [0, 1].
+     * \param   sliceGeometry       The geometry of the PC-MRI slice at the interpolated frame.
+     * \param   smoothness          The smoothness of the resulting contour, in range [0, 1].
+     */
+    InterpolateContourTask(float parameterValue, const mitk::PlanarFigure* figures[2], float interpolationFactor,
+                           const mitk::PlaneGeometry* sliceGeometry, float smoothness);
+
+    float getParameterValue() const { return _parameterValue; }
+
+    std::tuple<State, std::string> runTask() override;
+
+private:
+    float _parameterValue;
+    mitk::PlanarFigure::Pointer _figures[2];
+    float _interpolationFactor;
+    unsigned int _dimensions[2];
+    mitk::ScalarType _spacing[3];
+    float _smoothness;
+};
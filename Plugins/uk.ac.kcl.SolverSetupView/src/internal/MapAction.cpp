@@ -267,38 +267,6 @@ bool sortContours(mitk::DataNode* i, mitk::DataNode* j)
 	return (p1<p2);
 }
 
-double calculateParRecScaling(mitk::Image::Pointer pcmriImage, int startIndex)
-{
-	int phaseEncodingVelocityValue = 0;
-	std::vector<short> phaseValues;
-	double max_ph = 0;
-
-	pcmriImage->GetPropertyList()->GetIntProperty("mapping.vencP", phaseEncodingVelocityValue);
-
-	for (int i = startIndex; i < pcmriImage->GetDimensions()[3]; i++)
-	{
-		for (int j = 0; j < pcmriImage->GetDimensions()[0]; j++)
-		{
-			for (int z = 0; z < pcmriImage->GetDimensions()[1]; z++)
-			{
-				itk::Index<3> idx;
-				idx[0] = j;
-				idx[1] = z;
-				idx[2] = 0;
-				phaseValues.push_back(pcmriImage->GetPixelValueByIndex(idx, i));
-				auto pixValue = pcmriImage->GetPixelValueByIndex(idx, i);
-				if (pcmriImage->GetPixelValueByIndex(idx, i)>max_ph)
-					max_ph = pcmriImage->GetPixelValueByIndex(idx, i);
-			}
-		}
-	}
-
-	int power = ceil(log2(max_ph));
-	double scale = (pow(2, power)) / 2;
-
-	return scale;
-}
-
 template <typename T>
 FloatImageType::Pointer calculateVelocities(mitk::Image::Pointer pcmriImage, mitk::Image::Pointer magnitudeImage, mitk::PropertyList::Pointer properties)
 {
@@ -338,22 +306,12 @@ FloatImageType::Pointer calculateVelocities(mitk::Image::Pointer pcmriImage, mit
 		properties->GetIntProperty("mapping.vencP", phaseEncodingVelocityValue);
 
 
-		SubtractScalingType::Pointer subtractImageFilter = SubtractScalingType::New();
-		MultipyScalingType::Pointer multiplyImageFilter = MultipyScalingType::New();
-
 		startIndex = 2 * numPhases;
-		scale = calculateParRecScaling(pcmriImage.GetPointer(), startIndex);
-
-		subtractImageFilter->SetInput1(itkImageFloat);
-		subtractImageFilter->SetConstant2(scale);
-		subtractImageFilter->Update();
-
-		multiplyImageFilter->SetInput(subtractImageFilter->GetOutput());
-		multiplyImageFilter->SetConstant(phaseEncodingVelocityValue * 10 / scale); //multiply by 10 to convert from cm to mm
-		multiplyImageFilter->Update();
-
-		itkImageFloat = multiplyImageFilter->GetOutput();
+		scale = crimson::IPCMRIKernel::calculateParRecScaling(itkImageFloat, startIndex);
 
+		// (value - scale) * venc / scale, multiply by 10 to convert from cm to mm
+		double slope = phaseEncodingVelocityValue * 10 / scale;
+		crimson::IPCMRIKernel::applyLinearScaling(itkImageFloat, slope, -scale * slope);
 
 	}
 	else if (velocityCalculationType == "GE")
@@ -391,11 +349,7 @@ FloatImageType::Pointer calculateVelocities(mitk::Image::Pointer pcmriImage, mit
 		}
 		else
 		{
-			divideImageFilter->SetInput(itkImageFloat);
-			divideImageFilter->SetConstant(scale/10); //multiply image by 10 to convert from cm to mm 
-			divideImageFilter->Update();
-
-			itkImageFloat = divideImageFilter->GetOutput();
+			crimson::IPCMRIKernel::applyLinearScaling(itkImageFloat, 10 / scale, 0); //multiply image by 10 to convert from cm to mm 
 		}
 
 	}
@@ -413,18 +367,7 @@ FloatImageType::Pointer calculateVelocities(mitk::Image::Pointer pcmriImage, mit
 
 		double scale = venc * 10 / (pow(2, quantization)); //multiply by 10 to convert from cm to mm
 
-		SubtractScalingType::Pointer subtractImageFilter = SubtractScalingType::New();
-		MultipyScalingType::Pointer multiplyImageFilter = MultipyScalingType::New();
-
-		multiplyImageFilter->SetInput(itkImageFloat);
-		multiplyImageFilter->SetConstant(scale * rescaleSlope);
-		multiplyImageFilter->Update();
-
-		subtractImageFilter->SetInput1(multiplyImageFilter->GetOutput());
-		subtractImageFilter->SetInput2((double)rescaleIntercept * scale * -1);
-		subtractImageFilter->Update();
-
-		itkImageFloat = subtractImageFilter->GetOutput();
+		crimson::IPCMRIKernel::applyLinearScaling(itkImageFloat, scale * rescaleSlope, (double)rescaleIntercept * scale);
 
 	}
 
@@ -435,23 +378,8 @@ FloatImageType::Pointer calculateVelocities(mitk::Image::Pointer pcmriImage, mit
 		properties->GetIntProperty("mapping.rescaleIntercept", rescaleIntercept);
 		properties->GetDoubleProperty("mapping.rescaleSlope", rescaleSlope);
 
-		SubtractScalingType::Pointer subtractImageFilter = SubtractScalingType::New();
-		MultipyScalingType::Pointer multiplyImageFilter = MultipyScalingType::New();
-		MultipyScalingType::Pointer multiplyImageFilter2 = MultipyScalingType::New();
-
-		multiplyImageFilter->SetInput(itkImageFloat);
-		multiplyImageFilter->SetConstant(rescaleSlope);
-		multiplyImageFilter->Update();
-
-		subtractImageFilter->SetInput1(multiplyImageFilter->GetOutput());
-		subtractImageFilter->SetConstant2((double)rescaleIntercept);
-		subtractImageFilter->Update();
-
-		multiplyImageFilter2->SetInput(subtractImageFilter->GetOutput());
-		multiplyImageFilter2->SetConstant(10); //multiply by 10 to convert from cm to mm
-		multiplyImageFilter2->Update();
-
-		itkImageFloat = multiplyImageFilter2->GetOutput();
+		//(value * slope - intercept), multiply by 10 to convert from cm to mm
+		crimson::IPCMRIKernel::applyLinearScaling(itkImageFloat, rescaleSlope * 10, (double)rescaleIntercept * -10);
 
 	}
 
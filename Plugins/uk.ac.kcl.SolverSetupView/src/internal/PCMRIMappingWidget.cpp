@@ -13,19 +13,22 @@
 
 // Plugin includes
 #include "ResliceView.h"
-#include "ThumbnailGenerator.h"
 #include "ConstMemberCommand.h"
 #include "ContourTypeConversion.h"
 #include "PCMRIUtils.h"
 #include "MapAction.h"
 #include "SolverSetupView.h"
 #include "TimeInterpolationDialog.h"
+#include "InterpolateContourTask.h"
 #include <utils/TaskStateObserver.h>
 
 // Module includes
 #include <HierarchyManager.h>
 #include <AsyncTaskManager.h>
 #include <AsyncTask.h>
+#include <ThumbnailGenerator.h>
+#include <CompositeTask.h>
+#include <QAsyncTaskAdapter.h>
 //#include <QtPropertyStorage.h>
 #include <VascularModelingNodeTypes.h>
 #include <VesselMeshingNodeTypes.h>
@@ -86,7 +89,6 @@
 // VTK
 #include <vtkNew.h>
 #include <vtkPolyData.h>
-#include <vtkWindowedSincPolyDataFilter.h>
 
 // Solid modelling kernel
 #include <ISolidModelKernel.h>
@@ -100,6 +102,9 @@
 //Solver kernel
 #include <IBoundaryCondition.h>
 
+#include <cmath>
+#include <iterator>
+
 Q_DECLARE_METATYPE(const mitk::DataNode*)
 
 using namespace crimson;
@@ -162,13 +167,6 @@ PCMRIMappingWidget::PCMRIMappingWidget(QWidget* parent)
 	: QWidget(parent)
 	, _thumbnailGenerator(new crimson::ThumbnailGenerator(crimson::HierarchyManager::getInstance()->crimson::HierarchyManager::getInstance()->getDataStorage()))
 {
-	// Leave only planar figures and images in the thumbnails
-	_shouldBeInvisibleInThumbnailView =
-		mitk::NodePredicateNot::New(mitk::NodePredicateOr::New(mitk::NodePredicateOr::New(mitk::TNodePredicateDataType<mitk::Image>::New(),
-		mitk::TNodePredicateDataType<mitk::PlanarFigure>::New()),
-		mitk::TNodePredicateDataType<mitk::PointSet::Pointer>::New()))
-		.GetPointer();
-
 	//_viewWidget = parent;
 
 	// create GUI widgets from the Qt Designer's .ui file
@@ -200,7 +198,10 @@ PCMRIMappingWidget::PCMRIMappingWidget(QWidget* parent)
 	// Contour duplication and interpolation
 	connect(_UI.duplicateButton, &QAbstractButton::clicked, this, &PCMRIMappingWidget::duplicateContour);
 	connect(_UI.interpolateButton, &QAbstractButton::clicked, this, &PCMRIMappingWidget::interpolateContour);
-	connect(_UI.interpolateAllButton, &QAbstractButton::clicked, this, &PCMRIMappingWidget::interpolateAllContours);
+	_interpolateAllTaskStateObserver = new crimson::TaskStateObserver(_UI.interpolateAllButton, nullptr, this);
+	_interpolateAllTaskStateObserver->setEnabled(true);
+	connect(_interpolateAllTaskStateObserver, &crimson::TaskStateObserver::runTaskRequested, this, &PCMRIMappingWidget::interpolateAllContours);
+	connect(_interpolateAllTaskStateObserver, &crimson::TaskStateObserver::taskFinished, this, &PCMRIMappingWidget::interpolateAllContoursFinished);
 
 	// Mapping
 	_mapTaskStateObserver = new crimson::TaskStateObserver(_UI.mapButton, _UI.cancelMapButton, this);
@@ -279,13 +280,6 @@ PCMRIMappingWidget::PCMRIMappingWidget(QWidget* parent)
 	connect(&_contourGeometryUpdateTimer, &QTimer::timeout, this,
 		&PCMRIMappingWidget::reinitAllContourGeometriesOnVesselPathChange);
 
-	// Set the objects' visibility for the thumbnail renderer
-	mitk::DataStorage::SetOfObjects::ConstPointer invisibleNodes =
-		crimson::HierarchyManager::getInstance()->crimson::HierarchyManager::getInstance()->getDataStorage()->GetSubset(_shouldBeInvisibleInThumbnailView);
-	for (const mitk::DataNode::Pointer& node : *invisibleNodes) {
-		node->SetVisibility(false, _thumbnailGenerator->getThumbnailRenderer());
-	}
-
 	// Setup the listener for the reslice view
 	berry::IWorkbenchPartSite* site = berry::PlatformUI::GetWorkbench()->GetActiveWorkbenchWindow()
 		->GetActivePage()->GetActivePart()->GetSite().GetPointer();
@@ -484,6 +478,8 @@ void PCMRIMappingWidget::setCurrentNode(mitk::DataNode* node)
 			_currentMraPointNode = mraNode.GetPointer();
 
 		_mapTaskStateObserver->setPrimaryObservedUID(crimson::PCMRIUtils::getMappingTaskUID(_currentNode));
+		_mapTaskStateObserver->setSecondaryObservedUIDs({ crimson::PCMRIUtils::getInterpolateContoursTaskUID(_currentNode) });
+		_interpolateAllTaskStateObserver->setPrimaryObservedUID(crimson::PCMRIUtils::getInterpolateContoursTaskUID(_currentNode));
 
 		updateCurrentContour();
 		updateCurrentMraPoint();
@@ -1084,17 +1080,25 @@ void PCMRIMappingWidget::addMraPoint(bool add)
 	_updateUI();
 }
 
-mitk::DataNode* PCMRIMappingWidget::_addPlanarFigure(mitk::PlanarFigure::Pointer figure, bool addInteractor)
+mitk::DataNode* PCMRIMappingWidget::_addPlanarFigure(mitk::PlanarFigure::Pointer figure, bool addInteractor, float parameterValue)
 {
 	// Add the data node for a new planar figure
 	auto newPlanarFigureNode = mitk::DataNode::New();
 	newPlanarFigureNode->SetData(figure);
 
-	// Set up the planar figure geometry
+	// Set up the planar figure geometry - the one of the time frame if given, otherwise the one currently shown
 	assert(_ResliceView);
 	mitk::BaseRenderer* renderer = _ResliceView->getPCMRIRenderer();
-	const mitk::PlaneGeometry* geometry = dynamic_cast<const mitk::PlaneGeometry*>(renderer->GetCurrentWorldPlaneGeometry());
-	auto planeGeometry = const_cast<mitk::PlaneGeometry*>(geometry);
+	mitk::PlaneGeometry* planeGeometry = nullptr;
+	if (parameterValue >= 0) {
+		planeGeometry = _ResliceView->getPlaneGeometry(parameterValue);
+		// Assigned before the node is added so that the thumbnail list sorts it correctly
+		newPlanarFigureNode->SetFloatProperty("mapping.parameterValue", parameterValue);
+	}
+	else {
+		const mitk::PlaneGeometry* geometry = dynamic_cast<const mitk::PlaneGeometry*>(renderer->GetCurrentWorldPlaneGeometry());
+		planeGeometry = const_cast<mitk::PlaneGeometry*>(geometry);
+	}
 
 	figure->SetPlaneGeometry(planeGeometry);
 
@@ -1112,7 +1116,9 @@ mitk::DataNode* PCMRIMappingWidget::_addPlanarFigure(mitk::PlanarFigure::Pointer
 		crimson::VascularModelingNodeTypes::Contour());
 
 	// And assign the parameter value
-	crimson::PCMRIUtils::assignPlanarFigureParameter(_currentPCMRINode, newPlanarFigureNode, _ResliceView->getPCMRIRenderer());
+	if (parameterValue < 0) {
+		crimson::PCMRIUtils::assignPlanarFigureParameter(_currentPCMRINode, newPlanarFigureNode, _ResliceView->getPCMRIRenderer());
+	}
 
 	newPlanarFigureNode->SetVisibility(true);
 
@@ -1213,11 +1219,6 @@ void PCMRIMappingWidget::nodeAdded(const mitk::DataNode* node)
 		}
 	}
 
-	// Set the visibility for the thumbnail renderer
-	if (_shouldBeInvisibleInThumbnailView->CheckNode(node)) {
-		const_cast<mitk::DataNode*>(node)->SetVisibility(false, _thumbnailGenerator->getThumbnailRenderer());
-	}
-
 	auto hierarchyManager = crimson::HierarchyManager::getInstance();
 	if (hierarchyManager->getAncestor(node, crimson::VascularModelingNodeTypes::Image(),true) == _currentPCMRINode) {
 		if (hierarchyManager->getPredicate(crimson::VascularModelingNodeTypes::Contour())->CheckNode(node)) {
@@ -1225,16 +1226,19 @@ void PCMRIMappingWidget::nodeAdded(const mitk::DataNode* node)
 			_addContoursThumbnailsWidgetItem(node);
 			_connectContourObservers(const_cast<mitk::DataNode*>(node));
 			_UI.contourThumbnailListWidget->sortItems();
-			// In case the addition is the undo of contour deletion - navigate to the contour
-			navigateToContour(node);
-			updateCurrentContour();
+			// Batches of interpolated contours are added without changing the current slice
+			if (!_addingInterpolatedContours) {
+				// In case the addition is the undo of contour deletion - navigate to the contour
+				navigateToContour(node);
+				updateCurrentContour();
+			}
 		}
 		
 		else if (hierarchyManager->getPredicate(crimson::SolverSetupNodeTypes::PCMRIPoint())->CheckNode(node)) {
 			//_connectPointSetObservers(const_cast<mitk::DataNode*>(node));
 			updateCurrentPcmriPoint();
 		}
-		else
+		else if (!_addingInterpolatedContours)
 		{
 			updateCurrentContour();
 		}
@@ -1244,9 +1248,10 @@ void PCMRIMappingWidget::nodeAdded(const mitk::DataNode* node)
 		 if (hierarchyManager->getPredicate(crimson::VascularModelingNodeTypes::ContourSegmentationImage())->CheckNode(node))
 		 {
 			_connectSegmentationObservers(const_cast<mitk::DataNode*>(node));
-			updateCurrentContour();
+			if (!_addingInterpolatedContours)
+				updateCurrentContour();
 		 }
-		 else
+		 else if (!_addingInterpolatedContours)
 		 {
 			 updateCurrentContour();
 		 }
@@ -1453,9 +1458,19 @@ void PCMRIMappingWidget::doMap()
 		nSlices = dynamic_cast<mitk::Image*>(_currentPCMRINode->GetData())->GetDimensions()[3];
 	
 	std::vector<mitk::DataNode*> contourNodesAll = crimson::PCMRIUtils::getContourNodesSortedByParameter(_currentPCMRINode);
-	if (contourNodesAll.size() < nSlices)
-		interpolateAllContours();
+	if (contourNodesAll.size() < nSlices) {
+		// Map once the missing contours have been interpolated
+		if (_startContourInterpolation()) {
+			_mapAfterInterpolation = true;
+			return;
+		}
+	}
+
+	_runMapping();
+}
 
+void PCMRIMappingWidget::_runMapping()
+{
 	double profileSmoothness = _UI.gaussianDoubleSpinBox->value();
 	int intSmoothness;
 	if (_currentNode->GetIntProperty("mapping.smoothness", intSmoothness))
@@ -1493,7 +1508,7 @@ void PCMRIMappingWidget::mappingFinished(crimson::async::Task::State state)
 
 std::pair<mitk::DataNode::Pointer, mitk::DataNode::Pointer>
 PCMRIMappingWidget::_createSegmentationNodes(mitk::Image* image, const mitk::PlaneGeometry* sliceGeometry,
-mitk::PlanarFigure* figureToFill)
+mitk::PlanarFigure* figureToFill, int timeStep)
 {
 	// Make sure that for reslicing and overwriting the same alogrithm is used. We can specify the mode of the vtk reslicer
 	vtkSmartPointer<mitkVtkImageOverwrite> reslice = vtkSmartPointer<mitkVtkImageOverwrite>::New();
@@ -1505,7 +1520,7 @@ mitk::PlanarFigure* figureToFill)
 	mitk::ExtractSliceFilter::Pointer extractor = mitk::ExtractSliceFilter::New(reslice);
 
 	extractor->SetInput(image);
-	extractor->SetTimeStep(_ResliceView->getPCMRIRenderer()->GetTimeStep()); //TODO: pass parameter here in case of interpolation
+	extractor->SetTimeStep(timeStep >= 0 ? timeStep : _ResliceView->getPCMRIRenderer()->GetTimeStep());
 	extractor->SetWorldGeometry(sliceGeometry);
 	extractor->SetVtkOutputRequest(false);
 	//extractor->SetResliceTransformByGeometry(image->GetTimeGeometry()->GetGeometryForTimeStep(_ResliceView->getPCMRIRenderer()->GetTimeStep()));
@@ -1539,7 +1554,7 @@ mitk::PlanarFigure* figureToFill)
 	if (figureToFill != nullptr) {
 		// Attempt conversion
 		auto segmentationImage = static_cast<mitk::Image*>(emptySegmentation->GetData());
-		_fillPlanarFigureInSlice(segmentationImage, figureToFill);
+		crimson::PCMRIUtils::fillPlanarFigureInSlice(segmentationImage, figureToFill);
 	}
 
 	return std::make_pair(sliceNode, emptySegmentation);
@@ -1811,7 +1826,7 @@ void PCMRIMappingWidget::_updateContourFromSegmentation(mitk::DataNode* contourN
 		return;
 	}
 
-	_createSmoothedContourFromVtkPolyData(contourSurf->GetVtkPolyData(), contour, _getContourSmoothnessFromNode(contourNode));
+	crimson::PCMRIUtils::createSmoothedContourFromVtkPolyData(contourSurf->GetVtkPolyData(), contour, _getContourSmoothnessFromNode(contourNode));
 
 	if (_ResliceView)
 		_ResliceView->getPCMRIRenderer()->GetRenderingManager()->RequestUpdateAll();
@@ -1824,45 +1839,6 @@ float PCMRIMappingWidget::_getContourSmoothnessFromNode(mitk::DataNode* contourN
 	return (float)smoothness / _UI.smoothnessSlider->maximum();
 }
 
-void PCMRIMappingWidget::_createSmoothedContourFromVtkPolyData(vtkPolyData* polyData, mitk::PlanarPolygon* contour,
-	float smoothness)
-{
-	vtkSmartPointer<vtkPolyData> contourPolyData;
-
-	int maxNIter = 1000;
-	int nIter = smoothness * maxNIter;
-
-	if (nIter != 0) {
-		vtkNew<vtkWindowedSincPolyDataFilter> smoothingFilter;
-		smoothingFilter->SetInputData(polyData);
-		smoothingFilter->NormalizeCoordinatesOn();
-		smoothingFilter->FeatureEdgeSmoothingOff();
-		smoothingFilter->BoundarySmoothingOn();
-		smoothingFilter->SetFeatureAngle(180); // No "features" - everything should be smoothed
-		smoothingFilter->SetEdgeAngle(180);
-
-		smoothingFilter->SetNumberOfIterations(nIter + 1);
-		smoothingFilter->SetPassBand(0.1);
-		smoothingFilter->Update();
-
-		contourPolyData = smoothingFilter->GetOutput();
-	}
-	else {
-		contourPolyData = polyData;
-	}
-
-	vtkCell* cell = contourPolyData->GetCell(0);
-
-	for (int i = 0; i < cell->GetPointIds()->GetNumberOfIds() - 1; ++i) {
-		mitk::Point3D p;
-		mitk::vtk2itk(cell->GetPoints()->GetPoint(cell->GetPointId(i)), p);
-
-		mitk::Point2D p2d;
-		contour->GetPlaneGeometry()->Map(p, p2d);
-		contour->SetControlPoint(i, p2d, true);
-	}
-}
-
 void PCMRIMappingWidget::setToolInformation_Segmentation(int id)
 {
 	if (id >= 0) {
@@ -2264,7 +2240,7 @@ void PCMRIMappingWidget::interpolateContour()
 		planarFigure->SetPlaneGeometry(
 			static_cast<mitk::SlicedGeometry3D*>(contourSegmentedImages[i]->GetGeometry())->GetPlaneGeometry(0));
 
-		_fillPlanarFigureInSlice(contourSegmentedImages[i], planarFigure);
+		crimson::PCMRIUtils::fillPlanarFigureInSlice(contourSegmentedImages[i], planarFigure);
 	}
 
 	// Step 2: interpolate
@@ -2305,297 +2281,214 @@ void PCMRIMappingWidget::interpolateContour()
 		return;
 	}
 
-	_createSmoothedContourFromVtkPolyData(contourSurf->GetVtkPolyData(), contour,
+	crimson::PCMRIUtils::createSmoothedContourFromVtkPolyData(contourSurf->GetVtkPolyData(), contour,
 		(float)_UI.smoothnessSlider->value() / _UI.smoothnessSlider->maximum());
 	createSegmented(!contourRemoved);
 
 	contour->SetPlaneGeometry(static_cast<mitk::PlanarFigure*>(_currentContourNode->GetData())->GetPlaneGeometry()->Clone());
-	_fillPlanarFigureInSlice(static_cast<mitk::Image*>(_currentSegmentationWorkingImageNode->GetData()), contour);
+	crimson::PCMRIUtils::fillPlanarFigureInSlice(static_cast<mitk::Image*>(_currentSegmentationWorkingImageNode->GetData()), contour);
 
 	// END DUPLICATION
 	//////////////////////////////////////////////////////////////////////////
 }
 
-void PCMRIMappingWidget::_interpolateContourOne(mitk::DataNode* contourNodes[2], float param)
-{
-	_ResliceView->navigateTo(param);
-
-	//check if a contour with this parameter already exists (if we passed it in the function) and remove it before proceeding
-	bool contourRemoved = false;
-
+namespace {
 
-	if (_currentContourNode) {
-		_removeCurrentContour(); // Might have side effect of changing the selection
-		contourRemoved = true;
+// Contours of a PC-MRI image by the time frame they lie in
+std::map<int, mitk::DataNode*> getContoursByFrame(mitk::DataNode* pcmriNode)
+{
+	std::map<int, mitk::DataNode*> contoursByFrame;
+	for (mitk::DataNode* node : crimson::PCMRIUtils::getContourNodesSortedByParameter(pcmriNode)) {
+		float param = 0;
+		node->GetFloatProperty("mapping.parameterValue", param);
+		contoursByFrame[static_cast<int>(std::lround(param))] = node;
 	}
+	return contoursByFrame;
+}
 
-	_updatePlanarFigureParameters();
-
-	float parameterValues[2];
-	mitk::Image::Pointer contourSegmentedImages[2];
-
-	const mitk::PlaneGeometry* geometry = _ResliceView->getPCMRIRenderer()->GetCurrentWorldPlaneGeometry();
-
-	const int nInterpolationSlices = 100;
-	const unsigned int dimensions[] = { static_cast<unsigned int>(geometry->GetBounds()[1]),
-		static_cast<unsigned int>(geometry->GetBounds()[3]) };
+}
 
-	const mitk::ScalarType spacing[] = { geometry->GetSpacing()[0], geometry->GetSpacing()[1], geometry->GetSpacing()[2] };
+void PCMRIMappingWidget::interpolateAllContours()
+{
+	_mapAfterInterpolation = false;
+	_startContourInterpolation();
+}
 
-	mitk::Point3D origin;
-	origin[0] = -spacing[0] * dimensions[0] / 2.0;
-	origin[1] = -spacing[1] * dimensions[1] / 2.0;
-	origin[2] = -spacing[0] / 2.0;
+bool PCMRIMappingWidget::_startContourInterpolation()
+{
+	if (!_ResliceView || !_currentPCMRINode) {
+		return false;
+	}
 
-	// Step 1: get the segmentation images for figures
-	mitk::PixelType pixelType(mitk::MakeScalarPixelType<unsigned char>());
+	int nSlices;
+	if (!_currentPCMRINode->GetData()->GetPropertyList()->GetIntProperty("PAR.MaxNumberOfCardiacPhases", nSlices))
+		//if this field does not exist, it's a DICOM file
+		nSlices = dynamic_cast<mitk::Image*>(_currentPCMRINode->GetData())->GetDimensions()[3];
 
-	for (int i = 0; i < 2; ++i) {
-		contourNodes[i]->GetFloatProperty("mapping.parameterValue", parameterValues[i]);
-		auto planarFigure = static_cast<mitk::PlanarFigure*>(contourNodes[i]->GetData())->Clone();
+	std::map<int, mitk::DataNode*> contoursByFrame = getContoursByFrame(_currentPCMRINode);
 
-		contourSegmentedImages[i] = mitk::Image::New();
-		contourSegmentedImages[i]->Initialize(pixelType, 2, dimensions);
-		contourSegmentedImages[i]->SetSpacing(spacing);
-		origin[2] = -spacing[2] / 2.0 + (i == 0 ? 0 : nInterpolationSlices * spacing[2]);
-		contourSegmentedImages[i]->SetOrigin(origin);
+	if (contoursByFrame.size() < 2) {
+		QMessageBox::information(nullptr, "Create contours", "Please first create two contours to interpolate.", QMessageBox::Ok);
+		return false;
+	}
 
-		{
-			mitk::ImageWriteAccessor writeAccess(contourSegmentedImages[i]);
-			memset(writeAccess.GetData(), 0, dimensions[0] * dimensions[1] * sizeof(unsigned char));
+	// Interpolate the frames missing a contour or, if there are none, interpolate the previously interpolated
+	// contours again, e.g. after the user has edited the ones they were interpolated from
+	std::vector<int> frames;
+	for (int frame = 0; frame < nSlices; ++frame) {
+		if (contoursByFrame.find(frame) == contoursByFrame.end()) {
+			frames.push_back(frame);
 		}
-
-		planarFigure->SetPlaneGeometry(
-			static_cast<mitk::SlicedGeometry3D*>(contourSegmentedImages[i]->GetGeometry())->GetPlaneGeometry(0));
-
-		_fillPlanarFigureInSlice(contourSegmentedImages[i], planarFigure);
 	}
 
-	// Step 2: interpolate
-	mitk::Image::Pointer outImg;
-
-	outImg = mitk::Image::New();
-	outImg->Initialize(pixelType, 2, dimensions);
-	outImg->SetSpacing(spacing);
-	origin[2] = -spacing[2] / 2.0 + (nInterpolationSlices / 2) * spacing[2];
-	outImg->SetOrigin(origin);
-
-	int nSlices;
-	if (!_currentPCMRINode->GetData()->GetPropertyList()->GetIntProperty("PAR.MaxNumberOfCardiacPhases", nSlices))
-		//if this field does not exist, it's a DICOM file
-		nSlices = dynamic_cast<mitk::Image*>(_currentPCMRINode->GetData())->GetDimensions()[3];
-	if (parameterValues[1] == 0)
-		parameterValues[1] = nSlices;
-	if (parameterValues[0] == nSlices - 1)
-		parameterValues[0] = -1;
+	std::map<float, mitk::DataNode::Pointer> contoursToReplace;
+	if (frames.empty()) {
+		for (auto iter = contoursByFrame.begin(); iter != contoursByFrame.end();) {
+			bool interpolated = false;
+			if (iter->second->GetBoolProperty("mapping.interpolated", interpolated) && interpolated) {
+				frames.push_back(iter->first);
+				contoursToReplace[static_cast<float>(iter->first)] = iter->second;
+				iter = contoursByFrame.erase(iter);
+			}
+			else {
+				++iter;
+			}
+		}
+	}
 
-	float currentParameterValue = param;
-	float interpolationFactor = abs((currentParameterValue - parameterValues[0]) / (parameterValues[1] - parameterValues[0]));
+	if (frames.empty()) {
+		return false;
+	}
 
-	auto interpolationAlgo = mitk::ShapeBasedInterpolationAlgorithm::New();
-	interpolationAlgo->Interpolate(contourSegmentedImages[0].GetPointer(), 0, contourSegmentedImages[1].GetPointer(),
-		nInterpolationSlices - 1, (int)((nInterpolationSlices - 1) * interpolationFactor + 0.5), 2,
-		outImg, 0, nullptr);
+	if (contoursByFrame.empty()) {
+		QMessageBox::information(nullptr, "Create contours", "Please first create a contour to interpolate from.", QMessageBox::Ok);
+		return false;
+	}
 
-	// Step 3: retrieve the contour from interpolated slice
+	// Every frame is interpolated independently from the closest contours before and after it, wrapping around the
+	// cardiac cycle. The tasks get copies of these contours and the slice geometries, so that they can run in
+	// parallel without navigating the reslice view to each frame.
+	float smoothness = (float)_UI.smoothnessSlider->value() / _UI.smoothnessSlider->maximum();
 
-	//////////////////////////////////////////////////////////////////////////
-	// BEGIN DUPLICATION
-	auto contour = mitk::PlanarPolygon::New();
-	contour->SetClosed(true);
-	contour->PlaceFigure(mitk::Point2D());
-	contour->SetPlaneGeometry(static_cast<mitk::SlicedGeometry3D*>(outImg->GetGeometry())->GetPlaneGeometry(0));
+	std::vector<std::shared_ptr<InterpolateContourTask>> interpolateContourTasks;
+	std::vector<std::shared_ptr<crimson::async::Task>> tasks;
+	for (int frame : frames) {
+		auto rightIter = contoursByFrame.upper_bound(frame);
+		int rightFrame = rightIter == contoursByFrame.end() ? contoursByFrame.begin()->first + nSlices : rightIter->first;
+		mitk::DataNode* rightNode = rightIter == contoursByFrame.end() ? contoursByFrame.begin()->second : rightIter->second;
 
-	mitk::ImageToContourFilter::Pointer contourExtractor = mitk::ImageToContourFilter::New();
-	contourExtractor->SetInput(outImg);
-	contourExtractor->Update();
+		auto leftIter = std::prev(rightIter == contoursByFrame.begin() ? contoursByFrame.end() : rightIter);
+		int leftFrame = rightIter == contoursByFrame.begin() ? leftIter->first - nSlices : leftIter->first;
 
-	mitk::Surface::Pointer contourSurf = contourExtractor->GetOutput();
+		const mitk::PlanarFigure* figures[2] = { static_cast<mitk::PlanarFigure*>(leftIter->second->GetData()),
+			static_cast<mitk::PlanarFigure*>(rightNode->GetData()) };
+		float interpolationFactor = static_cast<float>(frame - leftFrame) / (rightFrame - leftFrame);
 
-	if (contourSurf->GetVtkPolyData()->GetNumberOfCells() == 0 ||
-		contourSurf->GetVtkPolyData()->GetCell(0)->GetPointIds()->GetNumberOfIds() <
-		contour->GetMinimumNumberOfControlPoints()) {
-		return;
+		auto task = std::make_shared<InterpolateContourTask>(static_cast<float>(frame), figures, interpolationFactor,
+			_ResliceView->getPlaneGeometry(frame), smoothness);
+		interpolateContourTasks.push_back(task);
+		tasks.push_back(task);
 	}
 
-	_createSmoothedContourFromVtkPolyData(contourSurf->GetVtkPolyData(), contour,
-		(float)_UI.smoothnessSlider->value() / _UI.smoothnessSlider->maximum());
-
-	auto newNode = createSegmented(!contourRemoved);
-	newNode->SetBoolProperty("mapping.interpolated", true);
-	//newNode->SetFloatProperty("mapping.parameterValue", param);
+	auto interpolateTask = std::make_shared<crimson::QAsyncTaskAdapter>(std::make_shared<crimson::CompositeTask>(
+		std::make_shared<crimson::StartAllExecutionStrategy>(tasks)));
+	interpolateTask->setDescription(std::string("Interpolate contours for ") + _currentNode->GetName());
 
-	contour->SetPlaneGeometry(static_cast<mitk::PlanarFigure*>(_currentContourNode->GetData())->GetPlaneGeometry()->Clone());
-	_fillPlanarFigureInSlice(static_cast<mitk::Image*>(_currentSegmentationWorkingImageNode->GetData()), contour);
+	if (!crimson::AsyncTaskManager::getInstance()->addTask(interpolateTask,
+		crimson::PCMRIUtils::getInterpolateContoursTaskUID(_currentNode))) {
+		return false;
+	}
 
-	// END DUPLICATION
-	//////////////////////////////////////////////////////////////////////////
+	_interpolateContourTasks = std::move(interpolateContourTasks);
+	_interpolatedContoursToReplace = std::move(contoursToReplace);
+	_interpolatedPCMRINode = _currentPCMRINode;
+	return true;
 }
 
-void PCMRIMappingWidget::interpolateAllContours()
+void PCMRIMappingWidget::interpolateAllContoursFinished(crimson::async::Task::State state)
 {
-	int nSlices;
-	if (!_currentPCMRINode->GetData()->GetPropertyList()->GetIntProperty("PAR.MaxNumberOfCardiacPhases", nSlices))
-		//if this field does not exist, it's a DICOM file
-		nSlices = dynamic_cast<mitk::Image*>(_currentPCMRINode->GetData())->GetDimensions()[3];
+	std::vector<std::shared_ptr<InterpolateContourTask>> tasks = std::move(_interpolateContourTasks);
+	std::map<float, mitk::DataNode::Pointer> contoursToReplace = std::move(_interpolatedContoursToReplace);
+	mitk::DataNode::Pointer pcmriNode = _interpolatedPCMRINode;
+	bool mapAfterInterpolation = _mapAfterInterpolation;
 
-	std::vector<mitk::DataNode*> contourNodesAll = crimson::PCMRIUtils::getContourNodesSortedByParameter(_currentPCMRINode);
+	_interpolateContourTasks.clear();
+	_interpolatedContoursToReplace.clear();
+	_interpolatedPCMRINode = nullptr;
+	_mapAfterInterpolation = false;
 
-	if (contourNodesAll.size() < 2) {
-		QMessageBox::information(nullptr, "Create contours", "Please first create two contours to interpolate.", QMessageBox::Ok);
+	// Drop the results if the image has been changed in the meantime
+	if (state != crimson::async::Task::State_Finished || !_ResliceView || pcmriNode != _currentPCMRINode) {
 		return;
 	}
 
-	//check if we have contours in each slice
+	auto hierarchyManager = crimson::HierarchyManager::getInstance();
+	auto dataStorage = hierarchyManager->getDataStorage();
+	std::map<int, mitk::DataNode*> contoursByFrame = getContoursByFrame(_currentPCMRINode);
 
-	if (contourNodesAll.size() < nSlices)
-	{
-		//if some slices are missing contours, generate them by interpolation and mark this in property list of their node
-		//_allContours = false;
+	// Clump the replacement & creation of all the interpolated contours into one undo group
+	hierarchyManager->setStartNewUndoGroup(true);
+	_addingInterpolatedContours = true;
 
-		int parameter = 0;
-		for (std::vector<mitk::DataNode*>::size_type it = 0; it < contourNodesAll.size(); ++it)
-		{
-			auto pf = static_cast<mitk::PlanarFigure*>(static_cast<mitk::DataNode*>(contourNodesAll.at(it))->GetData());
-			float p;
-			static_cast<mitk::DataNode*>(contourNodesAll.at(it))->GetFloatProperty("mapping.parameterValue", p);
-			if (p != parameter)
-			{
-				mitk::DataNode* contourNodeLeft;
-				mitk::DataNode* contourNodeRight;
-
-				//contour missing at this time slice
-				if (parameter == 0)
-				{
-					//first few slices are missing, have to fill them up
-					contourNodeLeft = contourNodesAll.back();
-					contourNodeRight = contourNodesAll.at(it);
-				}
-				else
-				{
-					//normal insertion
-					contourNodeLeft = contourNodesAll.at(it-1);
-					contourNodeRight = contourNodesAll.at(it);
-				}
+	for (const std::shared_ptr<InterpolateContourTask>& task : tasks) {
+		boost::optional<mitk::PlanarPolygon::Pointer> contour = task->getResult();
+		if (!contour || contour->IsNull()) {
+			continue;
+		}
 
-				mitk::DataNode* contourNodes[2];
-				contourNodes[0] = contourNodeLeft;
-				contourNodes[1] = contourNodeRight;
+		float parameterValue = task->getParameterValue();
+		auto contourToReplaceIter = contoursToReplace.find(parameterValue);
+		mitk::DataNode* contourToReplace =
+			contourToReplaceIter == contoursToReplace.end() ? nullptr : contourToReplaceIter->second.GetPointer();
 
-				_interpolateContourOne(contourNodes, parameter);
-			}
-			parameter++;
-			contourNodesAll = crimson::PCMRIUtils::getContourNodesSortedByParameter(_currentPCMRINode);
+		// Keep the contours created by the user while the interpolation was running
+		auto existingContourIter = contoursByFrame.find(static_cast<int>(parameterValue));
+		if (existingContourIter != contoursByFrame.end() && existingContourIter->second != contourToReplace) {
+			continue;
 		}
 
-		//check if we reached the end but not defined all contours
-
-		while (parameter != nSlices)
-		{
-			mitk::DataNode* contourNodeLeft = contourNodesAll.back();
-			mitk::DataNode* contourNodeRight = contourNodesAll.front();
-			mitk::DataNode* contourNodes[2];
-			contourNodes[0] = contourNodeLeft;
-			contourNodes[1] = contourNodeRight;
-			_interpolateContourOne(contourNodes, parameter);
-			contourNodesAll = crimson::PCMRIUtils::getContourNodesSortedByParameter(_currentPCMRINode);
-			parameter++;
+		if (contourToReplace && dataStorage->Exists(contourToReplace)) {
+			dataStorage->Remove(contourToReplace);
+			hierarchyManager->setStartNewUndoGroup(false);
 		}
 
+		_addInterpolatedContour(parameterValue, contour->GetPointer());
+		hierarchyManager->setStartNewUndoGroup(false);
 	}
 
-	else
-		//loop through all previously interpolated slices and interpolate them again
-	{
-		//_allContours = true;
-		for (std::vector<mitk::DataNode*>::iterator it = contourNodesAll.begin(); it != contourNodesAll.end(); ++it)
-		{
-			bool interpolated = false;
-			if ((*it)->GetBoolProperty("mapping.interpolated", interpolated))
-			{
-				mitk::DataNode* contourNodeLeft = nullptr;
-				mitk::DataNode* contourNodeRight = nullptr;
-				//find left non-interpolated node
-				for (std::vector<mitk::DataNode*>::iterator jt = it; jt >= contourNodesAll.begin(); --jt)
-				{
-					if (!(*jt)->GetBoolProperty("mapping.interpolated", interpolated))
-					{
-						contourNodeLeft = *jt;
-						break;
-					}
-				}
-				//go from the end to find left value
-				if (contourNodeLeft == nullptr)
-				{
-					for (std::vector<mitk::DataNode*>::iterator jt = contourNodesAll.end()-1; jt != it; --jt)
-					{
-						if (!(*jt-1)->GetBoolProperty("mapping.interpolated", interpolated))
-						{
-							contourNodeLeft = *jt;
-							break;
-						}
-					}
-				}
-				//find right non-interpolated node
-				for (std::vector<mitk::DataNode*>::iterator jt = it + 1; jt != contourNodesAll.end(); ++jt)
-				{
-					if (!(*jt)->GetBoolProperty("mapping.interpolated", interpolated))
-					{
-						contourNodeRight = *jt;
-						break;
-					}
-				}
-				//go from the beginning to find right value
-				if (contourNodeRight == nullptr)
-				{
-					for (std::vector<mitk::DataNode*>::iterator jt = contourNodesAll.begin(); jt != it; ++jt)
-					{
-						if (!(*jt)->GetBoolProperty("mapping.interpolated", interpolated))
-						{
-							contourNodeRight = *jt;
-							break;
-						}
-					}
-				}
+	hierarchyManager->setStartNewUndoGroup(true);
+	_addingInterpolatedContours = false;
 
-				mitk::DataNode* contourNodes[2];
-				contourNodes[0] = contourNodeLeft;
-				contourNodes[1] = contourNodeRight;
-				float paramLeft, paramRight = 0;
-				contourNodeLeft->GetFloatProperty("mapping.parameterValue", paramLeft);
-				contourNodeRight->GetFloatProperty("mapping.parameterValue", paramRight);
-				float parameter = 0;
-				(*it)->GetFloatProperty("mapping.parameterValue", parameter);
-				_interpolateContourOne(contourNodes, parameter);
-			}
-			else
-				continue;
+	updateCurrentContour();
 
-		}		
+	if (mapAfterInterpolation) {
+		_runMapping();
 	}
 }
 
-void PCMRIMappingWidget::_fillPlanarFigureInSlice(mitk::Image* segmentationImage, mitk::PlanarFigure* figure)
+mitk::DataNode* PCMRIMappingWidget::_addInterpolatedContour(float parameterValue, mitk::PlanarPolygon* contour)
 {
-	// Setup the segmentation image from a contour of differnt type 
-	// This acts as a conversion from manual contours to segmented ones
+	// The control points are in the 2D coordinates of the slice - place the contour in the slice of its time frame
+	mitk::PlaneGeometry* geometry = _ResliceView->getPlaneGeometry(parameterValue);
+	contour->SetPlaneGeometry(geometry->Clone());
 
-	if (figure->GetPolyLinesSize() == 0) {
-		return;
-	}
+	std::pair<mitk::DataNode::Pointer, mitk::DataNode::Pointer> segmentationImagesPair = _createSegmentationNodes(
+		dynamic_cast<mitk::Image*>(_currentPCMRINode->GetData()), geometry, contour, static_cast<int>(parameterValue));
 
-	mitk::PlanarFigure::PolyLineType polyLine = figure->GetPolyLine(0);
+	mitk::DataNode* contourNode = _addPlanarFigure(contour, false, parameterValue);
+	contourNode->SetBoolProperty("planarfigure.drawcontrolpoints", false);
+	contourNode->SetBoolProperty("mapping.interpolated", true);
+	// Only the contour of the current slice is shown
+	contourNode->SetVisibility(false);
 
-	auto contourModel = mitk::ContourModel::New();
-	for (const mitk::Point2D& polyLineElement : polyLine) {
-		mitk::Point3D mappedPoint;
-		figure->GetPlaneGeometry()->Map(polyLineElement, mappedPoint);
-		contourModel->AddVertex(mappedPoint);
-	}
+	crimson::HierarchyManager::getInstance()->addNodeToHierarchy(contourNode, crimson::VascularModelingNodeTypes::Contour(),
+		segmentationImagesPair.first,
+		crimson::VascularModelingNodeTypes::ContourReferenceImage());
+	crimson::HierarchyManager::getInstance()->addNodeToHierarchy(
+		contourNode, crimson::VascularModelingNodeTypes::Contour(), segmentationImagesPair.second,
+		crimson::VascularModelingNodeTypes::ContourSegmentationImage());
 
-	mitk::ContourModel::Pointer projectedContour =
-		mitk::ContourModelUtils::ProjectContourTo2DSlice(segmentationImage, contourModel, true, false);
-	mitk::ContourModelUtils::FillContourInSlice(projectedContour, 0, segmentationImage, nullptr, 1);
+	return contourNode;
 }
 
 void PCMRIMappingWidget::deleteSelectedContours()
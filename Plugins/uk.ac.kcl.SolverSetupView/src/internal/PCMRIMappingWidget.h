@@ -38,6 +38,7 @@ class ThumbnalListWidgetItem;
 class QIcon;
 class QShortcut;
 class ResliceView;
+class InterpolateContourTask;
 
 /*!
 * \brief The view responsible for the setting up the PCMRI mapping.
@@ -78,6 +79,7 @@ private slots:
     void duplicateContour();
     void interpolateContour();
 	void interpolateAllContours();
+	void interpolateAllContoursFinished(crimson::async::Task::State);
 	
     // Navigate to contour upon double click or undo/redo operation
     void navigateToContourByIndex(const QModelIndex& index);
@@ -129,7 +131,7 @@ private:
     void _updateContourListViewSelection();
 
     // Add a new planar figure to the hierarchy. Sets the needed node properties
-    mitk::DataNode* _addPlanarFigure(mitk::PlanarFigure::Pointer figure, bool addInteractor = true);
+    mitk::DataNode* _addPlanarFigure(mitk::PlanarFigure::Pointer figure, bool addInteractor = true, float parameterValue = -1);
 
     // Show the information on the current contour and add a data interactor if this is required
     // (e.g. it is not required for segmentation contours)
@@ -167,7 +169,9 @@ private:
     void _connectAllContourObservers(mitk::DataStorage::SetOfObjects::ConstPointer nodes);
     void _disconnectAllContourObservers();
 
-	void _interpolateContourOne(mitk::DataNode* contourNodes[2], float param);
+	// Start interpolating the contours of the time frames without one in the background
+	bool _startContourInterpolation();
+	mitk::DataNode* _addInterpolatedContour(float parameterValue, mitk::PlanarPolygon* contour);
 
 	
     //////////////////////////////////////////////////////////////////////////
@@ -229,17 +233,14 @@ private:
     void _setSegmentationNodes(mitk::DataNode* refNode, mitk::DataNode* workNode);
     //std::pair<mitk::DataNode*, mitk::DataNode*> _getSegmentationNodes(mitk::DataNode* contour);
     std::pair<mitk::DataNode::Pointer, mitk::DataNode::Pointer>
-    _createSegmentationNodes(mitk::Image* image, const mitk::PlaneGeometry* sliceGeometry, mitk::PlanarFigure* figureToFill);
-
-    // Fill the relevant pixels in the segmentation slice based on a contour
-    void _fillPlanarFigureInSlice(mitk::Image* segmentationImage, mitk::PlanarFigure* figure);
+    _createSegmentationNodes(mitk::Image* image, const mitk::PlaneGeometry* sliceGeometry, mitk::PlanarFigure* figureToFill,
+                             int timeStep = -1);
 
     // Extract and smooth the contour defined by the segmented slice
     void _updateContourFromSegmentation(mitk::DataNode* contourNode);
     void _updateContourFromSegmentationData(const itk::Object*);
 
     float _getContourSmoothnessFromNode(mitk::DataNode*);
-    void _createSmoothedContourFromVtkPolyData(vtkPolyData* polyData, mitk::PlanarPolygon* contour, float smoothness);
 
 	//////////////////////////////////////////////////////////////////////////
 	// Mapping
@@ -274,6 +275,7 @@ private slots:
 
 private:
 	void _setupPCMRIMappingComboBoxes();
+	void _runMapping();
 	void _flipPCMRIImage(bool flag = false);
 	mitk::TimeGeometry::Pointer _getFlippedGeometry(mitk::DataNode* node);
 	
@@ -346,9 +348,6 @@ private:
 	//Flag that all the contours have been generated
 	bool _allContours = false;
 
-    // To keep the thumbnails clean, filter out the data that is shown
-    mitk::NodePredicateBase::Pointer _shouldBeInvisibleInThumbnailView;
-
     // The thumbnail generator
     std::unique_ptr<crimson::ThumbnailGenerator> _thumbnailGenerator;
 
@@ -379,6 +378,14 @@ private:
 
 	crimson::TaskStateObserver* _mapTaskStateObserver = nullptr;
 
+	// Contour interpolation over all the time frames
+	crimson::TaskStateObserver* _interpolateAllTaskStateObserver = nullptr;
+	std::vector<std::shared_ptr<InterpolateContourTask>> _interpolateContourTasks;
+	std::map<float, mitk::DataNode::Pointer> _interpolatedContoursToReplace;
+	mitk::DataNode::Pointer _interpolatedPCMRINode = nullptr;
+	bool _addingInterpolatedContours = false;
+	bool _mapAfterInterpolation = false;
+
 };
 
 //////////////////////////////////////////////////////////////////////////
@@ -9,6 +9,13 @@
 #include <mitkNodePredicateData.h>
 #include <mitkPlaneGeometry.h>
 #include <mitkImage.h>
+#include <mitkContourModel.h>
+#include <mitkContourModelUtils.h>
+
+#include <vtkCell.h>
+#include <vtkNew.h>
+#include <vtkPolyData.h>
+#include <vtkWindowedSincPolyDataFilter.h>
 
 #include <boost/format.hpp>
 
@@ -24,6 +31,15 @@ crimson::AsyncTaskManager::TaskUID PCMRIUtils::getMappingTaskUID(mitk::DataNode*
     return (boost::format("Mapping %1%") % BCNode).str();
 }
 
+crimson::AsyncTaskManager::TaskUID PCMRIUtils::getInterpolateContoursTaskUID(mitk::DataNode* BCNode)
+{
+    if (!BCNode) {
+        return "";
+    }
+
+    return (boost::format("Interpolate contours %1%") % BCNode).str();
+}
+
 mitk::Point3D PCMRIUtils::getPlanarFigureGeometryCenter(const mitk::DataNode* node)
 {
     auto figure = static_cast<const mitk::PlanarFigure*>(node->GetData());
@@ -167,4 +183,65 @@ std::tuple<double, mitk::Vector3D, unsigned int> PCMRIUtils::getResliceGeometryP
     return std::make_tuple(paramDelta, imageData->GetGeometry()->GetSpacing(), imageData->GetTimeSteps());
 }
 
+void PCMRIUtils::fillPlanarFigureInSlice(mitk::Image* segmentationImage, mitk::PlanarFigure* figure)
+{
+    // Setup the segmentation image from a contour of differnt type 
+    // This acts as a conversion from manual contours to segmented ones
+
+    if (figure->GetPolyLinesSize() == 0) {
+        return;
+    }
+
+    mitk::PlanarFigure::PolyLineType polyLine = figure->GetPolyLine(0);
+
+    auto contourModel = mitk::ContourModel::New();
+    for (const mitk::Point2D& polyLineElement : polyLine) {
+        mitk::Point3D mappedPoint;
+        figure->GetPlaneGeometry()->Map(polyLineElement, mappedPoint);
+        contourModel->AddVertex(mappedPoint);
+    }
+
+    mitk::ContourModel::Pointer projectedContour =
+        mitk::ContourModelUtils::ProjectContourTo2DSlice(segmentationImage, contourModel, true, false);
+    mitk::ContourModelUtils::FillContourInSlice(projectedContour, 0, segmentationImage, nullptr, 1);
+}
+
+void PCMRIUtils::createSmoothedContourFromVtkPolyData(vtkPolyData* polyData, mitk::PlanarPolygon* contour, float smoothness)
+{
+    vtkSmartPointer<vtkPolyData> contourPolyData;
+
+    int maxNIter = 1000;
+    int nIter = smoothness * maxNIter;
+
+    if (nIter != 0) {
+        vtkNew<vtkWindowedSincPolyDataFilter> smoothingFilter;
+        smoothingFilter->SetInputData(polyData);
+        smoothingFilter->NormalizeCoordinatesOn();
+        smoothingFilter->FeatureEdgeSmoothingOff();
+        smoothingFilter->BoundarySmoothingOn();
+        smoothingFilter->SetFeatureAngle(180); // No "features" - everything should be smoothed
+        smoothingFilter->SetEdgeAngle(180);
+
+        smoothingFilter->SetNumberOfIterations(nIter + 1);
+        smoothingFilter->SetPassBand(0.1);
+        smoothingFilter->Update();
+
+        contourPolyData = smoothingFilter->GetOutput();
+    }
+    else {
+        contourPolyData = polyData;
+    }
+
+    vtkCell* cell = contourPolyData->GetCell(0);
+
+    for (int i = 0; i < cell->GetPointIds()->GetNumberOfIds() - 1; ++i) {
+        mitk::Point3D p;
+        mitk::vtk2itk(cell->GetPoints()->GetPoint(cell->GetPointId(i)), p);
+
+        mitk::Point2D p2d;
+        contour->GetPlaneGeometry()->Map(p, p2d);
+        contour->SetControlPoint(i, p2d, true);
+    }
+}
+
 }
\ No newline at end of file
@@ -8,9 +8,13 @@
 #include <FaceIdentifier.h>
 
 #include <mitkDataStorage.h>
+#include <mitkImage.h>
+#include <mitkPlanarPolygon.h>
 #include <mitkBaseRenderer.h>
 #include <mitkRenderingManager.h>
 
+class vtkPolyData;
+
 namespace crimson {
 
 /*! \brief   A collection of useful utility functions. */
@@ -19,6 +23,7 @@ public:
     /*! \name Functions generating consistent async task UIDs for common operations. */
     ///@{ 
     static crimson::AsyncTaskManager::TaskUID getMappingTaskUID(mitk::DataNode* BCNode);
+    static crimson::AsyncTaskManager::TaskUID getInterpolateContoursTaskUID(mitk::DataNode* BCNode);
     ///@} 
 
     /*!
@@ -91,6 +96,18 @@ public:
      * \return  The reslice geometry parameters : Parametric delta, Reference image spacing, Time steps.
      */
     static std::tuple<double, mitk::Vector3D, unsigned int> getResliceGeometryParameters(mitk::DataNode::Pointer imageNode);
+
+    /*!
+     * \brief   Fill the area enclosed by a planar figure in a 2D segmentation image.
+     */
+    static void fillPlanarFigureInSlice(mitk::Image* segmentationImage, mitk::PlanarFigure* figure);
+
+    /*!
+     * \brief   Set the control points of a contour from the first cell of a poly data, optionally smoothing it.
+     *
+     * \param   smoothness  Smoothing amount in range [0, 1], 0 disables smoothing.
+     */
+    static void createSmoothedContourFromVtkPolyData(vtkPolyData* polyData, mitk::PlanarPolygon* contour, float smoothness);
 };
 
 }
\ No newline at end of file
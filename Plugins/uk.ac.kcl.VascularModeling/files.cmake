@@ -15,7 +15,6 @@ set(INTERNAL_CPP_FILES
   VesselBlendingView.cpp
   BooleanOperationItemDelegate.cpp
   #HierarchyManager.cpp
-  ThumbnailGenerator.cpp
   ContourTypeConversion.cpp
   VascularModelingUtils.cpp
   LoftAction.cpp
@@ -49,7 +48,6 @@ set(MOC_H_FILES
   src/internal/ContourModelingView.h
   src/internal/VesselBlendingView.h
   src/internal/BooleanOperationItemDelegate.h
-  src/internal/ThumbnailGenerator.h
   src/internal/UseVesselsInBlendingDialog.h
   src/internal/LoftAction.h
   src/internal/BlendAction.h
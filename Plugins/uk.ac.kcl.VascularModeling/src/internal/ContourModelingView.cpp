@@ -10,7 +10,6 @@
 
 // Plugin includes
 #include "VesselDrivenResliceView.h"
-#include "ThumbnailGenerator.h"
 #include "ConstMemberCommand.h"
 #include "ContourTypeConversion.h"
 #include "VascularModelingUtils.h"
@@ -24,6 +23,7 @@
 #include <HierarchyManager.h>
 #include <AsyncTaskManager.h>
 #include <AsyncTask.h>
+#include <ThumbnailGenerator.h>
 
 // Micro-services
 #include <usModule.h>
@@ -132,11 +132,6 @@ ContourModelingView::ContourModelingView()
     : NodeDependentView(crimson::VascularModelingNodeTypes::VesselPath(), true, QString("Vessel path"))
     , _thumbnailGenerator(new crimson::ThumbnailGenerator(GetDataStorage()))
 {
-    // Leave only planar figures and images in the thumbnails
-    _shouldBeInvisibleInThumbnailView =
-        mitk::NodePredicateNot::New(mitk::NodePredicateOr::New(mitk::TNodePredicateDataType<mitk::Image>::New(),
-                                                               mitk::TNodePredicateDataType<mitk::PlanarFigure>::New()))
-            .GetPointer();
 }
 
 ContourModelingView::~ContourModelingView()
@@ -284,13 +279,6 @@ void ContourModelingView::CreateQtPartControl(QWidget* parent)
     connect(_UI.computePathThroughCentersButton, &QAbstractButton::clicked, this,
             &ContourModelingView::computePathThroughContourCenters);
 
-    // Set the objects' visibility for the thumbnail renderer
-    mitk::DataStorage::SetOfObjects::ConstPointer invisibleNodes =
-        GetDataStorage()->GetSubset(_shouldBeInvisibleInThumbnailView);
-    for (const mitk::DataNode::Pointer& node : *invisibleNodes) {
-        node->SetVisibility(false, _thumbnailGenerator->getThumbnailRenderer());
-    }
-
     // Setup the listener for the reslice view
     _partListener.reset(new crimson::VesselDrivenResliceViewListener(
         [this](VesselDrivenResliceView* view) { this->setVesselDrivenResliceView(view); }, GetSite().GetPointer()));
@@ -920,11 +908,6 @@ void ContourModelingView::NodeAdded(const mitk::DataNode* node)
         }
     }
 
-    // Set the visibility for the thumbnail renderer
-    if (_shouldBeInvisibleInThumbnailView->CheckNode(node)) {
-        const_cast<mitk::DataNode*>(node)->SetVisibility(false, _thumbnailGenerator->getThumbnailRenderer());
-    }
-
     auto hierarchyManager = crimson::HierarchyManager::getInstance();
     if (hierarchyManager->getAncestor(node, crimson::VascularModelingNodeTypes::VesselPath()) == currentNode()) {
         if (hierarchyManager->getPredicate(crimson::VascularModelingNodeTypes::Contour())->CheckNode(node)) {
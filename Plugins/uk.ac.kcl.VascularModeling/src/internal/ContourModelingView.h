@@ -238,9 +238,6 @@ private:
     mitk::DataNode::Pointer _currentSegmentationReferenceImageNode = nullptr;
     mitk::DataNode::Pointer _currentSegmentationWorkingImageNode = nullptr;
 
-    // To keep the thumbnails clean, filter out the data that is shown
-    mitk::NodePredicateBase::Pointer _shouldBeInvisibleInThumbnailView;
-
     // The thumbnail generator
     std::unique_ptr<crimson::ThumbnailGenerator> _thumbnailGenerator;
 